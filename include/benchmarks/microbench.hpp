@@ -0,0 +1,60 @@
+/**
+ * @date Oct 19, 2026
+ * @file benchmarks/microbench.hpp
+ */
+
+#ifndef MICROBENCH_HPP_
+#define MICROBENCH_HPP_
+
+#include <ostream>
+#include <string>
+
+namespace bench {
+
+/**
+ * The number of calls to operator new. It is only counted if the
+ * allocation operators are replaced, see main.cpp (MICRO_BENCHMARK).
+ */
+extern unsigned long allocations;
+
+/**
+ * The result of a single micro benchmark.
+ */
+struct Measurement {
+	std::string name;
+	unsigned long iterations;
+
+	/** The time per operation in nanoseconds */
+	double ns;
+
+	/** The allocations per operation */
+	double allocations;
+};
+
+/**
+ * Runs the micro benchmarks of the m3d math, the CRSpline, the material
+ * lookups, the XML round trips of all object types and the placement
+ * of 200 objects on a terrain. The results are
+ * written as CSV to stdout and to the output file. Arguments:
+ *
+ * --filter <text>  only run benchmarks whose name contains the text
+ * --scale <n>      factor for the number of iterations (default 1)
+ * --out <file>     the CSV file (default microbench.csv)
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return     0 if successful, 1 otherwise
+ */
+int runMicroBenchmarks(int argc, char** argv);
+
+/**
+ * Writes the measurement as a CSV row.
+ *
+ * @param out The output stream
+ * @param m   The measurement to write
+ */
+void writeCSV(std::ostream& out, const Measurement& m);
+
+}
+
+#endif /* MICROBENCH_HPP_ */
@@ -0,0 +1,104 @@
+/**
+ * @date Oct 19, 2026
+ * @file benchmarks/scenebench.hpp
+ */
+
+#ifndef SCENEBENCH_HPP_
+#define SCENEBENCH_HPP_
+
+#include <simulation/topple.hpp>
+#include <simulation/topplelod.hpp>
+#include <simulation/physicslod.hpp>
+#include <ostream>
+#include <string>
+
+namespace bench {
+
+/**
+ * The results of a single scene benchmark.
+ */
+struct SceneResult {
+	std::string scene;
+	unsigned objects;
+	unsigned bodies;
+
+	/** The time to generate and add the scene, including the uploads */
+	float addTime;
+
+	/** The time to load the saved scene with Simulation::load */
+	float loadTime;
+
+	unsigned steps;
+	float stepTime;
+	float stepsPerSecond;
+
+	unsigned frames;
+	float frameTime;
+
+	/** The resident memory of the process after the frames in kB */
+	long residentMemory;
+
+	/**
+	 * The growth of the resident memory since the empty world of the
+	 * scene in kB. Unlike the peak of the process, it does not depend
+	 * on the scenes that ran before.
+	 */
+	long residentGrowth;
+
+	/** The memory used by Newton after the steps in kB */
+	long newtonMemory;
+
+	/** The memory of all subsystems after the frames in kB, see util::MemoryStats */
+	long accountedMemory;
+
+	/** The dominoes after the steps, see sim::ToppleTracker */
+	sim::ToppleSummary topple;
+
+	/** The dominoes per representation, if the option "toppleLod" is set */
+	sim::ToppleLodSummary lod;
+
+	/** The number of settled bodies after the steps, if the option "settleBodies" is set */
+	unsigned settled;
+
+	/** The bodies per tier, if the option "physicsLod" is set */
+	sim::PhysicsLodSummary physics;
+};
+
+/**
+ * Benchmarks the synthetic scenes of the sim::SceneGenerator. Each
+ * scene is generated, saved, loaded, stepped and rendered a fixed
+ * number of times. The results are written as CSV to stdout and
+ * to the output file. Arguments:
+ *
+ * --scene <name>  only run the given scene or layout file, may be repeated
+ * --scale <n>     size factor of the scenes (default 1)
+ * --steps <n>     number of physics steps (default 500)
+ * --frames <n>    number of rendered frames (default 100)
+ * --out <file>    the CSV file (default benchmark.csv)
+ * --export <base> export the trajectories and contacts of the steps
+ *                 of each scene to <base>_<scene>_*.csv
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return     0 if successful, 1 otherwise
+ */
+int runSceneBenchmark(int argc, char** argv);
+
+/**
+ * Writes the CSV header for writeCSV().
+ *
+ * @param out The output stream
+ */
+void writeCSVHeader(std::ostream& out);
+
+/**
+ * Writes the result as a CSV row.
+ *
+ * @param out    The output stream
+ * @param result The result to write
+ */
+void writeCSV(std::ostream& out, const SceneResult& result);
+
+}
+
+#endif /* SCENEBENCH_HPP_ */
@@ -45,6 +45,26 @@ private slots:
 	 * @param count	The total number of objects
 	 */
 	void updateObjectsCount(int count);
+	/**
+	 * The slot function updatePhysicsStats(int, int, int, int) shows the
+	 * solver statistics of the last step in the status bar. It is called
+	 * by RenderWidget::physicsStatsChanged(int, int, int, int).
+	 *
+	 * @param active   The number of simulated bodies
+	 * @param sleeping The number of sleeping bodies
+	 * @param islands  The number of simulated islands
+	 * @param joints   The number of contact joints
+	 */
+	void updatePhysicsStats(int active, int sleeping, int islands, int joints);
+	/**
+	 * The slot function updateMemory(int, int) shows the memory of all
+	 * subsystems in the status bar, and the usage of each subsystem in
+	 * the tool tip. It is called by RenderWidget::memoryChanged(int, int).
+	 *
+	 * @param current The current memory in megabytes
+	 * @param peak    The high-water mark in megabytes
+	 */
+	void updateMemory(int current, int peak);
 	/**
 	 * The slot function selectInteraction(sim::Simulation::InteractionType)
 	 * is executed each time the user clicks on an interaction button
@@ -89,6 +109,22 @@ private slots:
 	 * the sim::Simulation gravity can be changed.
 	 */
 	void onGravityPressed();
+	/**
+	 * The slot function onLayoutPressed() is executed each time the user
+	 * clicks on MainWindow::m_layout. The dominoes of the chosen layout
+	 * file are added to the sim::Simulation, see sim::LayoutGenerator.
+	 */
+	void onLayoutPressed();
+	/**
+	 * The slot function onRecordPressed() is executed each time the user
+	 * clicks on MainWindow::m_record and starts or stops the recording.
+	 */
+	void onRecordPressed();
+	/**
+	 * The slot function onReplayPressed() is executed each time the user
+	 * clicks on MainWindow::m_replay or MainWindow::m_stop_replay
+	 */
+	void onReplayPressed();
 
 	void onSoundControlsPressed();
 
@@ -175,6 +211,19 @@ private:
 	 * When triggered MainWindow::onGravityPressed() is executed
 	 */
 	QAction* m_gravity;
+	/**
+	 * When triggered MainWindow::onLayoutPressed() is executed
+	 */
+	QAction* m_layout;
+	/**
+	 * When triggered MainWindow::onRecordPressed() is executed
+	 */
+	QAction* m_record;
+	/**
+	 * When triggered MainWindow::onReplayPressed() is executed
+	 */
+	QAction* m_replay;
+	QAction* m_stop_replay;
 
 	QMenu* m_menuOptions;
 	QAction* m_sound_play;
@@ -215,6 +264,16 @@ private:
 	 * Updated by updateObjectsCount(int)
 	 */
 	QLabel* m_objectsCount;
+	/**
+	 * MainWindow::m_physicsStats displays the solver statistics.
+	 * Updated by updatePhysicsStats(int, int, int, int)
+	 */
+	QLabel* m_physicsStats;
+	/**
+	 * MainWindow::m_memory displays the accounted memory.
+	 * Updated by updateMemory(int, int)
+	 */
+	QLabel* m_memory;
 	/**
 	 * MainWindow::m_simulationStatus displays the current simulation status.
 	 * Either <i>Simulation started</i> or <i>Simulation stopped</i>.
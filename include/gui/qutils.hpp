@@ -9,8 +9,10 @@
 
 #include <simulation/simulation.hpp>
 #include <util/inputadapters.hpp>
+#include <QtCore/QMutex>
 #include <QtGui/QAction>
 #include <QtGui/QSplashScreen>
+#include <list>
 
 class QFileInfo;
 class QKeyEvent;
@@ -56,9 +58,22 @@ private:
 	QLabel* m_message;
 };
 
+/**
+ * Displays error messages in a message box. Messages reported by other
+ * threads than the GUI thread are queued until flush() is called on the
+ * GUI thread.
+ */
 class QtErrorListerner: public util::ErrorListener {
 public:
 	void displayError(const std::string& message);
+
+	/**
+	 * Displays all queued messages. Has to be called on the GUI thread.
+	 */
+	static void flush();
+private:
+	static std::list<std::string> s_queue;
+	static QMutex s_mutex;
 };
 
 /**
@@ -105,6 +105,34 @@ protected:
 	 */
 	virtual void mouseDoubleClickEvent(QMouseEvent* event);
 
+	/**
+	 * Draws the phase statistics of the util::Profiler on top of the
+	 * scene, including the GPU times of ogl::GpuProfiler. Toggled with
+	 * F3, F4 writes a trace of the recorded zones.
+	 */
+	void renderProfiler();
+
+	/** True, if the profiler overlay is visible */
+	bool m_showProfiler;
+
+	/**
+	 * Draws the timeline of the sim::ToppleTracker at the bottom of the
+	 * view: the number of hit and fallen dominoes over time, the stalls
+	 * of the wave and the summary of the cascade. Toggled with F8, F10
+	 * colours the dominoes by their hit time.
+	 */
+	void renderTimeline();
+
+	/** True, if the timeline overlay is visible */
+	bool m_showTimeline;
+
+	/**
+	 * Draws the summary of the sim::ChainChecker while the dominoes are
+	 * coloured by their predicted links. Toggled with F11, F12 writes the
+	 * weak and failing links.
+	 */
+	void renderChainSummary();
+
 public:
 	/**
 	 * RenderWidget::m_timer is used to update and repaint the display. The
@@ -140,6 +168,19 @@ signals:
 	 * MainWindow::updateFramesPerSecond(int)
 	 */
 	void objectsCountChanged(int);
+	/**
+	 * physicsStatsChanged(int, int, int, int) is emitted every second with
+	 * the active and sleeping bodies, the islands and the contact joints of
+	 * the last newton step. It is connected to
+	 * MainWindow::updatePhysicsStats(int, int, int, int)
+	 */
+	void physicsStatsChanged(int, int, int, int);
+	/**
+	 * memoryChanged(int, int) is emitted every second with the current
+	 * and the peak memory of all subsystems in megabytes. It is connected
+	 * to MainWindow::updateMemory(int, int)
+	 */
+	void memoryChanged(int, int);
 	/**
 	 * objectSelected(m3d::Mat4f) is emitted each time the user has selected
 	 * an object. The signal is connected to ModifyBox::updateData(m3d::Mat4f)
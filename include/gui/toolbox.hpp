@@ -40,6 +40,12 @@ public:
 	void updateMaterials(QString filename = "");
 	void loadTemplates(QString directory);
 
+	/**
+	 * Fills the material selection with the materials of the
+	 * sim::MaterialMgr. Has to be called after loading the materials.
+	 */
+	void showMaterials();
+
 public slots:
 	/**
 	 * This slot function is invoked by RenderWidget::objectSelected(m3d::Mat4f)
@@ -156,6 +162,12 @@ private:
 	 * sim::Simulation::InteractionType::INT_CREATE_OBJECT
 	 */
 	QPushButton* m_rotate;
+	/**
+	 * If activated, ToolBox::interactionSelected(sim::Simulation::InteractionType)
+	 * is emitted with sim::Simulation::InteractionType::INT_EDIT_PATH as parameter.
+	 * It does not need a selected object.
+	 */
+	QPushButton* m_editPath;
 
 	/**
 	 * Temporary variable to make the "unselection" of buttons in
@@ -142,6 +142,12 @@ public:
 	 */
 	Vec3<T> eulerAngles() const;
 
+	/**
+	 * Returns the rotation of the matrix as a unit quaternion with
+	 * a non-negative real part. This is the inverse of Quat::mat4().
+	 */
+	Quat<T> quat() const;
+
 	static Mat4<T> identity();
 	static Mat4<T> translate(const Vec3<T>& translation);
 	static Mat4<T> translate(const T& x, const T& y, const T& z);
@@ -635,6 +641,32 @@ Vec3<T> Mat4<T>::eulerAngles() const
 	return Vec3<T>(pitch, yaw, roll);
 }
 
+template<typename T>
+inline
+Quat<T> Mat4<T>::quat() const
+{
+	// the rows are the rotated axes, so _ij is the element (j, i)
+	// of the rotation matrix
+	Quat<T> q;
+	T trace = _11 + _22 + _33;
+	if (trace > 0) {
+		T s = sqrt(trace + 1) * 2;
+		q = Quat<T>(s / 4, (_23 - _32) / s, (_31 - _13) / s, (_12 - _21) / s);
+	} else if (_11 > _22 && _11 > _33) {
+		T s = sqrt(1 + _11 - _22 - _33) * 2;
+		q = Quat<T>((_23 - _32) / s, s / 4, (_21 + _12) / s, (_31 + _13) / s);
+	} else if (_22 > _33) {
+		T s = sqrt(1 + _22 - _11 - _33) * 2;
+		q = Quat<T>((_31 - _13) / s, (_21 + _12) / s, s / 4, (_32 + _23) / s);
+	} else {
+		T s = sqrt(1 + _33 - _11 - _22) * 2;
+		q = Quat<T>((_12 - _21) / s, (_31 + _13) / s, (_32 + _23) / s, s / 4);
+	}
+
+	T len = sqrt(q.a*q.a + q.b*q.b + q.c*q.c + q.d*q.d);
+	return q * ((q.a < 0 ? -1 : 1) / len);
+}
+
 template<typename T>
 inline
 Mat4<T> Mat4<T>::identity()
@@ -0,0 +1,130 @@
+/**
+ * @date Oct 19, 2026
+ * @file newton/heightcache.hpp
+ */
+
+#ifndef NEWTON_HEIGHTCACHE_HPP_
+#define NEWTON_HEIGHTCACHE_HPP_
+
+#include <m3d/m3d.hpp>
+#include <map>
+#include <set>
+#include <vector>
+
+/** The number of cells along each side of a tile of the height cache */
+#define HEIGHT_TILE_CELLS 32
+
+namespace newton {
+
+using namespace m3d;
+
+/**
+ * A height map of the static bodies of the world, i.e. the environment
+ * and all other bodies without mass. The map is divided into tiles that
+ * are sampled on first use with vertical rays, "heightCacheResolution"
+ * units apart. Heights are interpolated bilinearly inside a cell, unless
+ * the heights at its corners differ by more than "heightCacheThreshold".
+ * There is a step or an edge of the ground in such a cell, so the height
+ * is refined with an exact ray.
+ *
+ * The cache has to be invalidated when static bodies are added, moved
+ * or removed. Dynamic bodies that are demoted to static ones for a
+ * while are not part of it, see setDemoted(). It is not thread-safe.
+ */
+class HeightCache {
+private:
+	// singleton
+	static HeightCache* s_instance;
+	HeightCache();
+	HeightCache(const HeightCache& other);
+	virtual ~HeightCache();
+
+protected:
+	typedef std::pair<int, int> TileKey;
+
+	/** The (HEIGHT_TILE_CELLS + 1)^2 samples of each tile, row by row along z */
+	typedef std::map<TileKey, std::vector<float> > TileMap;
+
+	TileMap m_tiles;
+
+	/** The distance of two samples */
+	float m_resolution;
+
+	/** Cells with a larger height difference are refined */
+	float m_threshold;
+
+	/** @return The tile that contains the position */
+	TileKey getTile(float x, float z) const;
+
+	/** Samples all tiles in one batch of rays */
+	void build(const std::set<TileKey>& keys);
+
+	/**
+	 * Interpolates the height at the position from the samples of its
+	 * tile, which has to be built.
+	 *
+	 * @return False, if the cell has to be refined
+	 */
+	bool interpolate(const Vec2f& point, float& height) const;
+
+	/** Removes a tile and its accounted memory */
+	void erase(const TileMap::iterator& itr);
+public:
+	static HeightCache& instance();
+	static void destroy();
+
+	/** Removes all tiles, e.g. when the world is destroyed */
+	void clear();
+
+	/**
+	 * Removes the tiles that overlap the bounding box on the xz-plane.
+	 * The tiles are sampled again on their next use.
+	 *
+	 * @param min The minimum of the box
+	 * @param max The maximum of the box
+	 */
+	void invalidate(const Vec3f& min, const Vec3f& max);
+
+	/**
+	 * Returns the height of the static bodies at the given position
+	 * of the plane.
+	 *
+	 * @param x The x position in the plane
+	 * @param z The z position in the plane
+	 * @return  The y position of the static bodies at this position
+	 */
+	float get(float x, float z);
+
+	/**
+	 * Returns the heights of the static bodies at the given positions
+	 * of the plane. Missing tiles and refined cells are sampled in one
+	 * batch each, see getVerticalPositions().
+	 *
+	 * @param points The x and z positions in the plane
+	 * @param result The y positions of the static bodies
+	 */
+	void get(const std::vector<Vec2f>& points, std::vector<float>& result);
+
+	/** @return The number of sampled tiles */
+	unsigned getTileCount() const;
+
+	/** @return The distance of two samples */
+	float getResolution() const;
+};
+
+
+// inline methods
+
+inline unsigned HeightCache::getTileCount() const
+{
+	return m_tiles.size();
+}
+
+inline float HeightCache::getResolution() const
+{
+	return m_resolution;
+}
+
+}
+
+#endif /* NEWTON_HEIGHTCACHE_HPP_ */
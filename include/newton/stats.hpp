@@ -0,0 +1,189 @@
+/**
+ * @date Oct 19, 2026
+ * @file newton/stats.hpp
+ */
+
+#ifndef NEWTON_STATS_HPP_
+#define NEWTON_STATS_HPP_
+
+#include <Newton.h>
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+/** Island size buckets: 1, 2-3, 4-7, 8-15, 16-31, 32+ bodies */
+#define ISLAND_BUCKETS 6
+
+namespace newton {
+
+/**
+ * The statistics of a single NewtonUpdate.
+ */
+struct StepStats {
+	/** The number of the step since the stats were installed */
+	unsigned long step;
+
+	/** The wall time of the NewtonUpdate in milliseconds */
+	float time;
+
+	/** All bodies, the ones simulated in this step, and the sleeping ones */
+	unsigned bodies, active, sleeping;
+
+	/** The number of simulated islands and the size of the largest one */
+	unsigned islands, largestIsland;
+
+	/** The number of islands per size bucket, see ISLAND_BUCKETS */
+	unsigned islandSizes[ISLAND_BUCKETS];
+
+	/** The number of contact joints and the contact points in them */
+	unsigned contactJoints, contacts;
+
+	/** The number of invocations of the contact callback */
+	unsigned callbacks;
+
+	StepStats();
+};
+
+/**
+ * Collects the statistics of each NewtonUpdate of the world. The island
+ * sizes are counted in the island update event, the contact callbacks
+ * by the material manager and the bodies and joints are counted by
+ * walking the world after the step. If the config key "newtonStatsFile"
+ * is set, each step is appended to this file as CSV.
+ */
+class Stats {
+private:
+	// singleton
+	static Stats* s_instance;
+	Stats();
+	Stats(const Stats& other);
+	virtual ~Stats();
+
+protected:
+	typedef std::map<std::pair<int, int>, unsigned> PairCounts;
+
+	/**
+	 * The counters of a single Newton thread. Each thread only writes
+	 * to its own counters, so the callbacks do not need a lock.
+	 */
+	struct ThreadCounts {
+		unsigned callbacks;
+		PairCounts pairs;
+		char padding[64];
+
+		ThreadCounts() : callbacks(0) {}
+	};
+
+	std::vector<ThreadCounts> m_threads;
+
+	/** Guards the island counters */
+	boost::mutex m_islandMutex;
+
+	StepStats m_current;
+	StepStats m_last;
+
+	/** The contact callbacks per material pair of the last step */
+	PairCounts m_pairs;
+
+	/** The CSV file, if enabled */
+	std::ofstream m_csv;
+
+	/** Called by Newton for each island before it is solved */
+	static int islandUpdate(const NewtonWorld* world, const void* islandHandle, int bodyCount);
+
+	/** Walks the bodies and contact joints of the world */
+	void countBodies(const NewtonWorld* world);
+
+public:
+	/**
+	 * Returns an instance of the Stats and creates it,
+	 * if there is none.
+	 *
+	 * @return The Stats
+	 */
+	static Stats& instance();
+
+	/**
+	 * Destroys the instance of the Stats
+	 */
+	static void destroy();
+
+	/**
+	 * Registers the island update event for the given world and
+	 * resets the step counter. Has to be called for each new world.
+	 *
+	 * @param world The Newton world
+	 */
+	void install(NewtonWorld* world);
+
+	/**
+	 * Runs a single NewtonUpdate and records its statistics.
+	 *
+	 * @param world    The Newton world
+	 * @param timestep The time step passed to NewtonUpdate
+	 */
+	void update(NewtonWorld* world, float timestep);
+
+	/**
+	 * Counts a contact callback. Called by the contact callbacks,
+	 * possibly from multiple Newton threads.
+	 *
+	 * @param threadIndex The index of the Newton thread
+	 * @param mat0        The first material id of the contact
+	 * @param mat1        The second material id of the contact
+	 */
+	void countContact(int threadIndex, int mat0, int mat1);
+
+	/** @return The statistics of the last step */
+	const StepStats& getLast() const;
+
+	/**
+	 * Stores the contact callbacks per material pair of the last step.
+	 *
+	 * @param pairs The map in which the counts are stored
+	 */
+	void getPairCounts(std::map<std::pair<int, int>, unsigned>& pairs) const;
+
+	/**
+	 * Writes the CSV header for writeCSV().
+	 *
+	 * @param out The output stream
+	 */
+	static void writeCSVHeader(std::ostream& out);
+
+	/**
+	 * Writes the given step as a CSV row.
+	 *
+	 * @param out   The output stream
+	 * @param stats The statistics to write
+	 */
+	static void writeCSV(std::ostream& out, const StepStats& stats);
+};
+
+
+// inline methods
+
+inline const StepStats& Stats::getLast() const
+{
+	return m_last;
+}
+
+inline void Stats::getPairCounts(std::map<std::pair<int, int>, unsigned>& pairs) const
+{
+	pairs = m_pairs;
+}
+
+inline void Stats::countContact(int threadIndex, int mat0, int mat1)
+{
+	if (threadIndex < 0 || threadIndex >= (int)m_threads.size())
+		return;
+	ThreadCounts& counts = m_threads[threadIndex];
+	counts.callbacks++;
+	counts.pairs[std::make_pair(mat0, mat1)]++;
+}
+
+}
+
+#endif /* NEWTON_STATS_HPP_ */
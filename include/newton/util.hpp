@@ -10,7 +10,8 @@
 #include <m3d/m3d.hpp>
 #include <opengl/camera.hpp>
 #include <Newton.h>
-#include <list>
+#include <boost/unordered_set.hpp>
+#include <vector>
 
 namespace newton {
 
@@ -19,6 +20,16 @@ using namespace m3d;
 extern NewtonWorld* world;
 extern float gravity;
 
+/** A set of bodies, e.g. the bodies that are ignored by a convex cast */
+typedef boost::unordered_set<const NewtonBody*> BodySet;
+
+/**
+ * Replaces the allocator of Newton with one that reports all
+ * allocations to the util::MemoryStats. Has to be called before
+ * the first world is created.
+ */
+void installMemorySystem();
+
 /**
  * Calculates the forces resulting of the explosion at the given position
  * with the specified strength. Only bodies in the given radius are affected.
@@ -40,16 +51,63 @@ void applyExplosion(const Vec3f& position, float strength, float radius);
 NewtonBody* getRayCastBody(const Vec3f& origin, const Vec3f& dir);
 
 
+/** The bodies that are considered by the vertical position queries */
+typedef enum {
+	HEIGHT_ALL = 0,			/**< All bodies of the world, including dynamic ones */
+	HEIGHT_STATIC,			/**< Only static bodies, answered by the HeightCache */
+	HEIGHT_STATIC_EXACT		/**< Only static bodies, always cast against the world */
+} HeightFilter;
+
+/**
+ * Marks a dynamic body whose mass has been set to zero for a while,
+ * e.g. by the sim::ToppleLod or the sim::SettleManager. The static
+ * height filters still treat it as dynamic, so demoting and promoting
+ * it does not change the ground.
+ *
+ * @param body    The body
+ * @param demoted True, if the body has been demoted
+ */
+void setDemoted(const NewtonBody* body, bool demoted);
+
+/** Forgets all demoted bodies, e.g. when the world is destroyed */
+void clearDemoted();
+
 /**
  * Returns the vertical position of the world at the given position
  * of the plane. This function takes into consideration all collision
- * shapes and bodies of the given world.
+ * shapes and the bodies of the given world that pass the filter.
+ *
+ * @param x      The x position in the plane
+ * @param z      The z position in the plane
+ * @param filter The bodies to consider
+ * @return       The y position in the world at this position
+ */
+float getVerticalPosition(float x, float z, HeightFilter filter = HEIGHT_ALL);
+
+/**
+ * Returns the bounding box of all bodies of the world.
  *
- * @param x     The x position in the plane
- * @param z     The z position in the plane
- * @return      The y position in the world at this position
+ * @param min The minimum of the box
+ * @param max The maximum of the box
+ * @return    False, if the world has no bodies
  */
-float getVerticalPosition(float x, float z);
+bool getWorldAABB(Vec3f& min, Vec3f& max);
+
+/**
+ * Returns the vertical positions of the world at the given positions
+ * of the plane, like getVerticalPosition(). The rays only span the
+ * bounding box of the world, larger batches are cast in parallel by
+ * a pool of their own. This is meant for the generation of layouts,
+ * code that runs every frame should use HEIGHT_STATIC, which is
+ * answered by the HeightCache. The world must not be updated during
+ * the call.
+ *
+ * @param points The x and z positions in the plane
+ * @param result The y positions in the world at these positions
+ * @param filter The bodies to consider
+ */
+void getVerticalPositions(const std::vector<Vec2f>& points, std::vector<float>& result,
+		HeightFilter filter = HEIGHT_ALL);
 
 /**
  * Does a convex cast of the body and returns the vertical position of
@@ -57,10 +115,35 @@ float getVerticalPosition(float x, float z);
  * into consideration all collision shapes and bodies of the given world.
  * This also works with compound collisions.
  *
- * @param body The body to use for the convex cast
- * @return     The new vertical position of the body
+ * @param body        The body to use for the convex cast
+ * @param noCollision The bodies that are ignored by the cast, or NULL
+ * @return            The new vertical position of the body
+ */
+float getConvexCastPlacement(NewtonBody* body, const BodySet* noCollision = NULL);
+
+/**
+ * Returns the vertical offset that moves all bodies together so that
+ * they just collide with the ground, like getConvexCastPlacement().
+ * The sweep only spans the bodies of the world that overlap the bounding
+ * box of the bodies on the xz-plane. Bodies with more than one convex
+ * piece are cast once as the convex hull of all pieces. The pieces are
+ * only cast separately if the hull hits the ground in a gap between them.
+ *
+ * @param bodies      The bodies to place
+ * @param noCollision The bodies that are ignored by the cast, or NULL
+ * @return            The vertical offset, or 0 if there is no ground
+ */
+float getConvexCastOffset(const std::vector<NewtonBody*>& bodies, const BodySet* noCollision = NULL);
+
+/**
+ * Returns the vertical offsets of many groups of bodies, like
+ * getConvexCastOffset(). The groups are placed on the ground
+ * independently, so they do not land on each other.
+ *
+ * @param groups  The groups of bodies to place
+ * @param offsets The vertical offset of each group
  */
-float getConvexCastPlacement(NewtonBody* body, std::list<NewtonBody*>* noCollision = NULL);
+void getConvexCastOffsets(const std::vector<std::vector<NewtonBody*> >& groups, std::vector<float>& offsets);
 
 /**
  * Renders the specified collision shape, transformed with the given matrix.
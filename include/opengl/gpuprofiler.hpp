@@ -0,0 +1,130 @@
+/**
+ * @date Oct 19, 2026
+ * @file opengl/gpuprofiler.hpp
+ */
+
+#ifndef GPUPROFILER_HPP_
+#define GPUPROFILER_HPP_
+
+#include <GL/glew.h>
+#include <vector>
+
+/** The number of frames between issuing a query and reading it back */
+#define GPU_PROFILER_LATENCY 3
+
+namespace ogl {
+
+/**
+ * Measures the GPU time of render passes with GL_TIME_ELAPSED queries.
+ * The results are read back GPU_PROFILER_LATENCY frames later, so the
+ * pipeline never has to wait for them. They are reported to the
+ * util::Profiler as "gpu <pass>" phases, next to the CPU timings.
+ * Passes cannot be nested, since only one elapsed-time query can be
+ * active at a time.
+ */
+class GpuProfiler {
+private:
+	// singleton
+	static GpuProfiler* s_instance;
+	GpuProfiler();
+	GpuProfiler(const GpuProfiler& other);
+	virtual ~GpuProfiler();
+
+protected:
+	/**
+	 * The queries issued in one frame. The query objects are reused
+	 * when the slot comes around again.
+	 */
+	struct Frame {
+		std::vector<GLuint> queries;
+		std::vector<const char*> names;
+		unsigned used;
+	};
+
+	Frame m_frames[GPU_PROFILER_LATENCY + 1];
+	unsigned m_current;
+
+	/** True, if a query is active */
+	bool m_active;
+
+	/** True, if the ARB entry points are available, otherwise EXT */
+	bool m_arb;
+
+	/** The number of results dropped because they were not available */
+	unsigned long m_dropped;
+
+	/**
+	 * Reads the available results of the frame and resets it.
+	 */
+	void collect(Frame& frame);
+
+public:
+	/**
+	 * Returns an instance of the GpuProfiler and creates it, if there
+	 * is none. Requires a current OpenGL context.
+	 *
+	 * @return The GpuProfiler
+	 */
+	static GpuProfiler& instance();
+
+	/**
+	 * Destroys the instance of the GpuProfiler and deletes the queries.
+	 */
+	static void destroy();
+
+	/** @return True, if timer queries are supported */
+	static bool isSupported();
+
+	/**
+	 * Starts timing a pass, if the util::Profiler is enabled.
+	 *
+	 * @param name The name of the pass, has to be a string literal
+	 */
+	void begin(const char* name);
+
+	/**
+	 * Stops timing the current pass.
+	 */
+	void end();
+
+	/**
+	 * Ends the current frame and reports the results of the oldest
+	 * frame to the util::Profiler.
+	 */
+	void frame();
+
+	/** @return The number of results dropped so far */
+	unsigned long getDropped() const;
+};
+
+/**
+ * Times a render pass on the GPU between its construction and its
+ * destruction.
+ */
+class GpuZone {
+public:
+	GpuZone(const char* name);
+	~GpuZone();
+};
+
+
+// inline methods
+
+inline unsigned long GpuProfiler::getDropped() const
+{
+	return m_dropped;
+}
+
+inline GpuZone::GpuZone(const char* name)
+{
+	GpuProfiler::instance().begin(name);
+}
+
+inline GpuZone::~GpuZone()
+{
+	GpuProfiler::instance().end();
+}
+
+}
+
+#endif /* GPUPROFILER_HPP_ */
@@ -66,10 +66,13 @@ public:
 
 	/**
 	 * Inserts the vertices, indices and sub-meshes into the given VBO.
+	 * If userData is specified, it replaces the userData of the sub-meshes,
+	 * so that a single mesh can be shared by multiple objects.
 	 *
-	 * @param vbo The VBO to insert the data in.
+	 * @param vbo      The VBO to insert the data in.
+	 * @param userData The userData of the new sub-buffers, or NULL
 	 */
-	virtual void genBuffers(ogl::VertexBuffer& vbo);
+	virtual void genBuffers(ogl::VertexBuffer& vbo, void* userData = NULL);
 
 	/**
 	 * Returns a mesh created from a 3ds file. The userData of the sub-meshes will
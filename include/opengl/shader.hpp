@@ -10,7 +10,9 @@
 #include <GL/glew.h>
 #include <boost/tr1/memory.hpp>
 #include <iostream>
+#include <string>
 #include <map>
+#include <pstdint.h>
 
 namespace ogl {
 
@@ -33,6 +35,10 @@ typedef std::tr1::shared_ptr<__Shader> Shader;
  * To use the shader, call bind() and then (optionally) set the uniforms
  * using setUniform(). The current shader can be unbound by calling the
  * static unbind() method.
+ *
+ * If the driver supports program binaries, linked programs are stored
+ * in the shader cache, keyed by the hash of the sources and the driver.
+ * Later runs load the binary instead of compiling the shader again.
  */
 class __Shader {
 protected:
@@ -43,19 +49,63 @@ protected:
 	GLuint m_vertexObject, m_fragmentObject;
 	GLuint m_programObject;
 
+	// the key of the program in the shader cache
+	uint64_t m_hash;
+
 	// returns the info (error) log
 	void getInfoLog(GLuint object);
+
+	/** @return The path of the cache file of this program */
+	std::string cacheFile() const;
 public:
 	__Shader(GLchar* vertexSource, GLchar* fragmentSource);
 	virtual ~__Shader();
 
 	/**
 	 * Compiles and links the shader objects. Returns true if successful.
+	 * This is the same as calling beginCompile() and endCompile().
 	 *
 	 * @return true if successful, false else
 	 */
 	bool compile();
 
+	/**
+	 * Issues the compilation and linking of the shader objects without
+	 * waiting for the result. Drivers may compile multiple programs in
+	 * parallel if no status is queried in between.
+	 */
+	void beginCompile();
+
+	/**
+	 * Waits for the result of beginCompile(), prints the info logs of
+	 * failed shaders and stores the linked program in the shader cache.
+	 *
+	 * @return true if successful, false else
+	 */
+	bool endCompile();
+
+	/**
+	 * Creates the program from the binary in the shader cache.
+	 *
+	 * @return true if the program has been loaded, false otherwise
+	 */
+	bool loadBinary();
+
+	/**
+	 * Stores the binary of the linked program in the shader cache.
+	 *
+	 * @return true if successful, false otherwise
+	 */
+	bool saveBinary() const;
+
+	/**
+	 * @return true, if program binaries are supported and enabled
+	 */
+	static bool useBinaryCache();
+
+	/** The folder of the shader cache */
+	static const std::string s_cacheFolder;
+
 	/** Binds the shader program */
 	void bind();
 
@@ -100,7 +150,8 @@ public:
 
 	/** Loads all shaders in the specified folder. Vertex (*.vs) and
 	 * fragment shader (*.fs) files with the same name are linked together
-	 * and stored with the file name as a key.
+	 * and stored with the file name as a key. All programs are compiled
+	 * before any result is checked, cached programs are not compiled.
 	 */
 	unsigned load(const std::string& folder);
 
@@ -22,10 +22,10 @@ using namespace m3d;
  */
 class Skydome {
 protected:
-	GLuint m_flares;
+	Texture m_flares;
 	GLuint m_list;
 	Shader m_shader;
-	GLuint m_clouds;
+	Texture m_clouds;
 	float m_radius;
 	Vec4f m_horizon;
 	float m_time, m_delta;
@@ -11,7 +11,11 @@
 #include <GL/glew.h>
 #include <boost/tr1/memory.hpp>
 #include <string>
+#include <vector>
 #include <map>
+#include <set>
+#include <pstdint.h>
+#include <boost/thread/mutex.hpp>
 
 namespace ogl {
 
@@ -22,6 +26,90 @@ class __Texture;
  */
 typedef std::tr1::shared_ptr<__Texture> Texture;
 
+/**
+ * The CPU side of a texture: the decoded pixels of an image file and
+ * its mip chain. Images can be decoded on worker threads, only the
+ * upload has to be done on the thread that owns the OpenGL context.
+ *
+ * Decoded images are stored in the texture cache, keyed by the hash
+ * of the source file. A cached mip chain can be uploaded directly,
+ * without decoding the image or generating the mipmaps again. If the
+ * "compressTextures" option is enabled, the driver compresses the
+ * images once and the compressed mip chain will be cached instead.
+ */
+struct TextureImage {
+	struct Level {
+		int width;
+		int height;
+		std::vector<unsigned char> data;
+	};
+
+	/** The source file of the image */
+	std::string file;
+
+	/** The hash of the source file */
+	uint64_t hash;
+
+	/** GL_RGBA or the internal format of the compressed levels */
+	GLenum format;
+
+	/** True, if the levels are compressed */
+	bool compressed;
+
+	/** True, if the image has been read from the cache */
+	bool cached;
+
+	/** The mip chain, or only the base level */
+	std::vector<Level> levels;
+
+	TextureImage();
+
+	/**
+	 * Loads the image from the texture cache, or decodes the file if
+	 * it is not cached. In the latter case, the whole mip chain will be
+	 * generated if mipmaps is true.
+	 *
+	 * @param file     The image file
+	 * @param compress True, if the compressed version should be loaded
+	 * @param useCache True, if the cache should be used at all
+	 * @param mipmaps  True, if the mip chain should be generated
+	 * @return         True, if successful, false otherwise
+	 */
+	bool decode(const std::string& file, bool compress, bool useCache, bool mipmaps);
+
+	/**
+	 * Builds the mip chain from the base level using a box filter.
+	 */
+	void buildMipmaps();
+
+	/**
+	 * Writes the levels to the texture cache.
+	 *
+	 * @return True, if successful, false otherwise
+	 */
+	bool writeCache() const;
+
+	/**
+	 * Reads the levels from the texture cache.
+	 *
+	 * @param compressed True, if the compressed version should be read
+	 * @return           True, if the image is cached, false otherwise
+	 */
+	bool readCache(bool compressed);
+
+	/**
+	 * @param compressed True, for the file of the compressed version
+	 * @return           The path of the cache file for this image
+	 */
+	std::string cacheFile(bool compressed) const;
+
+	/** @return The total size of all levels in bytes */
+	size_t size() const;
+
+	/** The folder of the texture cache */
+	static const std::string s_cacheFolder;
+};
+
 /**
  * This class is a wrapper for OpenGL textures. It provides
  * methods to load them from many different file types and
@@ -60,6 +148,32 @@ public:
 	 */
 	static Texture load(std::string file, GLuint target = GL_TEXTURE_2D);
 
+	/**
+	 * Creates a new texture and uploads the given image. If the image
+	 * does not contain a mip chain, it is generated on the GPU. Has to
+	 * be called on the thread that owns the OpenGL context.
+	 *
+	 * If the option "compressTextures" is enabled and the image is not
+	 * already compressed, the driver compresses the image during the
+	 * upload and the compressed data is read back into the image, so that
+	 * it can be stored in the cache.
+	 *
+	 * @param image  The decoded image
+	 * @param target The target of the texture
+	 * @return       The newly created texture object
+	 */
+	static Texture upload(TextureImage& image, GLuint target = GL_TEXTURE_2D);
+
+	/**
+	 * @return True, if the GPU can generate the mipmaps of any texture
+	 */
+	static bool canGenerateMipmaps();
+
+	/**
+	 * @return True, if textures should be compressed by the driver
+	 */
+	static bool useCompression();
+
 	/**
 	 * Creates a new (empty) texture and binds it.
 	 *
@@ -70,11 +184,20 @@ public:
 
 	GLuint m_textureID;
 	GLuint m_target;
+
+	/** The estimated size of the texture in GPU memory in bytes */
+	size_t m_size;
 };
 
 /**
  * A simple texture manager for named texture objects. Provides
  * methods to load and add new textures efficiently.
+ *
+ * Textures are loaded on demand: index() only registers the files of
+ * a folder, and the first call to get() with the name of a texture
+ * loads it. The resident textures are kept within a memory budget by
+ * unloading the least recently used textures that are not referenced
+ * outside of the manager.
  */
 class TextureMgr : public std::map<std::string, Texture> {
 private:
@@ -83,6 +206,31 @@ private:
 	TextureMgr(const TextureMgr& other);
 	virtual ~TextureMgr();
 protected:
+	/** The image files of all known textures, mapped by name */
+	std::map<std::string, std::string> m_files;
+
+	/** The time of the last access of each resident texture */
+	std::map<std::string, unsigned long> m_lastUse;
+
+	/** Incremented on each access */
+	unsigned long m_time;
+
+	/** The size of all resident textures in bytes */
+	size_t m_residentSize;
+
+	/** The memory budget for all resident textures in bytes */
+	size_t m_budget;
+
+	/** Decoded images that have not been uploaded yet */
+	std::vector<std::pair<std::string, TextureImage> > m_pending;
+	boost::mutex m_pendingMutex;
+
+	/**
+	 * Unloads least recently used textures until the resident textures
+	 * fit into the budget. Textures that are referenced elsewhere will
+	 * not be unloaded.
+	 */
+	void evict();
 public:
 	static TextureMgr& instance();
 	static void destroy();
@@ -97,21 +245,75 @@ public:
 	Texture add(const std::string& name, Texture texture);
 
 	/**
-	 * Loads all textures within the given folder. The texture names will
-	 * be the base name of the files, i.e. the file name without its extension.
+	 * Registers all textures within the given folder without loading
+	 * them. The texture names will be the base name of the files, i.e.
+	 * the file name without its extension.
+	 *
+	 * @param folder The folder to search for textures
+	 * @return       The number of registered textures
+	 */
+	unsigned index(const std::string& folder);
+
+	/**
+	 * Registers and loads all textures within the given folder. The
+	 * images are decoded in parallel and uploaded afterwards. New images
+	 * are added to the texture cache if the option "textureCache" is set.
 	 *
 	 * @param folder The folder to load the textures from
+	 * @return       The number of loaded textures
 	 */
 	unsigned load(const std::string& folder);
 
+	/**
+	 * Loads all textures with the given names that are registered but
+	 * not resident. This can be used to load the textures of a level
+	 * in parallel, instead of loading them one by one on first use.
+	 *
+	 * @param names The names of the textures
+	 * @return      The number of loaded textures
+	 */
+	unsigned prefetch(const std::set<std::string>& names);
+
+	/**
+	 * Decodes the given registered textures in parallel, without
+	 * uploading them. This method does not need an OpenGL context and
+	 * can be called from any thread, but not concurrently with index()
+	 * or get(). The images will be uploaded by the next call to upload().
+	 *
+	 * @param names The names of the textures
+	 * @return      The number of decoded textures
+	 */
+	unsigned decode(const std::set<std::string>& names);
+
+	/**
+	 * Uploads all images decoded by decode() and stores new images in
+	 * the texture cache. Has to be called on the thread that owns the
+	 * OpenGL context.
+	 *
+	 * @return The number of loaded textures
+	 */
+	unsigned upload();
+
 	/**
 	 * Returns the texture object with the given name, or an empty
-	 * smart pointer if it does not exist.
+	 * smart pointer if it does not exist. Registered textures will
+	 * be loaded if they are not resident.
 	 *
 	 * @param name The name of the texture
 	 * @return     The associated texture object or an empty smart pointer
 	 */
 	Texture get(const std::string& name);
+
+	/**
+	 * Sets the memory budget for the resident textures. The budget
+	 * is initialized with the option "textureBudget" in megabytes.
+	 *
+	 * @param bytes The new budget in bytes
+	 */
+	void setBudget(size_t bytes);
+
+	/** @return The size of all resident textures in bytes */
+	size_t getResidentSize() const;
 };
 
 
@@ -172,6 +374,12 @@ void __Texture::stage(GLuint stage)
 	glActiveTexture(stage);
 }
 
+inline
+size_t TextureMgr::getResidentSize() const
+{
+	return m_residentSize;
+}
+
 inline
 TextureMgr& TextureMgr::instance()
 {
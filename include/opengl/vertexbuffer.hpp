@@ -80,6 +80,9 @@ public:
 
 	SubBuffers m_buffers;
 
+	// the sizes last reported to the MemoryStats
+	size_t m_accountedData, m_accountedBuffers;
+
 	VertexBuffer();
 	~VertexBuffer();
 
@@ -108,6 +111,12 @@ public:
 	 * Clears the internal data and destroys the buffers.
 	 */
 	void flush();
+
+	/**
+	 * Reports the size of the vertex and index data and of the buffer
+	 * objects to the MemoryStats. Called by upload() and flush().
+	 */
+	void account();
 };
 
 inline
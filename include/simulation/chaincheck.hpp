@@ -0,0 +1,213 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/chaincheck.hpp
+ */
+
+#ifndef CHAINCHECK_HPP_
+#define CHAINCHECK_HPP_
+
+#include <simulation/domino.hpp>
+#include <m3d/m3d.hpp>
+#include <boost/unordered_map.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+/** The predicted outcome of a link, from the best to the worst */
+typedef enum {
+	LINK_OK = 0,
+	LINK_WEAK,
+	LINK_FAIL
+} LinkStatus;
+
+/** The limiting factor of a link */
+typedef enum {
+	LINK_REACH = 0, //!< The falling domino barely reaches the next one
+	LINK_CLOSE,     //!< The dominoes touch, the falling one gains no momentum
+	LINK_STEP_UP,   //!< The next domino stands too high, it is hit too low
+	LINK_STEP_DOWN, //!< The next domino stands too low, it is hit above its top
+	LINK_SLIDE,     //!< The next domino is hit so low that it slides instead of tipping
+	LINK_OFFSET,    //!< The dominoes are offset sideways
+	LINK_ANGLE      //!< The dominoes are turned too much against each other
+} LinkReason;
+
+/**
+ * The prediction for a falling domino and the next one in its way.
+ */
+struct LinkPrediction {
+	LinkStatus status;
+	LinkReason reason;
+
+	/**
+	 * The smallest of the normalized margins of reach, contact height,
+	 * overlap and angle. Negative if the link fails.
+	 */
+	float margin;
+};
+
+/** A link of a chain, in the direction of the wave */
+struct ChainLink {
+	unsigned from;
+	unsigned to;
+	LinkPrediction prediction;
+};
+
+/** The counts of a check */
+struct ChainSummary {
+	unsigned dominoes;
+	unsigned chains;
+	unsigned links;
+	unsigned weak;
+	unsigned failing;
+};
+
+/**
+ * Predicts for each pair of consecutive dominoes whether the wave will
+ * propagate, without simulating it. The first domino falls around its
+ * front edge, so its top reaches sqrt(h^2 - d^2) above its base at the
+ * clear distance d. The next domino tips if this contact is above the
+ * height t / (2 * friction) and below its top, where t is its thickness
+ * and friction the static friction against the ground. The dominoes
+ * have to overlap sideways and must not be turned by more than
+ * "chainMaxAngle" degrees. Links with a margin below "chainWeakMargin"
+ * are weak.
+ *
+ * The dominoes are linked to their nearest neighbors in front and
+ * behind. The wave starts at the tilted dominoes, or at the end of a
+ * chain that was placed first. All lookups go through a grid on the
+ * xz-plane, so the check is linear in the number of dominoes.
+ */
+class ChainChecker {
+protected:
+	struct DominoInfo {
+		const __Domino* domino;
+		Mat4f matrix;
+		Vec3f size;
+		float friction;
+		bool tilted;
+	};
+
+	bool m_checked;
+	std::vector<DominoInfo> m_dominoes;
+	boost::unordered_map<const __Object*, unsigned> m_indices;
+	std::vector<ChainLink> m_links;
+
+	/** The worst incoming link of each domino */
+	std::vector<LinkStatus> m_status;
+
+	unsigned m_chains;
+
+	// thresholds, read from the config
+	float m_weakMargin;
+	float m_minOverlap;
+	float m_maxAngleCos;
+	std::string m_groundMaterial;
+
+	/** Finds the nearest neighbors of all dominoes */
+	void findNeighbors(std::vector<std::vector<unsigned> >& neighbors) const;
+
+	/** Links the dominoes in the order of the wave */
+	void link(const std::vector<std::vector<unsigned> >& neighbors);
+public:
+	ChainChecker();
+
+	/** Discards the results, the next check() finds the links again */
+	void reset();
+
+	/** @return True, if the results are up to date */
+	bool isChecked() const;
+
+	/**
+	 * Checks the links between all dominoes in the list.
+	 *
+	 * @param objects The objects of the simulation, see getReplayObjects()
+	 */
+	void check(const std::vector<const __Object*>& objects);
+
+	/**
+	 * Predicts whether the domino a topples the domino b, if it falls
+	 * towards it.
+	 *
+	 * @param sizeA    The size of the falling domino
+	 * @param a        The matrix of the falling domino
+	 * @param sizeB    The size of the next domino
+	 * @param b        The matrix of the next domino
+	 * @param friction The static friction of the next domino on the ground
+	 */
+	LinkPrediction predict(const Vec3f& sizeA, const Mat4f& a, const Vec3f& sizeB,
+			const Mat4f& b, float friction) const;
+
+	/**
+	 * Returns the gap closest to the nominal gap, for which the link is
+	 * predicted to be safe on a path with the given curvature and slope.
+	 * If there is none, returns the gap with the best margin.
+	 *
+	 * @param type      The domino type
+	 * @param gap       The nominal gap
+	 * @param curvature The inverse of the turning radius of the path
+	 * @param slope     The height difference per unit along the path
+	 * @param friction  The static friction of the dominoes on the ground
+	 */
+	float getGap(__Object::Type type, float gap, float curvature, float slope, float friction) const;
+
+	/**
+	 * Adjusts the gaps along a path to its curvature and slope.
+	 *
+	 * @param type     The domino type
+	 * @param material The material of the dominoes
+	 * @param gap      The nominal gap, the distance of the points
+	 * @param points   The points along the path on the ground
+	 * @param result   The lengths along the path of the dominoes
+	 */
+	void getSpacing(__Object::Type type, const std::string& material, float gap,
+			const std::vector<Vec3f>& points, std::vector<float>& result) const;
+
+	/** @return The static friction of the material on the ground */
+	float getFriction(const std::string& material) const;
+
+	const std::vector<ChainLink>& getLinks() const;
+
+	/** @return The domino with the given index of the links */
+	const __Domino* getDomino(unsigned index) const;
+
+	/**
+	 * Returns the colour of a domino by its worst incoming link, red if
+	 * it will probably not be toppled and yellow if the link is weak.
+	 *
+	 * @param object The object
+	 * @param color  The colour
+	 * @return       True, if the object is a domino with a weak or failing link
+	 */
+	bool getColor(const __Object* object, Vec4f& color) const;
+
+	ChainSummary getSummary() const;
+
+	/** Writes a CSV header and a row for each weak or failing link */
+	void writeLinks(std::ostream& out) const;
+};
+
+
+// inline methods
+
+inline bool ChainChecker::isChecked() const
+{
+	return m_checked;
+}
+
+inline const std::vector<ChainLink>& ChainChecker::getLinks() const
+{
+	return m_links;
+}
+
+inline const __Domino* ChainChecker::getDomino(unsigned index) const
+{
+	return m_dominoes[index].domino;
+}
+
+}
+
+#endif /* CHAINCHECK_HPP_ */
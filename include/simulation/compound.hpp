@@ -38,6 +38,9 @@ protected:
 	std::list<Object> m_nodes;
 	std::list<Joint> m_joints;
 
+	// the template manager clones the nodes and joints of its prototypes
+	friend class TemplateMgr;
+
 	__Compound();
 	__Compound(const Mat4f& matrix);
 	__Compound(const Vec3f& position);
@@ -57,7 +60,9 @@ public:
 
 	virtual void getAABB(Vec3f& min, Vec3f& max);
 
-	virtual float convexCastPlacement(bool apply = true, std::list<NewtonBody*>* noCollision = NULL);
+	virtual float convexCastPlacement(bool apply = true, const newton::BodySet* noCollision = NULL);
+
+	virtual void getBodies(std::vector<NewtonBody*>& bodies);
 
 	Hinge createHinge(const Vec3f& pivot, const Vec3f& pinDir, const Object& child, const Object& parent,
 			bool limited = false, float minAngle = -1.0f, float maxAngle = 1.0f);
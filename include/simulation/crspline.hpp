@@ -8,8 +8,8 @@
 #define CRSPLINE_HPP_
 
 #include <m3d/m3d.hpp>
+#include <newton/util.hpp>
 #include <vector>
-#include <list>
 
 namespace sim {
 
@@ -17,10 +17,17 @@ using namespace m3d;
 
 /**
  * Arc-length parameterized Catmull Rom spline.
+ *
+ * The help points of all segments are stored in one table. An update
+ * only recomputes the segments that depend on changed knots, i.e.
+ * appending a knot recomputes the last two segments.
  */
 class CRSpline {
 protected:
-	/** Help point with t parameter of spline, the arc length the position and tangent */
+	/**
+	 * Help point with the t parameter of the spline, the arc length, the
+	 * position and the tangent. The integer part of t is the segment.
+	 */
 	struct HelpPoint {
 		float t, len;
 		Vec2f pos, tangent;
@@ -29,30 +36,40 @@ protected:
 	/** A vector of help points for indexed access */
 	typedef std::vector<HelpPoint> HelpTable;
 
-	/** A list of help points for fast insertion */
-	typedef std::list<HelpPoint> HelpList;
-
 	/** Table of help points */
 	HelpTable m_table;
 
+	/** The index of the first help point of each segment in the table */
+	std::vector<unsigned> m_segments;
+
+	/** The knots the table was calculated for */
+	std::vector<Vec2f> m_tableKnots;
+
 	/** The control points */
 	std::vector<Vec2f> m_knots;
 
 	/** The maximum error allowed when calculating the arc length */
 	float m_error;
 
+	/**
+	 * Appends the help points of the segment that starts at the given
+	 * knot. The last help point of the table is its first point.
+	 *
+	 * @param knot The first knot of the segment
+	 */
+	void appendSegment(unsigned knot);
+
 	/**
 	 * Divides the given segment into two equally sized segments and checks whether
 	 * the deviation of the linear segments deviates from the spline more than the
 	 * specified error. If so, the two generated segments are again subdivided
-	 * recursively.
+	 * recursively. The inner help points are appended to the table in order.
 	 *
-	 * @param helpPoints The current list of help points
-	 * @param point      The current help point of interest
-	 * @param knot       The current knot to handle
-	 * @return           The next help point to handle
+	 * @param cur  The first help point of the segment, the last one of the table
+	 * @param next The last help point of the segment
+	 * @param knot The current knot to handle
 	 */
-	HelpList::iterator divideSegment(HelpList &helpPoints, HelpList::iterator cur, unsigned knot);
+	void divideSegment(HelpPoint cur, HelpPoint next, unsigned knot);
 
 	/**
 	 * Perform a binary search on the internal table in order to find
@@ -61,7 +78,7 @@ protected:
 	 * @param length The length of the curve
 	 * @return       The lower index of the two help points that span the segment
 	 */
-	unsigned binarySearch(float length);
+	unsigned binarySearch(float length) const;
 
 	/**
 	 * Returns a valid knot at the given index. All security check included.
@@ -70,7 +87,41 @@ protected:
 	 * @return      A valid knot
 	 */
 	Vec2f at(int index);
+
+	/**
+	 * Returns the position in the plane at the given length of the
+	 * curve.
+	 *
+	 * @param length The length on the curve
+	 * @return       The x and z position at this length
+	 */
+	Vec2f getPlanarPos(float length);
 public:
+	/**
+	 * Evaluates the spline at increasing lengths. Each query continues
+	 * at the help point of the previous one, so a sweep over the whole
+	 * curve is linear in the number of help points. Smaller lengths fall
+	 * back to a binary search. The spline must not be updated during
+	 * the sweep.
+	 */
+	class Sweep {
+	protected:
+		const CRSpline& m_spline;
+		unsigned m_lower;
+
+		/** Moves to the help point below the length, see binarySearch() */
+		void seek(float length);
+	public:
+		Sweep(const CRSpline& spline);
+
+		/** @return The x and z position at the given length */
+		Vec2f getPlanarPos(float length);
+
+		/** @return The tangent at the given length */
+		Vec3f getTangent(float length);
+	};
+	friend class Sweep;
+
 	/**
 	 * Constructs a new Catmull-Rom spline with the given length deviation.
 	 *
@@ -81,8 +132,9 @@ public:
 
 	/**
 	 * Calculates the arc length of the spline and updates the internal
-	 * table of help points. Clears the help points if the number of knots
-	 * is smaller than three.
+	 * table of help points. Only the segments that depend on knots that
+	 * changed since the last update are calculated again. Clears the help
+	 * points if the number of knots is smaller than three.
 	 *
 	 * @return The length of the spline
 	 */
@@ -94,11 +146,21 @@ public:
 	/** @return The help points of the spline */
 	inline HelpTable& table();
 
+	/**
+	 * Returns the length of the curve at the given knot, as of the last
+	 * update. The segments before the knot depend only on the knots up to
+	 * the next one.
+	 *
+	 * @param knot The index of the knot
+	 * @return     The length of the curve from the first knot to this knot
+	 */
+	float getKnotLength(unsigned knot) const;
+
 	/**
 	 * Get the spline parameter at the given length.
 	 *
 	 * @param length The length on the curve
-	 * @return       The parameter of the curve at this length
+	 * @return       The parameter of the curve at this length, from 0 to 1
 	 */
 	float getT(float length);
 
@@ -111,6 +173,28 @@ public:
 	 */
 	Vec3f getPos(float length);
 
+	/**
+	 * Returns equidistant positions on the spline, beginning at its
+	 * start. The heights of all positions are sampled in one batch,
+	 * see newton::getVerticalPositions().
+	 *
+	 * @param gap    The length of the curve between two positions
+	 * @param result The positions
+	 * @param filter The bodies the positions are placed on
+	 */
+	void getPositions(float gap, std::vector<Vec3f>& result, newton::HeightFilter filter = newton::HEIGHT_ALL);
+
+	/**
+	 * Returns the positions on the spline at the given lengths of the
+	 * curve, with the heights sampled in one batch.
+	 *
+	 * @param lengths The lengths on the curve
+	 * @param result  The positions
+	 * @param filter  The bodies the positions are placed on
+	 */
+	void getPositions(const std::vector<float>& lengths, std::vector<Vec3f>& result,
+			newton::HeightFilter filter = newton::HEIGHT_ALL);
+
 	/**
 	 * Returns the tangent on the spline at the given length
 	 * of the curve.
@@ -134,10 +218,17 @@ public:
 	 */
 	void renderKnots(bool link = true, const Vec3f& color = Vec3f());
 
+	/**
+	 * Renders the given knots like the knots of a spline, without
+	 * updating a spline.
+	 */
+	static void renderKnots(const std::vector<Vec2f>& knots, bool link = true, const Vec3f& color = Vec3f());
+
 	/**
 	 * Renders the spline with the given accuracy. It has to be a
 	 * value greater than 0 and smaller than 1, where 0.5 would mean
-	 * that a spline segment is drawn using two lines.
+	 * that a spline segment is drawn using two lines. The spline lies
+	 * on the static bodies, whose heights are cached.
 	 *
 	 * @param accuracy A value greater than 0 and smaller than 1
 	 */
@@ -145,7 +236,7 @@ public:
 
 	/**
 	 * Renders equidistant points on the spline with the given
-	 * gap between them.
+	 * gap between them, on the static bodies like renderSpline().
 	 *
 	 * @param gap           The length of the spline between the points
 	 * @param tangent       Tangents will be rendered if True
@@ -8,6 +8,8 @@
 #define DOMINO_HPP_
 
 #include <simulation/object.hpp>
+#include <newton/util.hpp>
+#include <vector>
 
 namespace sim {
 
@@ -40,11 +42,11 @@ protected:
 	 * @return           The collision geometry
 	 */
 	static NewtonCollision* getCollision(Type type, int materialID);
-
+public:
 	/** Sizes for the domino pieces, indexed by
 	 * DOMINO_SMALL, DOMINO_MIDDLE, DOMINO_LARGE. */
 	static Vec3f s_domino_size[3];
-public:
+
 	/** Gaps for curves for the domino pieces, indexed by
 	 * DOMINO_SMALL, DOMINO_MIDDLE, DOMINO_LARGE. */
 	static float s_domino_gap[3];
@@ -94,6 +96,34 @@ public:
 	 * @return            The newly created domino object
 	 */
 	static Domino createDomino(Type type, const Mat4f& matrix, float mass, const std::string& material = "", bool doPlacement = true);
+
+	/**
+	 * Creates new dominoes with the given matrices and places them on
+	 * the ground. The ground below all dominoes is sampled in a single
+	 * batch, which is much faster than placing them one by one.
+	 *
+	 * @param type     The domino type
+	 * @param matrices The matrices of the dominoes
+	 * @param mass     The mass, or -1 for auto-generated mass
+	 * @param material The material name
+	 * @param result   The new dominoes are appended to this list
+	 * @param filter   The bodies the dominoes are placed on
+	 */
+	static void createDominoes(Type type, const std::vector<Mat4f>& matrices, float mass,
+			const std::string& material, std::vector<Domino>& result,
+			newton::HeightFilter filter = newton::HEIGHT_ALL);
+
+	/**
+	 * Places dominoes with the given matrices on the ground, like
+	 * createDominoes(), without creating them.
+	 *
+	 * @param type     The domino type
+	 * @param matrices The matrices of the dominoes
+	 * @param result   The placed matrices are appended to this list
+	 * @param filter   The bodies the dominoes are placed on
+	 */
+	static void placeDominoes(Type type, const std::vector<Mat4f>& matrices, std::vector<Mat4f>& result,
+			newton::HeightFilter filter = newton::HEIGHT_ALL);
 };
 
 }
@@ -0,0 +1,169 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/dominopath.hpp
+ */
+
+#ifndef DOMINOPATH_HPP_
+#define DOMINOPATH_HPP_
+
+#include <simulation/domino.hpp>
+#include <simulation/crspline.hpp>
+#include <m3d/m3d.hpp>
+#include <newton/util.hpp>
+#include <xml/rapidxml.hpp>
+#include <boost/tr1/memory.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+class __DominoPath;
+typedef std::tr1::shared_ptr<__DominoPath> DominoPath;
+
+/**
+ * A path of dominoes along a Catmull-Rom spline through its knots, or
+ * along a line if there are only two knots. The dominoes are spaced by
+ * the nominal gap, shortened on tight turns and slopes, see
+ * ChainChecker::getSpacing().
+ *
+ * The path remembers the length along the curve of each of its
+ * dominoes. When knots are moved, only the dominoes on the span of the
+ * curve that depends on these knots are generated again, the dominoes
+ * before and after it are kept. The new dominoes of the span reuse the
+ * old ones in order, so they keep their identity and sub-buffers, and
+ * unchanged dominoes are not touched at all. Only the difference in
+ * count is added to or removed from the simulation.
+ *
+ * The path is saved as a "path" node of the level:
+ *
+ * <path type="domino_small" material="domino" gap="2.5" dominoes="4 5 6" lengths="0 2.5 5">
+ *     <knot x="0" z="0"/>
+ *     ...
+ * </path>
+ */
+class __DominoPath {
+protected:
+	std::vector<Vec2f> m_knots;
+	__Object::Type m_type;
+	std::string m_material;
+	float m_gap;
+
+	/** The spline of the last update, with a knot in the middle of a line */
+	CRSpline m_spline;
+
+	/** The dominoes and their lengths along the curve, in order */
+	std::vector<Domino> m_dominoes;
+	std::vector<float> m_lengths;
+
+	/** @return The knots of the spline, see m_spline */
+	std::vector<Vec2f> getSplineKnots() const;
+
+	/**
+	 * Returns the lengths of the dominoes between two dominoes.
+	 *
+	 * @param begin  The length of the domino before, or -1 at the start
+	 * @param end    The length of the domino after, or -1 at the end
+	 * @param filter The bodies the dominoes are placed on
+	 * @param result The lengths of the dominoes in between
+	 */
+	void getLengths(float begin, float end, newton::HeightFilter filter, std::vector<float>& result);
+public:
+	__DominoPath(const std::vector<Vec2f>& knots, __Object::Type type, const std::string& material, float gap);
+
+	/** @return The knots, update() regenerates the dominoes after a change */
+	std::vector<Vec2f>& knots();
+
+	__Object::Type getType() const;
+	const std::string& getMaterial() const;
+	float getGap() const;
+
+	const std::vector<Domino>& getDominoes() const;
+
+	/**
+	 * Generates the dominoes on the spans of the curve that depend on
+	 * knots that changed since the last update, or all dominoes if the
+	 * number of knots changed. The changed dominoes are added to or
+	 * removed from the simulation.
+	 *
+	 * @param filter The bodies the dominoes are placed on
+	 * @return       The number of added, moved and removed dominoes
+	 */
+	unsigned update(newton::HeightFilter filter = newton::HEIGHT_STATIC);
+
+	/**
+	 * Removes the domino from the path, but not from the simulation.
+	 * A later update may fill the gap.
+	 *
+	 * @param object The object
+	 * @return       True, if the object was a domino of the path
+	 */
+	bool remove(const __Object* object);
+
+	/**
+	 * Removes the dominoes from the path in one pass, but not from
+	 * the simulation.
+	 *
+	 * @param objects The objects
+	 * @return        The number of removed dominoes of the path
+	 */
+	unsigned remove(const std::set<const __Object*>& objects);
+
+	/**
+	 * Returns the knot closest to the position.
+	 *
+	 * @param pos    The position on the ground
+	 * @param radius The maximum distance
+	 * @return       The index of the knot, or -1 if there is none
+	 */
+	int getKnot(const Vec2f& pos, float radius) const;
+
+	/** Renders the knots and the curve of the last update */
+	void render();
+
+	static void save(const __DominoPath& path, rapidxml::xml_node<>* parent, rapidxml::xml_document<>* doc);
+
+	/**
+	 * Loads a path node. The dominoes have to be loaded before.
+	 *
+	 * @param node     The path node
+	 * @param dominoes The dominoes of the level by their ids
+	 * @return         The path
+	 */
+	static DominoPath load(rapidxml::xml_node<>* node, const std::map<int, Domino>& dominoes);
+};
+
+
+// inline methods
+
+inline std::vector<Vec2f>& __DominoPath::knots()
+{
+	return m_knots;
+}
+
+inline __Object::Type __DominoPath::getType() const
+{
+	return m_type;
+}
+
+inline const std::string& __DominoPath::getMaterial() const
+{
+	return m_material;
+}
+
+inline float __DominoPath::getGap() const
+{
+	return m_gap;
+}
+
+inline const std::vector<Domino>& __DominoPath::getDominoes() const
+{
+	return m_dominoes;
+}
+
+}
+
+#endif /* DOMINOPATH_HPP_ */
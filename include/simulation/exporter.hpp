@@ -0,0 +1,116 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/exporter.hpp
+ */
+
+#ifndef EXPORTER_HPP_
+#define EXPORTER_HPP_
+
+#include <m3d/m3d.hpp>
+#include <boost/thread/mutex.hpp>
+#include <Newton.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * Streams the state of all bodies and the contact events of a run
+ * into two CSV files, for the analysis with other tools. The rows are
+ * written after each step, so the memory does not grow with the length
+ * of the run.
+ *
+ * <base>_bodies.csv: step, time, body, id, type, position, orientation
+ *                    (w, x, y, z), linear and angular velocity, sleeping
+ * <base>_events.csv: step, time, event, body0, body1, material0,
+ *                    material1, speed, position
+ *
+ * The body column is an index that is unique for each body during the
+ * export, the id column is the id of the object, which is only unique
+ * among the objects of a compound.
+ */
+class Exporter {
+protected:
+	/** A contact reported by the material callback */
+	struct Contact {
+		const NewtonBody* body0;
+		const NewtonBody* body1;
+		int material0, material1;
+		float speed;
+		Vec3f position;
+	};
+
+	std::ofstream m_bodies;
+	std::ofstream m_events;
+
+	/** Bodies are written every m_interval steps */
+	unsigned m_interval;
+
+	/** Contacts with a lower normal speed are not written */
+	float m_minImpactSpeed;
+
+	unsigned long m_step;
+	float m_time;
+
+	std::map<const NewtonBody*, unsigned> m_indices;
+
+	/** Contacts are reported by the callbacks of all threads */
+	boost::mutex m_mutex;
+	std::vector<Contact> m_contacts;
+
+	/** @return The index of the body, assigns a new one on first use */
+	unsigned getIndex(const NewtonBody* body);
+public:
+	/**
+	 * Opens the files of the export.
+	 *
+	 * @param baseName       The base name of the CSV files
+	 * @param interval       The bodies are written every interval steps
+	 * @param minImpactSpeed The minimum normal speed of exported contacts
+	 */
+	Exporter(const std::string& baseName, unsigned interval, float minImpactSpeed);
+	virtual ~Exporter();
+
+	/** @return True, if both files could be opened */
+	bool isOpen() const;
+
+	/** @return The minimum normal speed of exported contacts */
+	float getMinImpactSpeed() const;
+
+	/**
+	 * Adds the fastest contact of a contact joint to the current
+	 * step. Thread-safe.
+	 */
+	void addContact(const NewtonBody* body0, const NewtonBody* body1,
+			int material0, int material1, float speed, const Vec3f& position);
+
+	/**
+	 * Writes the contacts of the last step, and the state of all
+	 * bodies if the step is a sampled one.
+	 *
+	 * @param world    The world after the step
+	 * @param timestep The duration of the step in seconds
+	 */
+	void step(const NewtonWorld* world, float timestep);
+};
+
+
+// inline methods
+
+inline bool Exporter::isOpen() const
+{
+	return m_bodies.is_open() && m_events.is_open();
+}
+
+inline float Exporter::getMinImpactSpeed() const
+{
+	return m_minImpactSpeed;
+}
+
+}
+
+#endif /* EXPORTER_HPP_ */
@@ -0,0 +1,158 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/layout.hpp
+ */
+
+#ifndef LAYOUT_HPP_
+#define LAYOUT_HPP_
+
+#include <simulation/object.hpp>
+#include <m3d/m3d.hpp>
+#include <xml/rapidxml.hpp>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * The parameters of a procedural domino layout. A parameter file is
+ * a "layouts" node with one "layout" node per layout, the attributes
+ * have the names of the members, e.g.
+ *
+ * <layouts>
+ *     <layout generator="tree" type="domino_small" count="100000" seed="7"/>
+ * </layouts>
+ *
+ * Angles are in degrees. Missing attributes keep their default.
+ */
+struct LayoutParams {
+	/** spiral, field, text, image, tree or lanes */
+	std::string generator;
+
+	/** The size class of the dominoes, DOMINO_SMALL to DOMINO_LARGE */
+	__Object::Type type;
+
+	std::string material;
+
+	/** The distance of two dominoes in a line, 0 for the gap of the type */
+	float gap;
+
+	/** The maximum number of dominoes */
+	unsigned count;
+
+	/** The seed of the random variations of the field and the tree */
+	unsigned seed;
+
+	/** The position and the rotation around the y-axis of the layout */
+	Vec3f origin;
+	float rotation;
+
+	/**
+	 * The distance of parallel lines: the windings of the spiral, the
+	 * rows of the field (at least two gaps), the lanes, and the pixel
+	 * rows of text and image. The turning radius of the branches of the
+	 * tree. 0 for a default that depends on the generator.
+	 */
+	float spacing;
+
+	/** field: the number of rows that branch off the trunk, 0 for an about square field */
+	unsigned rows;
+
+	/** field, tree: the random variation of the lengths and angles, from 0 to 1 */
+	float jitter;
+
+	/** text: the text, only letters, digits and some punctuation */
+	std::string text;
+
+	/** text: each pixel of the font is a square of scale x scale dominoes */
+	unsigned scale;
+
+	/** image: the file name, dark pixels below the threshold get a domino */
+	std::string image;
+	float threshold;
+
+	/** tree: the number of levels and the angle between two branches */
+	unsigned depth;
+	float angle;
+
+	/** lanes: the number of parallel lanes, rounded down to a power of two */
+	unsigned lanes;
+
+	/** If true, the first domino of each line is tilted, so that it topples */
+	bool tilt;
+
+	/** If true, the dominoes are placed on the ground, otherwise at the origin */
+	bool place;
+
+	LayoutParams();
+
+	/** Reads the attributes of the node, see above */
+	void load(rapidxml::xml_node<>* node);
+
+	/** @return The gap, or the default gap of the type */
+	float getGap() const;
+};
+
+class LayoutBuilder;
+
+/**
+ * Generates procedural domino layouts for large runs. The generators
+ * emit the matrices of all dominoes, which are created and placed in
+ * a single batch, see __Domino::createDominoes(). Dominoes that would
+ * overlap a domino of another line are skipped, and the line ends
+ * there. All random variations depend only on the seed, so a layout
+ * is reproducible from its parameters.
+ *
+ * Lines split into two by placing the first dominoes of both branches
+ * side by side in front of the last domino of the parent, and merge by
+ * placing the last dominoes side by side behind the first domino of
+ * the merged line.
+ */
+class LayoutGenerator {
+protected:
+	static void spiral(const LayoutParams& params, LayoutBuilder& builder);
+	static void field(const LayoutParams& params, LayoutBuilder& builder);
+	static void text(const LayoutParams& params, LayoutBuilder& builder);
+	static void image(const LayoutParams& params, LayoutBuilder& builder);
+	static void tree(const LayoutParams& params, LayoutBuilder& builder);
+	static void lanes(const LayoutParams& params, LayoutBuilder& builder);
+
+	/** Adds the lit pixels of a bitmap, row by row */
+	static void bitmap(const LayoutParams& params, const std::vector<bool>& pixels,
+			unsigned width, unsigned height, LayoutBuilder& builder);
+public:
+	/**
+	 * Generates the matrices of the dominoes. The dominoes stand on the
+	 * plane at the height of the origin.
+	 *
+	 * @param params   The parameters of the layout
+	 * @param matrices The matrices are appended to this list
+	 * @return         The number of generated dominoes, 0 if the generator is unknown
+	 */
+	static unsigned generate(const LayoutParams& params, std::vector<Mat4f>& matrices);
+
+	/**
+	 * Generates the layout and adds the dominoes to the simulation in
+	 * one batch. They are placed on the ground with the placement filter
+	 * of the simulation, if params.place is set.
+	 *
+	 * @param params The parameters of the layout
+	 * @return       The number of added dominoes
+	 */
+	static unsigned create(const LayoutParams& params);
+
+	/**
+	 * Creates all layouts of a parameter file.
+	 *
+	 * @param fileName The parameter file
+	 * @param scale    The counts of all layouts are multiplied by the scale
+	 * @return         The number of added dominoes
+	 */
+	static unsigned load(const std::string& fileName, unsigned scale = 1);
+};
+
+}
+
+#endif /* LAYOUT_HPP_ */
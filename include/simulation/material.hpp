@@ -269,6 +269,15 @@ public:
 	 */
 	MaterialPair& getPair(int mat0, int mat1);
 
+	/**
+	 * Plays the impact sound at the position, if it is close enough
+	 * to the camera, and adds it to the recording.
+	 *
+	 * @param sound    The name of the sound
+	 * @param position The position of the impact
+	 */
+	void playImpactSound(const std::string& sound, const m3d::Vec3f& position);
+
 	/**
 	 * The Newton callback called when a contact is being resolved.
 	 *
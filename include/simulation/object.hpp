@@ -10,7 +10,9 @@
 
 #include <boost/tr1/memory.hpp>
 #include <string>
+#include <map>
 #include <simulation/body.hpp>
+#include <newton/util.hpp>
 #include <opengl/vertexbuffer.hpp>
 #include <lib3ds/file.h>
 #include <xml/rapidxml.hpp>
@@ -153,10 +155,23 @@ public:
 	/**
 	 * Sets the vertical position of the object according to the convex cast of its collision.
 	 *
-	 * @param apply True, if the new position should be applied, False otherwise
-	 * @return      The new vertical position
+	 * @param apply       True, if the new position should be applied, False otherwise
+	 * @param noCollision The bodies that are ignored by the cast, or NULL
+	 * @return            The new vertical position
 	 */
-	virtual float convexCastPlacement(bool apply = true, std::list<NewtonBody*>* noCollision = NULL) = 0;
+	virtual float convexCastPlacement(bool apply = true, const newton::BodySet* noCollision = NULL) = 0;
+
+	/**
+	 * Places all objects on the ground, as if convexCastPlacement() was
+	 * called for each one. The objects are placed independently and do
+	 * not land on each other, see newton::getConvexCastOffsets().
+	 *
+	 * @param objects The objects to place
+	 */
+	static void convexCastPlacements(const std::vector<Object>& objects);
+
+	/** Appends the NewtonBodies of the object to the list */
+	virtual void getBodies(std::vector<NewtonBody*>& bodies) = 0;
 
 	/**
 	 * Checks whether this object contains the given NewtonBody.
@@ -218,6 +233,9 @@ protected:
 	/** The damping of the body. x,y,z = angular, w = linear damping */
 	Vec4f m_damping;
 
+	// the template manager clones the bodies of its prototypes
+	friend class TemplateMgr;
+
 	// protected constructors to prevent direct public instantiation
 	__RigidBody(Type type, NewtonBody* body, const std::string& material = "", int freezeState = 0, const Vec4f& damping = Vec4f(0.1f, 0.1f, 0.1f, 0.1f));
 	__RigidBody(Type type, const Mat4f& matrix, const std::string& material = "", int freezeState = 0, const Vec4f& damping = Vec4f(0.1f, 0.1f, 0.1f, 0.1f));
@@ -240,7 +258,9 @@ public:
 
 	virtual bool scale(const Vec3f& scale, bool add = false);
 
-	virtual float convexCastPlacement(bool apply = true, std::list<NewtonBody*>* noCollision = NULL);
+	virtual float convexCastPlacement(bool apply = true, const newton::BodySet* noCollision = NULL);
+
+	virtual void getBodies(std::vector<NewtonBody*>& bodies);
 
 	virtual bool contains(const NewtonBody* const body);
 	virtual bool contains(const __Object* object);
@@ -294,9 +314,27 @@ protected:
 	/** The file the object was loaded from */
 	std::string m_fileName;
 
+	// the template manager clones the bodies of its prototypes
+	friend class TemplateMgr;
+
 	/** The visual representation of the object */
 	ogl::Mesh m_visual;
 
+	/**
+	 * The collision and the visual of a model file. They are shared by
+	 * all convex objects with the same type, model file and material.
+	 */
+	struct Shape {
+		NewtonCollision* collision;
+		ogl::Mesh visual;
+	};
+
+	/**
+	 * Shape cache, indexed by type, model file and material. Loading
+	 * the model and generating the hulls is done only once per key.
+	 */
+	static std::map<std::string, Shape> s_shapes;
+
 	// protected constructor to prevent direct public instantiation
 	__Convex(Type type, const Mat4f& matrix, float mass, const std::string& material, const std::string& fileName,
 			int freezeState = 0, const Vec4f& damping = Vec4f(0.1f, 0.1f, 0.1f, 0.1f));
@@ -331,6 +369,12 @@ public:
 	static Convex createAssembly(const Mat4f& matrix, float mass, const std::string& material, const std::string& fileName,
 			int freezeState = 0, const Vec4f& damping = Vec4f(0.1f, 0.1f, 0.1f, 0.1f));
 
+	/**
+	 * Releases all cached shapes. Has to be called before the Newton
+	 * world is destroyed.
+	 */
+	static void freeShapes();
+
 	virtual void genBuffers(ogl::VertexBuffer& vbo);
 
 	/**
@@ -0,0 +1,124 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/physicslod.hpp
+ */
+
+#ifndef PHYSICSLOD_HPP_
+#define PHYSICSLOD_HPP_
+
+#include <simulation/topplelod.hpp>
+#include <m3d/m3d.hpp>
+#include <boost/unordered_map.hpp>
+#include <Newton.h>
+
+namespace sim {
+
+using namespace m3d;
+
+/** The treatment of a dynamic body by the solver */
+typedef enum {
+	TIER_FULL = 0, //!< Solved until Newton puts it to sleep
+	TIER_REDUCED,  //!< Frozen as soon as it is slow
+	TIER_FROZEN    //!< Frozen unless another body touches it
+} PhysicsTier;
+
+/** The number of dynamic bodies per tier after the last step */
+struct PhysicsLodSummary {
+	unsigned full;
+	unsigned reduced;
+	unsigned frozen;
+
+	/** The number of steps with the reduced solver since the start */
+	unsigned reducedSteps;
+};
+
+/**
+ * Assigns the dynamic bodies to tiers by their distance to the camera,
+ * if the option "physicsLod" is set. Bodies closer than "physicsLodNear"
+ * are in the full tier, bodies further away than "physicsLodFar" in the
+ * frozen tier, all others in the reduced tier:
+ *
+ * - Bodies of the reduced tier are frozen once they are slower than
+ *   "physicsLodSpeed", instead of waiting for Newton's sleep test.
+ * - Bodies of the frozen tier are frozen even while they move.
+ * - Bodies that touch another awake dynamic body are never frozen, and
+ *   Newton wakes frozen bodies when they are hit.
+ * - Frozen bodies are woken when the camera comes close enough to
+ *   leave the tier they were frozen in.
+ *
+ * The solver of Newton 2 works on the whole world, so the iterations
+ * are reduced per step instead of per body. The step uses the linear
+ * solver with "physicsLodPasses" passes, if no awake body is in the
+ * full tier, and the adaptive solver otherwise.
+ *
+ * The tiers follow the camera, so the option would break the determinism
+ * of the simulation and is ignored in the deterministic mode. Bodies with
+ * joints and the dominoes of the ToppleLod are left alone.
+ */
+class PhysicsLod {
+protected:
+	bool m_started;
+	bool m_enabled;
+	float m_near;
+	float m_far;
+	float m_speed;
+	int m_passes;
+
+	/** The bodies frozen by the level of detail, with the tier they were frozen in */
+	boost::unordered_map<NewtonBody*, PhysicsTier> m_frozen;
+
+	/** The solver model of the last step */
+	int m_solver;
+
+	PhysicsLodSummary m_summary;
+
+	/** @return True, if an awake dynamic body touches the body */
+	static bool isContacted(const NewtonBody* body);
+
+	/** Sets the solver model of the world, if it changed */
+	void setSolver(int model);
+public:
+	PhysicsLod();
+
+	/** Wakes the frozen bodies, the next step() reads the options again */
+	void reset();
+
+	/** @return True, if the option "physicsLod" was set at the first step */
+	bool isEnabled() const;
+
+	/** @return True, if the level of detail froze the body */
+	bool isFrozen(const NewtonBody* body) const;
+
+	/**
+	 * Assigns the tiers after a step and chooses the solver of the
+	 * next step.
+	 *
+	 * @param camera The position of the camera
+	 * @param lod    The level of detail of the dominoes, which are skipped
+	 */
+	void step(const Vec3f& camera, const ToppleLod& lod);
+
+	const PhysicsLodSummary& getSummary() const;
+};
+
+
+// inline methods
+
+inline bool PhysicsLod::isEnabled() const
+{
+	return m_enabled;
+}
+
+inline bool PhysicsLod::isFrozen(const NewtonBody* body) const
+{
+	return m_frozen.find(const_cast<NewtonBody*>(body)) != m_frozen.end();
+}
+
+inline const PhysicsLodSummary& PhysicsLod::getSummary() const
+{
+	return m_summary;
+}
+
+}
+
+#endif /* PHYSICSLOD_HPP_ */
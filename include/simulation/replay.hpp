@@ -0,0 +1,310 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/replay.hpp
+ */
+
+#ifndef REPLAY_HPP_
+#define REPLAY_HPP_
+
+#include <simulation/object.hpp>
+#include <m3d/m3d.hpp>
+#include <opengl/vertexbuffer.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/cstdint.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+/** The magic number at the beginning of a recording */
+#define REPLAY_MAGIC "DREC"
+
+/** The version of the stream format, version 2 adds the initial states */
+#define REPLAY_VERSION 2
+
+/** Every n-th frame contains the state of all bodies */
+#define REPLAY_KEYFRAME_INTERVAL 100
+
+/** Positions are stored as fixed point numbers with this scale */
+#define REPLAY_POSITION_SCALE 1024.0f
+
+/** Quaternion components are stored as fixed point numbers with this scale */
+#define REPLAY_ROTATION_SCALE 32767.0f
+
+/** The loaded bodies have to be this close to their initial state */
+#define REPLAY_MATCH_DISTANCE 0.01f
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * The quantized transformation of a single body. The position is
+ * stored in fixed point, the rotation as a normalized quaternion
+ * with a non-negative real part.
+ */
+struct ReplayState {
+	boost::int32_t pos[3];
+	boost::int32_t rot[4];
+
+	ReplayState();
+
+	/** Quantizes the given rigid transformation */
+	explicit ReplayState(const Mat4f& matrix);
+
+	/** @return The transformation matrix of the state */
+	Mat4f matrix() const;
+
+	bool operator==(const ReplayState& other) const;
+	bool operator!=(const ReplayState& other) const;
+};
+
+/**
+ * An event that occurred during a simulation step.
+ */
+struct ReplayEvent {
+	typedef enum {
+		SOUND = 0,	/**< A contact sound was played */
+		PICK		/**< The user picked a body with the mouse */
+	} Type;
+
+	Type type;
+
+	/** The name of the sound */
+	std::string sound;
+
+	/** The position of the sound, or the start of the pick ray */
+	Vec3f p0;
+
+	/** The end of the pick ray */
+	Vec3f p1;
+
+	/** True, if the mouse button was pressed */
+	bool down;
+};
+
+typedef std::vector<ReplayEvent> ReplayEvents;
+
+/**
+ * Enumerates the objects that are rendered in the order of the
+ * given vertex buffer. The order only depends on the order the
+ * objects were added, so it is the same after loading a level.
+ *
+ * @param buffers The sub-buffers of the vertex buffer
+ * @param result  The rendered objects, in order
+ */
+void getReplayObjects(const ogl::SubBuffers& buffers, std::vector<const __Object*>& result);
+
+/**
+ * Records the transformations of all bodies after each simulation
+ * step, together with the contact sounds and mouse picks. The header
+ * holds the states of the bodies when the recording started, in the
+ * order of getReplayObjects(). Only the
+ * bodies that changed are written, as variable length deltas to the
+ * previous frame. Every REPLAY_KEYFRAME_INTERVAL frames, the state of
+ * all bodies is written to allow seeking.
+ */
+class Recorder {
+protected:
+	std::ofstream m_file;
+	std::vector<const __Object*> m_objects;
+	std::vector<ReplayState> m_states;
+	unsigned m_frames;
+
+	/** Events are reported by the contact callbacks of all threads */
+	boost::mutex m_mutex;
+	ReplayEvents m_events;
+
+	std::vector<char> m_buffer;
+public:
+	/**
+	 * Creates a new recording.
+	 *
+	 * @param fileName  The file of the recording stream
+	 * @param levelFile The level the recording starts with
+	 * @param objects   The rendered objects, see getReplayObjects()
+	 * @param step      The duration of a single step in milliseconds
+	 */
+	Recorder(const std::string& fileName, const std::string& levelFile,
+			const std::vector<const __Object*>& objects, float step);
+	virtual ~Recorder();
+
+	/** @return True, if the file could be opened */
+	bool isOpen() const;
+
+	/** @return The number of recorded frames */
+	unsigned getFrameCount() const;
+
+	/** Adds a contact sound to the current frame. Thread-safe. */
+	void addSound(const std::string& name, const Vec3f& position);
+
+	/** Adds a mouse pick to the current frame. Thread-safe. */
+	void addPick(const Vec3f& p0, const Vec3f& p1, bool down);
+
+	/**
+	 * Writes the state of all bodies and the events since the
+	 * last call as a new frame.
+	 */
+	void record();
+};
+
+/**
+ * Plays a recording back. The stream is kept in memory and decoded
+ * on demand, seeking starts at the closest keyframe before the
+ * requested frame. The matrices are bit-identical to the quantized
+ * ones written by the Recorder, independent of how the frame was
+ * reached.
+ */
+class Player {
+protected:
+	std::string m_levelFile;
+	unsigned m_bodyCount;
+
+	/** The states when the recording started, empty for version 1 */
+	std::vector<ReplayState> m_initial;
+	float m_step;
+
+	std::vector<char> m_data;
+	std::vector<size_t> m_offsets;
+	std::vector<unsigned> m_keyframes;
+
+	std::map<const __Object*, unsigned> m_indices;
+	std::vector<ReplayState> m_states;
+	std::vector<Mat4f> m_matrices;
+
+	/** The frame of m_states, or -1 if nothing has been decoded */
+	int m_frame;
+	float m_time;
+	float m_speed;
+	bool m_paused;
+
+	/**
+	 * Decodes the frame into m_states. The state has to be the
+	 * one of the previous frame, unless it is a keyframe.
+	 *
+	 * @param frame  The frame to decode
+	 * @param events If not NULL, receives the events of the frame
+	 */
+	void decode(unsigned frame, ReplayEvents* events);
+public:
+	Player();
+	virtual ~Player();
+
+	/**
+	 * Reads the recording. Failures are reported with the ErrorAdapter.
+	 *
+	 * @param fileName The file of the recording stream
+	 * @return         True, if the stream was read successfully
+	 */
+	bool open(const std::string& fileName);
+
+	/** @return The level the recording starts with */
+	const std::string& getLevelFile() const;
+
+	/**
+	 * Maps the loaded objects to the recorded bodies.
+	 *
+	 * The objects have to be at the initial states of the recording,
+	 * otherwise the level or the order of its bodies differs.
+	 *
+	 * @param objects The rendered objects, see getReplayObjects()
+	 * @return        True, if the objects match the recording
+	 */
+	bool attach(const std::vector<const __Object*>& objects);
+
+	/**
+	 * Advances the playback by the given time, scaled by the speed.
+	 * The events of the frames played in between are returned,
+	 * unless the playback jumped by seeking.
+	 *
+	 * @param delta  The elapsed real time in seconds
+	 * @param events Receives the events of the played frames
+	 */
+	void update(float delta, ReplayEvents& events);
+
+	/** Jumps to the given frame, clamped to the recording */
+	void seek(int frame);
+
+	/** @return The current frame */
+	int getFrame() const;
+
+	/** @return The number of frames of the recording */
+	unsigned getFrameCount() const;
+
+	void setSpeed(float speed);
+	float getSpeed() const;
+
+	void setPaused(bool paused);
+	bool isPaused() const;
+
+	/**
+	 * Returns the recorded matrix of the object in the current frame,
+	 * or the matrix of the object itself if it was not recorded.
+	 */
+	const Mat4f& getMatrix(const __Object* object) const;
+};
+
+
+// inline methods
+
+inline bool ReplayState::operator!=(const ReplayState& other) const
+{
+	return !(*this == other);
+}
+
+inline bool Recorder::isOpen() const
+{
+	return m_file.is_open();
+}
+
+inline unsigned Recorder::getFrameCount() const
+{
+	return m_frames;
+}
+
+inline const std::string& Player::getLevelFile() const
+{
+	return m_levelFile;
+}
+
+inline int Player::getFrame() const
+{
+	return m_frame;
+}
+
+inline unsigned Player::getFrameCount() const
+{
+	return m_offsets.size();
+}
+
+inline void Player::setSpeed(float speed)
+{
+	m_speed = speed;
+}
+
+inline float Player::getSpeed() const
+{
+	return m_speed;
+}
+
+inline void Player::setPaused(bool paused)
+{
+	m_paused = paused;
+}
+
+inline bool Player::isPaused() const
+{
+	return m_paused;
+}
+
+inline const Mat4f& Player::getMatrix(const __Object* object) const
+{
+	std::map<const __Object*, unsigned>::const_iterator itr = m_indices.find(object);
+	if (itr == m_indices.end() || m_frame < 0)
+		return object->getMatrix();
+	return m_matrices[itr->second];
+}
+
+}
+
+#endif /* REPLAY_HPP_ */
@@ -0,0 +1,88 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/scenegen.hpp
+ */
+
+#ifndef SCENEGEN_HPP_
+#define SCENEGEN_HPP_
+
+#include <m3d/m3d.hpp>
+#include <string>
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * Generates synthetic scenes of a configurable size through the public
+ * Simulation API. The scenes are deterministic, so they can be used to
+ * compare the performance between revisions. All methods add to the
+ * current simulation and return the number of added objects.
+ */
+class SceneGenerator {
+public:
+	/**
+	 * Adds a static box as the ground, its top is at y = 0.
+	 *
+	 * @param size The width and depth of the ground
+	 */
+	static unsigned ground(float size = 1000.0f);
+
+	/**
+	 * Adds an archimedean spiral of middle dominos that starts at the
+	 * center. The first domino is tilted, so that the spiral topples.
+	 *
+	 * @param count The number of dominos
+	 */
+	static unsigned dominoSpiral(unsigned count);
+
+	/**
+	 * Adds parallel rows of middle dominos. The first domino of each
+	 * row is tilted.
+	 *
+	 * @param rows The number of rows
+	 * @param cols The number of dominos per row
+	 */
+	static unsigned dominoGrid(unsigned rows, unsigned cols);
+
+	/**
+	 * Adds stacks of boxes.
+	 *
+	 * @param stacks The number of stacks
+	 * @param height The number of boxes per stack
+	 */
+	static unsigned boxStacks(unsigned stacks, unsigned height);
+
+	/**
+	 * Adds triangles of tenpins in the bowling layout.
+	 *
+	 * @param pyramids The number of triangles
+	 * @param rows     The number of rows per triangle
+	 */
+	static unsigned tenpinPyramids(unsigned pyramids, unsigned rows);
+
+	/**
+	 * Adds compounds of boxes hanging from a static anchor, connected
+	 * by hinges. The chains start horizontally, so they swing down.
+	 *
+	 * @param chains The number of chains
+	 * @param links  The number of links per chain
+	 */
+	static unsigned hingedChains(unsigned chains, unsigned links);
+
+	/**
+	 * Adds the scene with the given name, scaled by the given factor.
+	 * Known names are "spiral", "grid", "stacks", "tenpins" and "chains",
+	 * and the layouts "field", "tree" and "lanes" of 10000 dominoes. Names
+	 * that end with ".xml" are layout files, see LayoutGenerator::load().
+	 *
+	 * @param name  The name of the scene
+	 * @param scale The size factor of the scene
+	 * @return      The number of added objects, 0 if the name is unknown
+	 */
+	static unsigned generate(const std::string& name, unsigned scale = 1);
+};
+
+}
+
+#endif /* SCENEGEN_HPP_ */
@@ -0,0 +1,128 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/settle.hpp
+ */
+
+#ifndef SETTLE_HPP_
+#define SETTLE_HPP_
+
+#include <simulation/topplelod.hpp>
+#include <simulation/physicslod.hpp>
+#include <m3d/m3d.hpp>
+#include <boost/unordered_map.hpp>
+#include <Newton.h>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * Turns the dynamic bodies that came to rest into static bodies, if the
+ * option "settleBodies" is set. A body is settled after it was slower
+ * than "settleSpeed" for "settleSteps" steps in a row. Newton puts
+ * resting bodies to sleep, but they stay in the islands of the bodies
+ * they touch and are woken with them. Static bodies are neither solved
+ * nor woken, so the cost of a step follows the motion in the scene
+ * instead of the number of bodies.
+ *
+ * A settled body is restored, when a moving body comes closer than
+ * "settleMargin" to its bounding box, when it is picked, or on demand.
+ * Bodies with joints, the dominoes of the ToppleLod and the bodies
+ * frozen by the PhysicsLod are left alone. A frozen body may be in
+ * mid-air, only the PhysicsLod wakes it again.
+ */
+class SettleManager {
+protected:
+	struct BodyInfo {
+		/** The number of steps the body has been slow */
+		unsigned steps;
+		bool settled;
+
+		/** The mass and inertia of the dynamic body */
+		float mass;
+		Vec3f inertia;
+	};
+
+	typedef boost::unordered_map<NewtonBody*, BodyInfo> BodyMap;
+
+	bool m_started;
+	bool m_enabled;
+	float m_speed;
+	unsigned m_steps;
+	float m_margin;
+
+	BodyMap m_bodies;
+	unsigned m_settled;
+
+	/** Turns the body into a static body */
+	void settle(NewtonBody* body, BodyInfo& info);
+
+	/** Turns the body into an awake dynamic body */
+	void restore(NewtonBody* body, BodyInfo& info);
+
+	/** Collects the bodies in a box, see NewtonWorldForEachBodyInAABBDo() */
+	static void collectBody(const NewtonBody* body, void* userData);
+public:
+	SettleManager();
+
+	/** Restores all bodies, the next step() reads the options again */
+	void reset();
+
+	/** @return True, if the option "settleBodies" was set at the first step */
+	bool isEnabled() const;
+
+	/**
+	 * Restores the settled bodies near moving ones and settles the
+	 * bodies that rested long enough. Has to be called after each step.
+	 *
+	 * @param lod     The level of detail, its dominoes are skipped
+	 * @param physics The level of detail of the bodies, its frozen bodies are skipped
+	 */
+	void step(const ToppleLod& lod, const PhysicsLod& physics);
+
+	/** Restores all settled bodies */
+	void restore();
+
+	/**
+	 * Restores the settled bodies that overlap the box.
+	 *
+	 * @param min The minimum of the box
+	 * @param max The maximum of the box
+	 * @return    The number of restored bodies
+	 */
+	unsigned restore(const Vec3f& min, const Vec3f& max);
+
+	/**
+	 * Restores the nearest body along the ray, if it is settled, so
+	 * that it can be picked with the mouse.
+	 *
+	 * @param p0 The start of the ray
+	 * @param p1 The end of the ray
+	 * @return   True, if a body was restored
+	 */
+	bool restoreRay(const Vec3f& p0, const Vec3f& p1);
+
+	/** @return True, if the body has been settled */
+	bool isSettled(const NewtonBody* body) const;
+
+	/** @return The number of settled bodies */
+	unsigned getSettledCount() const;
+};
+
+
+// inline methods
+
+inline bool SettleManager::isEnabled() const
+{
+	return m_enabled;
+}
+
+inline unsigned SettleManager::getSettledCount() const
+{
+	return m_settled;
+}
+
+}
+
+#endif /* SETTLE_HPP_ */
@@ -15,12 +15,24 @@
 #include <opengl/skydome.hpp>
 #include <opengl/framebuffer.hpp>
 #include <simulation/object.hpp>
+#include <simulation/replay.hpp>
+#include <simulation/exporter.hpp>
+#include <simulation/topple.hpp>
+#include <simulation/topplelod.hpp>
+#include <simulation/settle.hpp>
+#include <simulation/physicslod.hpp>
+#include <simulation/chaincheck.hpp>
+#include <simulation/dominopath.hpp>
+#include <newton/util.hpp>
 #include <map>
 #include <Newton.h>
 #include <iostream>
 
 #define SHADOW_MAP_SIZE 4096
 
+/** The real time in milliseconds that is simulated by a single step */
+#define SIMULATION_STEP 12.0f
+
 namespace sim {
 
 using namespace m3d;
@@ -63,11 +75,12 @@ public:
 		INT_MOVE_BILLBOARD,	/**< Move the object along the Y-axis and perpendicular to the camera. */
 		INT_ROTATE_GROUND,  /**< Rotate the object around the Y-axis by moving the mouse along the ground plane */
 		INT_DOMINO_CURVE,	/**< Create a domino curve by creating multiple control points */
-		INT_CREATE_OBJECT
+		INT_CREATE_OBJECT,
+		INT_EDIT_PATH		/**< Move the knots of domino paths, the dominoes follow on release */
 	} InteractionType;
 private:
 	static Simulation* s_instance;
-	Simulation(util::KeyAdapter& keyAdapter, util::MouseAdapter& mouseAdapter);
+	Simulation(util::KeyAdapter& keyAdapter, util::MouseAdapter& mouseAdapter, bool headless);
 	virtual ~Simulation();
 
 protected:
@@ -88,6 +101,18 @@ protected:
 	Vec3f m_pointer;
 
 	bool m_enabled;
+
+	/** If true, nothing is uploaded to or rendered with OpenGL */
+	bool m_headless;
+
+	/**
+	 * If true, the world uses a fixed thread and platform configuration
+	 * and update() advances the physics by a fixed number of steps.
+	 */
+	bool m_deterministic;
+
+	/** The number of steps per update() in deterministic mode */
+	int m_deterministicSteps;
 	__Object::Type m_newObjectType;
 	std::string m_newObjectMaterial;
 	std::string m_newObjectFilename;
@@ -97,6 +122,9 @@ protected:
 
 	int m_nextID;
 	ObjectList m_objects;
+
+	/** The size of the objects and their sub-buffers, see upload() */
+	size_t m_objectBytes;
 	Object m_environment;
 
 	/** The currently selected object, or an empty smart pointer */
@@ -124,6 +152,62 @@ protected:
 	ogl::Skydome m_skydome;
 	Vec4f m_lightPos;
 
+	/** The recorder of the current run, or NULL */
+	Recorder* m_recorder;
+
+	/** The player of a recorded run, or NULL. Disables the physics. */
+	Player* m_player;
+
+	/** The export of the trajectories and contacts, or NULL */
+	Exporter* m_exporter;
+
+	/** Tracks the dominoes from the first step after a change of the objects */
+	ToppleTracker m_topple;
+
+	/** Keeps only the dominoes near the moving bodies dynamic, see "toppleLod" */
+	ToppleLod m_toppleLod;
+
+	/** Turns the bodies that came to rest into static ones, see "settleBodies" */
+	SettleManager m_settle;
+
+	/** Freezes the bodies far from the camera, see "physicsLod" */
+	PhysicsLod m_physicsLod;
+
+	/** If true, the dominoes that have been hit are coloured by their hit time */
+	bool m_toppleColors;
+
+	/** Predicts the links of the dominoes, checked again after a change */
+	ChainChecker m_chainCheck;
+
+	/** If true, the dominoes with weak or failing links are coloured while stopped */
+	bool m_chainColors;
+
+	/** The bodies the placement tools put new dominoes on */
+	newton::HeightFilter m_placementFilter;
+
+	/** The domino paths of the curve tool */
+	std::list<DominoPath> m_paths;
+
+	/** The path and the knot that is moved with INT_EDIT_PATH */
+	DominoPath m_editPath;
+	int m_editKnot;
+
+	/**
+	 * Resets the levels of detail, the settled bodies, the topple
+	 * tracking and the chain check, e.g. when the objects change.
+	 * They start again with the next step.
+	 */
+	void resetAnalysis();
+
+	/**
+	 * Invalidates the cached ground heights below the object, if it
+	 * may be static, and the predicted links of the dominoes
+	 */
+	void invalidateHeights(const Object& object);
+
+	/** @return The matrix of the object that is rendered */
+	const Mat4f& getRenderMatrix(const __Object* object) const;
+
 	/**
 	 * Uploads the vertex data of all objects between begin
 	 * and end, not including end.
@@ -146,9 +230,11 @@ public:
 	 *
 	 * @param keyAdapter
 	 * @param mouseAdapter
+	 * @param headless     True, if there is no OpenGL context
 	 */
 	static void createInstance(util::KeyAdapter& keyAdapter,
-								util::MouseAdapter& mouseAdapter);
+								util::MouseAdapter& mouseAdapter,
+								bool headless = false);
 
 	/**
 	 *
@@ -180,6 +266,31 @@ public:
 	/** @return True, if the simulation is enabled, false otherwise */
 	bool isEnabled();
 
+	/** @return True, if the simulation has no OpenGL context */
+	bool isHeadless();
+
+	/**
+	 * Enables the deterministic mode. The world configuration is
+	 * changed by the next init(), i.e. when loading a level. The
+	 * PhysicsLod follows the camera, so it is off while the mode is
+	 * enabled.
+	 *
+	 * @param deterministic True, if runs should be reproducible
+	 */
+	void setDeterministic(bool deterministic);
+
+	/** @return True, if the deterministic mode is enabled */
+	bool isDeterministic();
+
+	/**
+	 * Returns a hash of the matrices of all bodies, in the order they
+	 * were added. Two runs of the same level are identical if the
+	 * hashes are equal.
+	 *
+	 * @return The 64-bit FNV-1a hash of the matrices
+	 */
+	boost::uint64_t hashBodies();
+
 	/** @param type Set the type of objects that will be created to type */
 	void setNewObjectType(__Object::Type type);
 	void setNewObjectMaterial(const std::string& material);
@@ -234,6 +345,15 @@ public:
 	 */
 	int add(const Object& object, int id);
 
+	/**
+	 * Adds the objects and uploads them at once, which is much faster
+	 * than adding them one by one.
+	 *
+	 * @param objects The objects to add
+	 * @return        The id of the first object, or -1 if there is none
+	 */
+	int add(const std::vector<Object>& objects);
+
 	/**
 	 * Adds a new object that is described by the given info struct.
 	 *
@@ -249,6 +369,38 @@ public:
 	 */
 	void remove(const Object& object);
 
+	/**
+	 * Removes the objects and uploads once, which is much faster than
+	 * removing many dominoes one by one.
+	 *
+	 * @param objects The objects to remove
+	 * @param unlink  False, if the dominoes were already removed from
+	 *                their paths, e.g. by __DominoPath::update()
+	 */
+	void remove(const std::vector<Object>& objects, bool unlink = true);
+
+	/**
+	 * Creates a domino path through the knots and adds its dominoes.
+	 *
+	 * @param knots    The knots on the ground, at least two
+	 * @param type     The domino type
+	 * @param material The material of the dominoes
+	 * @param gap      The nominal gap
+	 * @return         The path
+	 */
+	DominoPath addPath(const std::vector<Vec2f>& knots, __Object::Type type, const std::string& material, float gap);
+
+	/**
+	 * Generates the dominoes of the path again after its knots were
+	 * changed, see __DominoPath::update().
+	 *
+	 * @param path The path
+	 */
+	void updatePath(const DominoPath& path);
+
+	/** @return The domino paths, which are saved with the level */
+	const std::list<DominoPath>& getPaths();
+
 	/**
 	 * Updates the geometry of the object by removing and re-adding it.
 	 *
@@ -269,6 +421,98 @@ public:
 	 *  @param fileName Path to XML file
 	 */
 	void load(const std::string& fileName);
+
+	/**
+	 * Starts to record the simulation. The current level is saved to
+	 * fileName + ".xml", which the playback loads, so it has to be kept
+	 * with the recording. The running simulation, its velocities and an
+	 * active export are not touched, the stream starts with the current
+	 * state of the bodies.
+	 *
+	 * @param fileName The file of the recording stream
+	 * @return         True, if the recording was started
+	 */
+	bool startRecording(const std::string& fileName);
+
+	/** Stops the recording and closes the stream */
+	void stopRecording();
+
+	/** @return The recorder, or NULL if the simulation is not recorded */
+	Recorder* getRecorder();
+
+	/**
+	 * Loads the level of the recording and plays it back. The
+	 * physics are not simulated during the playback.
+	 *
+	 * @param fileName The file of the recording stream
+	 * @return         True, if the playback was started
+	 */
+	bool startReplay(const std::string& fileName);
+
+	/** Stops the playback, the bodies remain in their initial state */
+	void stopReplay();
+
+	/** @return The player, or NULL if no recording is played back */
+	Player* getPlayer();
+
+	/**
+	 * Starts to export the state of the bodies and the contacts of
+	 * each step into the files baseName + "_bodies.csv" and
+	 * baseName + "_events.csv". The export stops when the level is
+	 * cleared.
+	 *
+	 * @param baseName The base name of the CSV files
+	 * @param interval The bodies are written every interval steps, the
+	 *                 option "exportInterval" if 0
+	 * @return         True, if the export was started
+	 */
+	bool startExport(const std::string& baseName, unsigned interval = 0);
+
+	/** Stops the export and closes the files */
+	void stopExport();
+
+	/** @return The exporter, or NULL if nothing is exported */
+	Exporter* getExporter();
+
+	/** @return The topple tracker of the dominoes */
+	const ToppleTracker& getToppleTracker();
+
+	/** @return The level of detail of the dominoes, follows the topple tracker */
+	const ToppleLod& getToppleLod();
+
+	/** @return The settled bodies, which can be restored on demand */
+	SettleManager& getSettleManager();
+
+	/** @return The tiers of the bodies by their distance to the camera */
+	const PhysicsLod& getPhysicsLod();
+
+	/** @param enabled True, if the dominoes should be coloured by their hit time */
+	void setToppleColors(bool enabled);
+
+	/** @return True, if the dominoes are coloured by their hit time */
+	bool getToppleColors();
+
+	/** @return The chain checker, checked at the next frame with chain colours */
+	ChainChecker& getChainChecker();
+
+	/** @param enabled True, if the dominoes with weak or failing links should be coloured */
+	void setChainColors(bool enabled);
+
+	/** @return True, if the dominoes are coloured by their predicted links */
+	bool getChainColors();
+
+	/**
+	 * Sets the bodies the placement tools put new dominoes on. Either
+	 * only static bodies, or all bodies including the dynamic ones.
+	 * The option "placeOnDynamicBodies" selects the initial filter.
+	 *
+	 * @param filter newton::HEIGHT_STATIC or newton::HEIGHT_ALL
+	 */
+	void setPlacementFilter(newton::HeightFilter filter);
+
+	/** @return The bodies the placement tools put new dominoes on */
+	newton::HeightFilter getPlacementFilter();
+
 	//void saveTemplate(const std::string& fileName, __Object& object);
 	//void loadTemplate(const std::string& fileName);
 
@@ -278,6 +522,12 @@ public:
 	virtual void mouseWheel(int delta);
 
 
+	/**
+	 * Advances the physics by a single fixed step, independent of
+	 * the elapsed time and of whether the simulation is enabled.
+	 */
+	void step();
+
 	void update();
 	void render();
 };
@@ -330,6 +580,103 @@ inline void Simulation::setNewObjectSize(const Vec3f size)
 	m_newObjectSize = size;
 }
 
+inline bool Simulation::isHeadless()
+{
+	return m_headless;
+}
+
+inline void Simulation::setDeterministic(bool deterministic)
+{
+	m_deterministic = deterministic;
+	if (deterministic)
+		m_physicsLod.reset();
+}
+
+inline bool Simulation::isDeterministic()
+{
+	return m_deterministic;
+}
+
+inline Recorder* Simulation::getRecorder()
+{
+	return m_recorder;
+}
+
+inline Player* Simulation::getPlayer()
+{
+	return m_player;
+}
+
+inline Exporter* Simulation::getExporter()
+{
+	return m_exporter;
+}
+
+inline const ToppleTracker& Simulation::getToppleTracker()
+{
+	return m_topple;
+}
+
+inline const ToppleLod& Simulation::getToppleLod()
+{
+	return m_toppleLod;
+}
+
+inline SettleManager& Simulation::getSettleManager()
+{
+	return m_settle;
+}
+
+inline const PhysicsLod& Simulation::getPhysicsLod()
+{
+	return m_physicsLod;
+}
+
+inline void Simulation::setToppleColors(bool enabled)
+{
+	m_toppleColors = enabled;
+}
+
+inline bool Simulation::getToppleColors()
+{
+	return m_toppleColors;
+}
+
+inline const std::list<DominoPath>& Simulation::getPaths()
+{
+	return m_paths;
+}
+
+inline ChainChecker& Simulation::getChainChecker()
+{
+	return m_chainCheck;
+}
+
+inline void Simulation::setChainColors(bool enabled)
+{
+	m_chainColors = enabled;
+}
+
+inline bool Simulation::getChainColors()
+{
+	return m_chainColors;
+}
+
+inline void Simulation::setPlacementFilter(newton::HeightFilter filter)
+{
+	m_placementFilter = filter;
+}
+
+inline newton::HeightFilter Simulation::getPlacementFilter()
+{
+	return m_placementFilter;
+}
+
+inline const Mat4f& Simulation::getRenderMatrix(const __Object* object) const
+{
+	return m_player ? m_player->getMatrix(object) : object->getMatrix();
+}
+
 inline ogl::Camera& Simulation::getCamera()
 {
 	return m_camera;
@@ -0,0 +1,195 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/template.hpp
+ */
+
+#ifndef TEMPLATE_HPP_
+#define TEMPLATE_HPP_
+
+#include <simulation/object.hpp>
+#include <simulation/joint.hpp>
+#include <xml/rapidxml.hpp>
+#include <Newton.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/tr1/memory.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+/** An object of a template prototype, see __Template */
+struct TemplateNode {
+	__Object::Type type;
+
+	/** The matrix of the object in the compound of the prototype */
+	Mat4f matrix;
+
+	std::string material;
+	std::string fileName;
+	float mass;
+	int freezeState;
+	Vec4f damping;
+
+	/** The collision of a primitive, shared by all clones */
+	NewtonCollision* collision;
+};
+
+/** A joint of a template prototype, the nodes are given by their index */
+struct TemplateJoint {
+	__Joint::Type type;
+	Vec3f pivot;
+	Vec3f pinDir;
+	int child;
+	int parent;
+	bool limited;
+
+	/** The limits of the hinge, slider or ball and socket, in the order of their create() */
+	float limits[3];
+};
+
+/**
+ * A parsed template file. The XML document is parsed in-situ, so it
+ * keeps the text of the file alive as long as the document exists.
+ *
+ * The prototype is captured from the first object that is loaded from
+ * the node. All later objects are cloned from the prototype, without
+ * going through the XML again.
+ */
+struct __Template {
+	/** The content of the template file, parsed in-situ */
+	std::vector<char> text;
+
+	/** The parsed document */
+	rapidxml::xml_document<> doc;
+
+	/** The object or compound tag of the template */
+	rapidxml::xml_node<>* node;
+
+	/** True, if the prototype has been captured */
+	bool captured;
+
+	/** True, if the prototype is a compound */
+	bool compound;
+
+	/** The matrix of the compound */
+	Mat4f matrix;
+
+	std::vector<TemplateNode> nodes;
+	std::vector<TemplateJoint> joints;
+
+	__Template() : node(NULL), captured(false), compound(false) {}
+};
+
+typedef std::tr1::shared_ptr<__Template> Template;
+
+/**
+ * The template manager parses each template file only once and
+ * keeps the prototype in memory. New objects are cloned from the
+ * prototype: primitives share its collisions, the collisions and
+ * meshes of convex objects are shared by the __Convex shape cache.
+ */
+class TemplateMgr {
+private:
+	// singleton
+	static TemplateMgr* s_instance;
+	TemplateMgr();
+	TemplateMgr(const TemplateMgr& other);
+	virtual ~TemplateMgr();
+
+protected:
+	/** The absolute file names mapped to the templates */
+	std::map<std::string, Template> m_templates;
+
+	/** Guards m_templates, templates may be parsed by a loader thread */
+	boost::mutex m_mutex;
+
+	/**
+	 * Reads and parses the template file.
+	 *
+	 * @param fileName The template file
+	 * @return         The template, or an empty smart pointer
+	 */
+	Template parse(const std::string& fileName);
+
+	/**
+	 * Captures the prototype from an object that was just loaded from
+	 * the node of the template.
+	 *
+	 * @param prototype The template
+	 * @param object    The loaded object
+	 * @return          False, if the object contains a type that cannot be cloned
+	 */
+	static bool capture(__Template& prototype, const Object& object);
+
+	/** Releases the collisions of the prototype and forgets it */
+	static void release(__Template& prototype);
+
+	/** @return A new object of the prototype at the given matrix */
+	static Object clone(const __Template& prototype, const Mat4f& matrix);
+
+	/** @return A new object of the node at the given matrix */
+	static Object clone(const TemplateNode& node, const Mat4f& matrix);
+
+public:
+	/**
+	 * Returns an instance of the TemplateMgr and creates it,
+	 * if there is none.
+	 *
+	 * @return The TemplateMgr
+	 */
+	static TemplateMgr& instance();
+
+	/**
+	 * Destroys the instance of the TemplateMgr
+	 */
+	static void destroy();
+
+	/**
+	 * Parses all templates in the folder. Does not create any Newton
+	 * bodies, so it can be called from any thread.
+	 *
+	 * @param folder The template folder
+	 * @return       The number of parsed templates
+	 */
+	unsigned load(const std::string& folder);
+
+	/**
+	 * Returns the template of the given file and parses it, if it
+	 * is not yet known.
+	 *
+	 * @param fileName The template file
+	 * @return         The template, or an empty smart pointer
+	 */
+	Template get(const std::string& fileName);
+
+	/**
+	 * Creates a new object from the template of the given file. The
+	 * first object is loaded from the XML node, all later ones are
+	 * cloned from its prototype. Has to be called from the thread that
+	 * owns the Newton world.
+	 *
+	 * @param fileName The template file
+	 * @param matrix   The matrix of the new object
+	 * @return         The new object, or an empty smart pointer
+	 */
+	Object create(const std::string& fileName, const Mat4f& matrix);
+
+	/**
+	 * Releases the collisions of all prototypes, the next object of a
+	 * template is loaded from the XML node again. Has to be called
+	 * before the Newton world is destroyed.
+	 */
+	void freePrototypes();
+
+	/**
+	 * Removes all templates. The prototypes have to be freed before.
+	 */
+	void clear();
+};
+
+}
+
+#endif /* TEMPLATE_HPP_ */
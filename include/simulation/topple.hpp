@@ -0,0 +1,211 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/topple.hpp
+ */
+
+#ifndef TOPPLE_HPP_
+#define TOPPLE_HPP_
+
+#include <simulation/domino.hpp>
+#include <m3d/m3d.hpp>
+#include <ostream>
+#include <vector>
+#include <map>
+
+namespace sim {
+
+using namespace m3d;
+
+/**
+ * The topple state of a single domino. Times are in seconds since
+ * the tracking started, -1 if the event did not happen yet.
+ */
+struct ToppleInfo {
+	const __Domino* domino;
+
+	/** The position and up vector when the tracking started */
+	Vec3f position;
+	Vec3f up;
+
+	/** The time the domino was hit, i.e. started to move */
+	float hitTime;
+
+	/** The time the domino came to rest after it had fallen */
+	float restTime;
+
+	/** The nearest domino that was hit before, or -1 */
+	int source;
+
+	/** The local speed of the wave from the source, or 0 */
+	float speed;
+};
+
+/**
+ * A stall of the wave, i.e. a time span in which no domino was hit
+ * while some dominoes were still standing.
+ */
+struct ToppleStall {
+	/** The last domino that was hit before the stall */
+	unsigned domino;
+
+	/** The time of the last hit */
+	float time;
+
+	/** The time until the next hit, or -1 if the wave did not resume */
+	float duration;
+};
+
+/**
+ * The summary of a cascade, for the comparison of layouts and spacings.
+ */
+struct ToppleSummary {
+	unsigned dominoes;
+	unsigned hit;
+	unsigned fallen;
+
+	float firstHit;
+	float lastHit;
+
+	/** The time from the first hit until the last domino came to rest */
+	float duration;
+
+	/** The path length of the wave along the dominoes */
+	float length;
+
+	/** The median of the local wave speeds */
+	float waveSpeed;
+
+	unsigned stalls;
+};
+
+/**
+ * Tracks the dominoes of the simulation while they topple. A domino
+ * is hit when it tilts or moves away from its initial placement, and
+ * fallen when it tilts by more than "toppleFallenAngle" degrees and
+ * its body has come to rest. For each hit domino, the nearest domino
+ * that was hit before gives the local speed of the wave front. The
+ * wave stalls if no domino was hit for "toppleStallTime" seconds.
+ */
+class ToppleTracker {
+protected:
+	bool m_started;
+	float m_time;
+
+	std::vector<ToppleInfo> m_dominoes;
+	std::map<const __Object*, unsigned> m_indices;
+
+	/** The hit times in the order of the hits, for the timeline */
+	std::vector<float> m_hitTimes;
+
+	/** The rest times in the order of the rests, for the timeline */
+	std::vector<float> m_restTimes;
+
+	std::vector<ToppleStall> m_stalls;
+
+	/** The last domino that was hit */
+	unsigned m_lastHit;
+
+	/** The indices of the hit dominoes in a grid on the xz-plane */
+	std::map<std::pair<int, int>, std::vector<unsigned> > m_grid;
+	float m_cellSize;
+
+	// thresholds, read from the config
+	float m_hitCos;
+	float m_fallenCos;
+	float m_stallTime;
+
+	/** Marks the domino as hit and finds the source of the wave */
+	void hit(unsigned index);
+
+	/** @return The grid cell of the position */
+	std::pair<int, int> getCell(const Vec3f& position) const;
+public:
+	ToppleTracker();
+
+	/** Stops the tracking, the next start() collects the dominoes again */
+	void reset();
+
+	/** @return True, if the dominoes are tracked */
+	bool isStarted() const;
+
+	/**
+	 * Starts the tracking of all dominoes in the list.
+	 *
+	 * @param objects The objects of the simulation, see getReplayObjects()
+	 */
+	void start(const std::vector<const __Object*>& objects);
+
+	/**
+	 * Checks the dominoes after a step.
+	 *
+	 * @param timestep The time of the step in seconds
+	 */
+	void step(float timestep);
+
+	/** @return The time since the tracking started */
+	float getTime() const;
+
+	const std::vector<ToppleInfo>& getDominoes() const;
+	const std::vector<float>& getHitTimes() const;
+	const std::vector<float>& getRestTimes() const;
+	const std::vector<ToppleStall>& getStalls() const;
+
+	/** @return The info of the domino, or NULL if it is not tracked */
+	const ToppleInfo* getInfo(const __Object* object) const;
+
+	/**
+	 * Returns the colour of a domino by its hit time, from blue for
+	 * the first to red for the last hit.
+	 *
+	 * @param object The object
+	 * @param color  The colour
+	 * @return       True, if the object is a domino that has been hit
+	 */
+	bool getColor(const __Object* object, Vec4f& color) const;
+
+	/** @return The summary of the cascade so far */
+	ToppleSummary getSummary() const;
+
+	/** Writes the summary as a CSV header and row */
+	void writeSummary(std::ostream& out) const;
+
+	/** Writes a CSV header and a row with the position and times of each domino */
+	void writeDominoes(std::ostream& out) const;
+};
+
+
+// inline methods
+
+inline bool ToppleTracker::isStarted() const
+{
+	return m_started;
+}
+
+inline float ToppleTracker::getTime() const
+{
+	return m_time;
+}
+
+inline const std::vector<ToppleInfo>& ToppleTracker::getDominoes() const
+{
+	return m_dominoes;
+}
+
+inline const std::vector<float>& ToppleTracker::getHitTimes() const
+{
+	return m_hitTimes;
+}
+
+inline const std::vector<float>& ToppleTracker::getRestTimes() const
+{
+	return m_restTimes;
+}
+
+inline const std::vector<ToppleStall>& ToppleTracker::getStalls() const
+{
+	return m_stalls;
+}
+
+}
+
+#endif /* TOPPLE_HPP_ */
@@ -0,0 +1,175 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/topplelod.hpp
+ */
+
+#ifndef TOPPLELOD_HPP_
+#define TOPPLELOD_HPP_
+
+#include <simulation/topple.hpp>
+#include <simulation/domino.hpp>
+#include <m3d/m3d.hpp>
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+namespace sim {
+
+using namespace m3d;
+
+/** The representation of a domino */
+typedef enum {
+	LOD_DYNAMIC = 0, //!< A full rigid body
+	LOD_STANDING,    //!< A static body in its standing pose
+	LOD_FALLING,     //!< A static body that follows the fall curve
+	LOD_RESTING      //!< A static body in its resting pose
+} LodState;
+
+/** The number of dominoes per representation */
+struct ToppleLodSummary {
+	unsigned dynamic;
+	unsigned standing;
+	unsigned falling;
+	unsigned resting;
+
+	/** The largest number of dynamic dominoes since the start */
+	unsigned peakDynamic;
+};
+
+/**
+ * Keeps only the dominoes near the moving bodies as full rigid bodies,
+ * if the option "toppleLod" is set. All other dominoes are static
+ * bodies, which are not solved and do not join the islands of the
+ * moving ones:
+ *
+ * - Standing dominoes more than two windows away from any moving body
+ *   are static until a moving body comes closer than one window, see
+ *   "toppleLodWindow". They wait in the frozen state for the wave.
+ * - Dominoes that fell and came to rest further away than one window
+ *   stay static in their resting pose.
+ * - Dominoes that are still falling when the wave has moved one window
+ *   ahead follow a fall curve around their front edge. The curve is
+ *   integrated once per domino type and ends where the domino leans on
+ *   the next one of the wave, or lies on the ground. The impact sound
+ *   of the domino is played when it arrives.
+ *
+ * The moving bodies are the awake dynamic bodies of the world, so the
+ * window follows the wave front and also balls or other objects that
+ * run into a chain. Nothing is demoted before the first domino was hit.
+ */
+class ToppleLod {
+protected:
+	struct LodInfo {
+		LodState state;
+
+		/** The mass and inertia of the dynamic body */
+		float mass;
+		Vec3f inertia;
+
+		/** The domino of the wave that was hit by this one, or -1 */
+		int next;
+		bool linked;
+
+		// the fall around the front edge
+		Vec3f size;
+		Vec3f pivot;
+		Vec3f up;
+		Vec3f front;
+		float sign;
+		unsigned sample;
+		float restAngle;
+	};
+
+	bool m_started;
+	bool m_active;
+	bool m_enabled;
+	float m_window;
+
+	/** The dominoes in the order of the topple tracker, NULL if they are static */
+	std::vector<__Domino*> m_dominoes;
+	std::vector<LodInfo> m_infos;
+	boost::unordered_map<const __Object*, unsigned> m_indices;
+	boost::unordered_map<const NewtonBody*, unsigned> m_bodies;
+
+	/** The tilt angles of the fall curves per step, indexed by domino type */
+	std::vector<float> m_curves[3];
+
+	/** The positions of the moving bodies in a grid with the window as cell size */
+	boost::unordered_map<std::pair<int, int>, std::vector<Vec3f> > m_grid;
+
+	unsigned m_peakDynamic;
+
+	/** Integrates the fall curves for the step of the physics */
+	void initCurves(float timestep);
+
+	/**
+	 * Collects the positions of the awake dynamic bodies, except for
+	 * the dominoes that already hit the next one of the wave.
+	 */
+	void findMovingBodies(const std::vector<ToppleInfo>& infos);
+
+	/** @return The distance to the nearest moving body, at most two windows */
+	float getDistance(const Vec3f& position) const;
+
+	/** Turns the domino into a static body */
+	void demote(unsigned index, LodState state);
+
+	/** Turns the domino into a frozen dynamic body */
+	void promote(unsigned index);
+
+	/** Starts the fall curve from the current tilt of the domino */
+	void startFall(unsigned index, const ToppleInfo& info, const std::vector<ToppleInfo>& infos);
+
+	/** Moves the domino along its fall curve, plays the sound when it rests */
+	void stepFall(unsigned index);
+public:
+	ToppleLod();
+
+	/** Promotes all dominoes, the next step() collects them again */
+	void reset();
+
+	/** @return True, if the option "toppleLod" was set when the dominoes were collected */
+	bool isEnabled() const;
+
+	/**
+	 * Updates the representation of the dominoes after a step of the
+	 * physics and the topple tracker.
+	 *
+	 * @param topple   The topple tracker, which knows the hit and resting dominoes
+	 * @param timestep The time of the step in Newton time
+	 */
+	void step(const ToppleTracker& topple, float timestep);
+
+	/**
+	 * Promotes the static dominoes within a window of the ray, so that
+	 * they can be picked with the mouse.
+	 *
+	 * @param p0 The start of the ray
+	 * @param p1 The end of the ray
+	 */
+	void promote(const Vec3f& p0, const Vec3f& p1);
+
+	/** @return The representation of the domino, LOD_DYNAMIC if it is not managed */
+	LodState getState(const __Object* object) const;
+
+	/** @return True, if the body is a domino managed by the level of detail */
+	bool contains(const NewtonBody* body) const;
+
+	ToppleLodSummary getSummary() const;
+};
+
+
+// inline methods
+
+inline bool ToppleLod::isEnabled() const
+{
+	return m_enabled;
+}
+
+inline bool ToppleLod::contains(const NewtonBody* body) const
+{
+	return m_bodies.find(body) != m_bodies.end();
+}
+
+}
+
+#endif /* TOPPLELOD_HPP_ */
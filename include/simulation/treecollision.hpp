@@ -46,6 +46,9 @@ NewtonMesh* m_mesh;
 	Lib3dsVector* m_normals;
 	Lib3dsTexel* m_uvs;
 	GLuint m_list;
+
+	/** The bytes reported to the MemoryStats */
+	size_t m_memory;
 public:
 	__TreeCollision(const Mat4f& matrix, const std::string& fileName);
 	~__TreeCollision();
@@ -55,7 +58,9 @@ public:
 
 	virtual void getAABB(Vec3f& min, Vec3f& max) { NewtonBodyGetAABB(m_body, &min[0], &max[0]); }
 
-	virtual float convexCastPlacement(bool apply = true, std::list<NewtonBody*>* noCollision = NULL) { return 0.0f; };
+	virtual float convexCastPlacement(bool apply = true, const newton::BodySet* noCollision = NULL) { return 0.0f; };
+
+	virtual void getBodies(std::vector<NewtonBody*>& bodies) { bodies.push_back(m_body); }
 
 	virtual bool contains(const NewtonBody* const body);
 	virtual bool contains(const __Object* object);
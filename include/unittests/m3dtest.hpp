@@ -18,6 +18,7 @@ namespace test {
  *
  * save/load
  * quaternion
+ * matrix to quaternion
  * eulerAngles
  * orthonormalInverse
  * inverse
@@ -27,6 +28,7 @@ class m3dTest : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST_SUITE(m3dTest);
 	CPPUNIT_TEST(saveLoadTest);
 	CPPUNIT_TEST(quaternionTest);
+	CPPUNIT_TEST(matrixQuaternionTest);
 	CPPUNIT_TEST(eulerAnglesTest);
 	CPPUNIT_TEST(orthonormalInverseTest);
 	CPPUNIT_TEST(invertTest);
@@ -65,6 +67,16 @@ protected:
 	 */
 	void quaternionTest();
 
+	/**
+	 * Tests the conversion of a rotation matrix to a quaternion.
+	 *
+	 * Creates an arbitrary rotation matrix and converts it to a
+	 * quaternion. The quaternion should have unit length and a
+	 * non-negative real part, and converting it back to a matrix
+	 * should result in the initial matrix.
+	 */
+	void matrixQuaternionTest();
+
 	/**
 	 * Tests the m3d orthonormal inverse and inverse method.
 	 *
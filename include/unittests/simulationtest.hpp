@@ -0,0 +1,170 @@
+/**
+ * @date Oct 19, 2026
+ * @file unittests/simulationtest.hpp
+ */
+
+#ifndef SIMULATIONTEST_HPP_
+#define SIMULATIONTEST_HPP_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <util/inputadapters.hpp>
+#include <boost/cstdint.hpp>
+#include <map>
+#include <string>
+
+namespace test {
+
+/**
+ * This class tests the simulation without an OpenGL context. The
+ * following tests are being performed:
+ *
+ * determinism, topple, height cache, layouts
+ */
+class simulationTest : public CPPUNIT_NS::TestFixture {
+	CPPUNIT_TEST_SUITE(simulationTest);
+	CPPUNIT_TEST(determinismTest);
+	CPPUNIT_TEST(toppleTest);
+	CPPUNIT_TEST(heightCacheTest);
+	CPPUNIT_TEST(layoutTest);
+	CPPUNIT_TEST(chainTest);
+	CPPUNIT_TEST(splineTest);
+	CPPUNIT_TEST(pathTest);
+	CPPUNIT_TEST(toppleLodTest);
+	CPPUNIT_TEST(settleTest);
+	CPPUNIT_TEST(physicsLodTest);
+	CPPUNIT_TEST(settlePhysicsLodTest);
+	CPPUNIT_TEST(templateTest);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	/**
+	 * Saves the options, loads the materials and creates a headless
+	 * simulation in deterministic mode.
+	 */
+	void setUp();
+
+	/** Destroys the simulation and restores the saved options */
+	void tearDown();
+
+protected:
+	util::KeyAdapter m_keyAdapter;
+	util::MouseAdapter m_mouseAdapter;
+
+	/** The options before the test */
+	std::map<std::string, std::string> m_config;
+
+	/**
+	 * Loads the level and simulates the given number of steps.
+	 *
+	 * @return The hash of all body matrices after the last step
+	 */
+	boost::uint64_t run(const std::string& level, int steps);
+
+	/**
+	 * Tests the deterministic mode.
+	 *
+	 * Each level is loaded and simulated twice for the same number
+	 * of steps. The hashes of the body matrices of both runs should
+	 * be equal.
+	 */
+	void determinismTest();
+
+	/**
+	 * Tests the sim::ToppleTracker.
+	 *
+	 * A single row of dominoes is generated and simulated until the
+	 * wave has passed. All dominoes should have been hit in the order
+	 * of the row, without a stall and with a positive wave speed.
+	 */
+	void toppleTest();
+
+	/**
+	 * Tests the newton::HeightCache.
+	 *
+	 * A stack of dynamic boxes and a static box are placed on the ground.
+	 * The cached heights should match exact rays against the static
+	 * bodies, ignore the stack, and follow a static box that is added
+	 * after the heights have been cached.
+	 */
+	void heightCacheTest();
+
+	/**
+	 * Tests the sim::LayoutGenerator.
+	 *
+	 * Each generator should emit the same dominoes twice for the same
+	 * seed, not more than the count, and no two dominoes closer than
+	 * their width.
+	 */
+	void layoutTest();
+
+	/**
+	 * Tests the sim::ChainChecker.
+	 *
+	 * A straight row at the nominal gap should be one chain without weak
+	 * links. Too wide gaps and offsets should fail, and the gap should be
+	 * shortened on tight turns.
+	 */
+	void chainTest();
+
+	/**
+	 * Tests the incremental update of the sim::CRSpline.
+	 *
+	 * Appending and moving knots should give the same table as building
+	 * the spline at once, and a sweep the same positions as single queries.
+	 */
+	void splineTest();
+
+	/**
+	 * Tests the sim::__DominoPath.
+	 *
+	 * Moving the last knot should keep the dominoes at the start of the
+	 * path, and a saved path should be loaded with the same dominoes.
+	 */
+	void pathTest();
+
+	/**
+	 * Tests the sim::ToppleLod.
+	 *
+	 * A long row should topple completely with the level of detail,
+	 * while only the dominoes near the wave front are dynamic.
+	 */
+	void toppleLodTest();
+
+	/**
+	 * Tests the sim::SettleManager.
+	 *
+	 * Resting stacks of boxes should become static, be restored on
+	 * demand and settle again.
+	 */
+	void settleTest();
+
+	/**
+	 * Tests the sim::PhysicsLod.
+	 *
+	 * The level of detail should be off in the deterministic mode.
+	 * A falling box far from the camera should be frozen until the
+	 * camera comes closer, a box near the camera should fall.
+	 */
+	void physicsLodTest();
+
+	/**
+	 * Tests the sim::SettleManager together with the sim::PhysicsLod.
+	 *
+	 * A box frozen in mid-air by the level of detail must not be
+	 * settled, it should fall when the camera comes closer.
+	 */
+	void settlePhysicsLodTest();
+
+	/**
+	 * Tests the sim::TemplateMgr.
+	 *
+	 * An object cloned from the prototype of a template should equal
+	 * the object loaded from the XML node, moved to its matrix.
+	 */
+	void templateTest();
+};
+
+}
+
+#endif /* SIMULATIONTEST_HPP_ */
@@ -33,6 +33,14 @@ public:
 	Clock();
 	virtual ~Clock();
 
+	/**
+	 * Returns the value of a monotonic high-resolution clock in seconds.
+	 * The value is only meaningful relative to other calls to now().
+	 *
+	 * @return The current time in seconds
+	 */
+	static double now();
+
 	/**
 	 * Sets the point of reference of the clock to the current time. All
 	 * calls to get() will return the time elapsed since a call to this
@@ -0,0 +1,48 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/hash.hpp
+ */
+
+#ifndef HASH_HPP_
+#define HASH_HPP_
+
+#include <string>
+#include <pstdint.h>
+
+namespace util {
+
+/**
+ * The offset basis of the 64 bit FNV-1a hash.
+ */
+static const uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+
+/**
+ * Computes the 64 bit FNV-1a hash of the given data. The hash is
+ * stable across runs and platforms, so it can be used as a key for
+ * files on disk. Pass the result of a previous call as the seed to
+ * hash multiple blocks of data.
+ *
+ * @param data   The data to hash
+ * @param length The size of the data in bytes
+ * @param seed   The initial hash value
+ * @return       The hash of the data
+ */
+uint64_t hash(const void* data, size_t length, uint64_t seed = HASH_SEED);
+
+/**
+ * @see hash(const void*, size_t, uint64_t)
+ */
+uint64_t hash(const std::string& data, uint64_t seed = HASH_SEED);
+
+/**
+ * Returns the hexadecimal representation of the hash, padded to
+ * 16 characters. It is suitable as a file name.
+ *
+ * @param value The hash value
+ * @return      The hexadecimal string
+ */
+std::string hashToString(uint64_t value);
+
+}
+
+#endif /* HASH_HPP_ */
@@ -0,0 +1,108 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/memory.hpp
+ */
+
+#ifndef MEMORY_HPP_
+#define MEMORY_HPP_
+
+#include <boost/thread/mutex.hpp>
+#include <iostream>
+#include <string>
+
+namespace util {
+
+/**
+ * Keeps track of the memory used by the subsystems. The subsystems
+ * report changes of their allocations, the accounting keeps the
+ * current size and the high-water mark. Each subsystem can have a
+ * soft budget, a warning is logged when it is exceeded.
+ */
+class MemoryStats {
+public:
+	typedef enum {
+		NEWTON = 0,		/**< Allocations of Newton: bodies, collisions, contacts */
+		VERTEX_DATA,	/**< CPU copies of vertices and indices in the vertex buffers */
+		GPU_BUFFERS,	/**< Vertex and index buffer objects */
+		TEXTURES,		/**< Resident textures */
+		ENVIRONMENT,	/**< Node tree and mesh of the tree collisions */
+		SOUND,			/**< Decoded sound samples */
+		OBJECTS,		/**< Simulation objects and their sub-buffers */
+		SUBSYSTEM_COUNT
+	} Subsystem;
+
+	struct Usage {
+		size_t current;
+		size_t peak;
+		size_t budget;
+
+		/** True, if a warning has been logged since the last time the usage was within the budget */
+		bool warned;
+	};
+
+private:
+	// singleton
+	static MemoryStats* s_instance;
+	MemoryStats();
+	MemoryStats(const MemoryStats& other);
+	virtual ~MemoryStats();
+
+protected:
+	static const char* s_names[SUBSYSTEM_COUNT];
+
+	Usage m_usage[SUBSYSTEM_COUNT];
+
+	/** Newton allocates from its worker threads */
+	boost::mutex m_mutex;
+
+	/** Updates the peak and checks the budget, m_mutex has to be locked */
+	void update(Subsystem subsystem);
+public:
+	static MemoryStats& instance();
+	static void destroy();
+
+	/** @return The name of the subsystem, as used for the budget options */
+	static const char* getName(Subsystem subsystem);
+
+	/**
+	 * Adds the given number of bytes to the subsystem. Thread-safe.
+	 *
+	 * @param subsystem The subsystem
+	 * @param bytes     The allocated bytes, negative if freed
+	 */
+	void add(Subsystem subsystem, long bytes);
+
+	/**
+	 * Sets the size of the subsystem, for subsystems that track their
+	 * size on their own. Thread-safe.
+	 */
+	void set(Subsystem subsystem, size_t bytes);
+
+	/** @return The current usage and high-water mark of the subsystem */
+	Usage get(Subsystem subsystem);
+
+	/** @return The sum of the current usage of all subsystems */
+	size_t getTotal();
+
+	/** @return The sum of the high-water marks of all subsystems */
+	size_t getTotalPeak();
+
+	/**
+	 * Sets a soft budget for the subsystem. The budgets are initialized
+	 * with the options "memoryBudget" + name in megabytes, 0 disables it.
+	 *
+	 * @param subsystem The subsystem
+	 * @param bytes     The budget in bytes
+	 */
+	void setBudget(Subsystem subsystem, size_t bytes);
+
+	/**
+	 * Writes the current usage, high-water mark and budget of all
+	 * subsystems in megabytes.
+	 */
+	void report(std::ostream& out);
+};
+
+}
+
+#endif /* MEMORY_HPP_ */
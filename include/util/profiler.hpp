@@ -0,0 +1,227 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/profiler.hpp
+ */
+
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/tr1/memory.hpp>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+/** The number of frames used for the rolling phase statistics */
+#define PROFILER_WINDOW 128
+
+namespace util {
+
+/**
+ * A lightweight profiler for the phases of a frame. Code is measured
+ * by placing a ProfileZone on the stack. Each thread writes its zones
+ * into its own ring buffer, so the buffers can be exported as a trace
+ * afterwards. The profiler does nothing unless it is enabled.
+ */
+class Profiler {
+public:
+	/**
+	 * A closed zone in the ring buffer of a thread.
+	 */
+	struct Event {
+		/** The name of the zone, has to be a string literal */
+		const char* name;
+
+		/** Begin and end of the zone, see Clock::now() */
+		double begin, end;
+
+		/** The nesting depth of the zone */
+		unsigned depth;
+	};
+
+	/**
+	 * The statistics of a phase over the last PROFILER_WINDOW frames,
+	 * all values in milliseconds.
+	 */
+	struct Stats {
+		std::string name;
+		float min, avg, p99, last;
+		unsigned samples;
+	};
+
+private:
+	// singleton
+	static Profiler* s_instance;
+	Profiler();
+	Profiler(const Profiler& other);
+	virtual ~Profiler();
+
+	static bool s_enabled;
+
+protected:
+	/**
+	 * The ring buffer of a single thread. The mutex is only contended
+	 * while the buffers are collected at the end of a frame. The events
+	 * are allocated by the first zone, so threads that run while the
+	 * profiler is disabled only cost the name.
+	 */
+	struct ThreadBuffer {
+		unsigned id;
+		std::string name;
+		std::vector<Event> events;
+
+		/** The number of events written so far */
+		unsigned long written;
+
+		/** The current nesting depth */
+		unsigned depth;
+
+		/** The time spent in each zone since the last frame */
+		std::map<const char*, double> totals;
+
+		boost::mutex mutex;
+	};
+
+	/**
+	 * The recent per-frame times of a phase.
+	 */
+	struct Phase {
+		std::vector<float> samples;
+		unsigned next;
+		float last;
+	};
+
+	/**
+	 * The buffer of the calling thread, shared with m_buffers. The
+	 * thread releases its reference when it exits, so a buffer only
+	 * referenced by m_buffers belongs to an exited thread.
+	 */
+	boost::thread_specific_ptr<std::tr1::shared_ptr<ThreadBuffer> > m_current;
+
+	std::list<std::tr1::shared_ptr<ThreadBuffer> > m_buffers;
+	std::map<std::string, Phase> m_phases;
+
+	/** Samples added directly by addSample() for the current frame */
+	std::map<std::string, float> m_frame;
+
+	boost::mutex m_mutex;
+
+	/** The time of the creation, the origin of the trace */
+	double m_start;
+
+	/** The capacity of the ring buffers */
+	unsigned m_capacity;
+
+	/** The id of the next thread in the trace */
+	unsigned m_nextId;
+
+	/**
+	 * Returns the buffer of the calling thread. If there is none, the
+	 * buffer of an exited thread is recycled or a new one is created.
+	 */
+	ThreadBuffer* current();
+
+	friend class ProfileZone;
+public:
+	/**
+	 * Returns an instance of the Profiler and creates it,
+	 * if there is none. The instance has to be created on the
+	 * main thread, before any worker thread uses it.
+	 *
+	 * @return The Profiler
+	 */
+	static Profiler& instance();
+
+	/**
+	 * Destroys the instance of the Profiler
+	 */
+	static void destroy();
+
+	/** @return True, if zones are recorded, false otherwise */
+	static bool isEnabled();
+
+	/** @param enabled True, if zones should be recorded */
+	static void setEnabled(bool enabled);
+
+	/**
+	 * Sets the name of the calling thread in the trace.
+	 *
+	 * @param name The name of the thread
+	 */
+	void setThreadName(const std::string& name);
+
+	/**
+	 * Adds the time of a phase that has not been measured by a zone,
+	 * e.g. a GPU timing. Multiple samples of one frame are summed.
+	 *
+	 * @param phase The name of the phase
+	 * @param ms    The time in milliseconds
+	 */
+	void addSample(const std::string& phase, float ms);
+
+	/**
+	 * Ends the current frame. The zone times of all threads since
+	 * the last call are added to the phase statistics.
+	 */
+	void frame();
+
+	/**
+	 * Stores the statistics of all phases, sorted by name.
+	 *
+	 * @param stats The vector in which the statistics are stored
+	 */
+	void getStats(std::vector<Stats>& stats);
+
+	/**
+	 * Writes the contents of all ring buffers as a Chrome trace
+	 * (chrome://tracing) to the given file.
+	 *
+	 * @param fileName The file to write
+	 * @return         True, if successful, false otherwise
+	 */
+	bool writeTrace(const std::string& fileName);
+};
+
+/**
+ * Measures the time between its construction and its destruction.
+ * Usage:
+ *
+ * {
+ *     util::ProfileZone zone("physics");
+ *     NewtonUpdate(...);
+ * }
+ */
+class ProfileZone {
+protected:
+	Profiler::ThreadBuffer* m_buffer;
+	const char* m_name;
+	double m_begin;
+	unsigned m_depth;
+public:
+	/**
+	 * Opens a zone, if the profiler is enabled.
+	 *
+	 * @param name The name of the zone, has to be a string literal
+	 */
+	ProfileZone(const char* name);
+	~ProfileZone();
+};
+
+
+// inline methods
+
+inline bool Profiler::isEnabled()
+{
+	return s_enabled;
+}
+
+inline void Profiler::setEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+}
+
+#endif /* PROFILER_HPP_ */
@@ -0,0 +1,138 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/taskgraph.hpp
+ */
+
+#ifndef TASKGRAPH_HPP_
+#define TASKGRAPH_HPP_
+
+#include <util/threadpool.hpp>
+#include <util/clock.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+
+namespace util {
+
+/**
+ * A graph of named stages with dependencies between them. Stages
+ * whose dependencies are finished run concurrently on a ThreadPool.
+ * Stages that have to run on a specific thread, e.g. because they
+ * use the OpenGL context or create widgets, are marked as main thread
+ * stages and will be executed by the thread that calls run().
+ *
+ * The start and end time of each stage are recorded and can be
+ * printed with print().
+ */
+class TaskGraph {
+public:
+	typedef ThreadPool::Task Task;
+
+	/**
+	 * Called on the thread that called run() each time a stage has
+	 * been finished, with the name of the stage, the number of
+	 * finished stages and the total number of stages.
+	 */
+	typedef boost::function<void (const std::string&, int, int)> ProgressCallback;
+
+	/**
+	 * @param name The name of the graph, used as a prefix for the log
+	 */
+	TaskGraph(const std::string& name);
+	virtual ~TaskGraph();
+
+	/**
+	 * Adds a new stage to the graph.
+	 *
+	 * @param name       The name of the stage
+	 * @param task       The function to execute
+	 * @param mainThread True, if the stage has to run on the thread
+	 *                   that calls run()
+	 * @return           The id of the stage
+	 */
+	int add(const std::string& name, const Task& task, bool mainThread = false);
+
+	/**
+	 * The stage will not start before the dependency has been finished.
+	 * The stages must not form a cycle.
+	 *
+	 * @param stage      The id of the dependent stage
+	 * @param dependency The id of the stage it depends on
+	 */
+	void depends(int stage, int dependency);
+
+	/**
+	 * Executes all stages and blocks until all stages have been finished.
+	 *
+	 * @param pool     The pool that executes the worker stages
+	 * @param progress An optional progress callback
+	 */
+	void run(ThreadPool& pool, ProgressCallback progress = ProgressCallback());
+
+	/**
+	 * Prints the start time and the duration of each stage and the
+	 * total time of the last run.
+	 *
+	 * @param stream The output stream
+	 */
+	void print(std::ostream& stream = std::cout) const;
+
+	/** @return The wall time of the last run in seconds */
+	float getTime() const;
+
+protected:
+	struct Stage {
+		std::string name;
+		Task task;
+		bool mainThread;
+		std::vector<int> dependents;
+		int dependencies;
+		int waiting;
+		float start;
+		float end;
+	};
+
+	/**
+	 * Executes the given stage and releases its dependents.
+	 *
+	 * @param stage The id of the stage
+	 */
+	void execute(int stage);
+
+	/**
+	 * Hands the stage to the pool or the main thread. Requires
+	 * the lock of the graph.
+	 *
+	 * @param stage The id of the stage
+	 */
+	void ready(int stage);
+
+	std::string m_name;
+	std::vector<Stage> m_stages;
+	ThreadPool* m_pool;
+
+	/** The stages that are ready and have to run on the main thread */
+	std::queue<int> m_mainQueue;
+
+	/** The ids of the finished stages in order of completion */
+	std::vector<int> m_order;
+	int m_finished;
+	float m_time;
+
+	Clock m_clock;
+	boost::mutex m_mutex;
+	boost::condition_variable m_changed;
+};
+
+inline float TaskGraph::getTime() const
+{
+	return m_time;
+}
+
+}
+
+#endif /* TASKGRAPH_HPP_ */
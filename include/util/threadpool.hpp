@@ -0,0 +1,84 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/threadpool.hpp
+ */
+
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <util/threadcounter.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <queue>
+
+namespace util {
+
+/**
+ * A fixed-size pool of worker threads that executes scheduled tasks
+ * in FIFO order. Tasks must not touch the OpenGL context, since it is
+ * only current on the thread that created it.
+ */
+class ThreadPool {
+public:
+	typedef boost::function<void ()> Task;
+
+	/**
+	 * Starts the worker threads.
+	 *
+	 * @param threads The number of workers, defaults to getThreadCount()
+	 */
+	ThreadPool(int threads = getThreadCount());
+
+	/**
+	 * Waits for all pending tasks and joins the workers.
+	 */
+	virtual ~ThreadPool();
+
+	/**
+	 * Enqueues the given task. It will be executed by the next
+	 * idle worker.
+	 *
+	 * @param task The task to execute
+	 */
+	void schedule(const Task& task);
+
+	/**
+	 * Blocks until all scheduled tasks have been executed.
+	 */
+	void wait();
+
+	/** @return The number of worker threads */
+	int size() const;
+
+protected:
+	/**
+	 * The main loop of a worker thread.
+	 */
+	void run();
+
+	std::queue<Task> m_tasks;
+	boost::thread_group m_threads;
+	boost::mutex m_mutex;
+
+	/** Signaled if a new task has been scheduled or the pool stops */
+	boost::condition_variable m_taskAvailable;
+
+	/** Signaled if the last pending task has been finished */
+	boost::condition_variable m_tasksDone;
+
+	/** The number of tasks that are queued or being executed */
+	unsigned m_pending;
+	bool m_stop;
+	int m_size;
+};
+
+inline int ThreadPool::size() const
+{
+	return m_size;
+}
+
+}
+
+#endif /* THREADPOOL_HPP_ */
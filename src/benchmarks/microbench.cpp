@@ -0,0 +1,426 @@
+/**
+ * @date Oct 19, 2026
+ * @file benchmarks/microbench.cpp
+ */
+
+#include <benchmarks/microbench.hpp>
+#include <m3d/m3d.hpp>
+#include <simulation/crspline.hpp>
+#include <simulation/material.hpp>
+#include <simulation/object.hpp>
+#include <simulation/domino.hpp>
+#include <simulation/compound.hpp>
+#include <newton/util.hpp>
+#include <util/clock.hpp>
+#include <xml/rapidxml.hpp>
+#include <xml/rapidxml_print.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+namespace bench {
+
+using namespace m3d;
+using namespace sim;
+
+unsigned long allocations = 0;
+
+/** Results are written to the sink, so they are not optimized away */
+static volatile float s_sink = 0.0f;
+
+/**
+ * Filters, runs and reports the benchmarks.
+ */
+class Runner {
+protected:
+	std::string m_filter;
+	unsigned long m_scale;
+	std::ostream& m_file;
+public:
+	Runner(const std::string& filter, unsigned long scale, std::ostream& file)
+		: m_filter(filter), m_scale(scale), m_file(file) {}
+
+	template<typename Op>
+	void run(const std::string& name, unsigned long iterations, Op& op)
+	{
+		if (m_filter.size() && name.find(m_filter) == std::string::npos)
+			return;
+		iterations *= m_scale;
+
+		// warm up the caches
+		for (unsigned long i = 0; i < iterations / 10 + 1; ++i)
+			op();
+
+		const unsigned long allocs = allocations;
+		const double begin = util::Clock::now();
+		for (unsigned long i = 0; i < iterations; ++i)
+			op();
+		const double end = util::Clock::now();
+
+		Measurement m;
+		m.name = name;
+		m.iterations = iterations;
+		m.ns = (end - begin) * 1000000000.0 / iterations;
+		m.allocations = (double)(allocations - allocs) / iterations;
+
+		writeCSV(std::cout, m);
+		if (m_file)
+			writeCSV(m_file, m);
+	}
+};
+
+
+// m3d
+
+struct Mat4Multiply {
+	Mat4f a, b;
+	Mat4Multiply() : a(Mat4f::translate(1.0f, 2.0f, 3.0f)), b(Mat4f::rotY(0.1f) * Mat4f::rotX(0.2f)) {}
+	void operator()() { a = a * b; s_sink = a._11; }
+};
+
+struct Mat4Inverse {
+	Mat4f m;
+	Mat4Inverse() : m(Mat4f::rotY(0.3f) * Mat4f::translate(1.0f, 2.0f, 3.0f)) {}
+	void operator()() { s_sink = m.inverse()._11; }
+};
+
+struct Mat4Str {
+	Mat4f m;
+	Mat4Str() : m(Mat4f::rotY(0.3f) * Mat4f::translate(1.0f, 2.0f, 3.0f)) {}
+	void operator()() { s_sink = m.str().size(); }
+};
+
+struct Mat4Assign {
+	std::string str;
+	Mat4f m;
+	Mat4Assign() { str = (Mat4f::rotY(0.3f) * Mat4f::translate(1.0f, 2.0f, 3.0f)).str(); }
+	void operator()() { m.assign(str); s_sink = m._11; }
+};
+
+struct QuatMultiply {
+	Quatf a, b;
+	QuatMultiply() : a(Vec3f::yAxis(), 0.1f), b(Vec3f::xAxis(), 0.2f) {}
+	void operator()() { a = a * b; s_sink = a.a; }
+};
+
+struct QuatRotate {
+	Quatf q;
+	Vec3f v;
+	QuatRotate() : q(Vec3f::yAxis(), 0.1f), v(1.0f, 2.0f, 3.0f) {}
+	void operator()() { v = q.rotate(v); s_sink = v.x; }
+};
+
+struct QuatMat4 {
+	Quatf q;
+	QuatMat4() : q(Vec3f::yAxis(), 0.1f) {}
+	void operator()() { s_sink = q.mat4()._11; }
+};
+
+
+// CRSpline
+
+static void makeKnots(CRSpline& spline, unsigned count)
+{
+	for (unsigned i = 0; i < count; ++i)
+		spline.knots().push_back(Vec2f(i * 10.0f, (i % 2) * 15.0f));
+}
+
+struct SplineUpdate {
+	CRSpline spline;
+	SplineUpdate() { makeKnots(spline, 20); }
+	void operator()() { s_sink = spline.update(); }
+};
+
+struct SplineGetPoint {
+	CRSpline spline;
+	float length, t;
+	SplineGetPoint() : t(0.0f) { makeKnots(spline, 20); length = spline.update(); }
+	void operator()()
+	{
+		t += 2.5f;
+		if (t >= length) t = 0.0f;
+		s_sink = spline.getPoint(t).first.x;
+	}
+};
+
+struct SplineAppend {
+	CRSpline spline;
+	unsigned i;
+	SplineAppend() : i(0) { makeKnots(spline, 1000); spline.update(); }
+	void operator()()
+	{
+		// move the last knot, as when dragging a curve
+		spline.knots().back().y = (float)(i++ % 30);
+		s_sink = spline.update();
+	}
+};
+
+struct SplineSweep {
+	CRSpline spline;
+	float length, t;
+	CRSpline::Sweep sweep;
+	SplineSweep() : t(0.0f), sweep(spline) { makeKnots(spline, 20); length = spline.update(); }
+	void operator()()
+	{
+		t += 2.5f;
+		if (t >= length) t = 0.0f;
+		s_sink = sweep.getPlanarPos(t).x;
+	}
+};
+
+
+// materials
+
+struct MaterialGetID {
+	std::vector<std::string> names;
+	unsigned i;
+	MaterialGetID() : i(0)
+	{
+		std::set<std::string> materials;
+		MaterialMgr::instance().getMaterials(materials);
+		names.assign(materials.begin(), materials.end());
+	}
+	void operator()() { s_sink = MaterialMgr::instance().getID(names[i++ % names.size()]); }
+};
+
+/** Stores the ids of the loaded materials, see MaterialMgr::getID() */
+static void getMaterialIDs(std::vector<int>& ids)
+{
+	std::set<std::string> materials;
+	MaterialMgr::instance().getMaterials(materials);
+	ids.clear();
+	for (std::set<std::string>::const_iterator itr = materials.begin(); itr != materials.end(); ++itr)
+		ids.push_back(MaterialMgr::instance().getID(*itr));
+}
+
+struct MaterialFromID {
+	std::vector<int> ids;
+	unsigned i;
+	MaterialFromID() : i(0) { getMaterialIDs(ids); }
+	void operator()() { s_sink = MaterialMgr::instance().fromID(ids[i++ % ids.size()]) != NULL; }
+};
+
+struct MaterialGetPair {
+	std::vector<int> ids;
+	unsigned i;
+	MaterialGetPair() : i(0) { getMaterialIDs(ids); }
+	void operator()()
+	{
+		i++;
+		s_sink = MaterialMgr::instance().getPair(ids[i % ids.size()], ids[(i / ids.size()) % ids.size()]).elasticity;
+	}
+};
+
+
+// XML round trips
+
+struct ObjectSave {
+	Object object;
+	rapidxml::xml_document<> doc;
+	ObjectSave(const Object& object) : object(object) {}
+	void operator()()
+	{
+		doc.clear();
+		rapidxml::xml_node<>* level = doc.allocate_node(rapidxml::node_element, "level");
+		doc.append_node(level);
+		__Object::save(*object, level, &doc);
+		s_sink = level->first_node() != NULL;
+	}
+};
+
+struct ObjectLoad {
+	std::vector<char> text;
+	rapidxml::xml_document<> doc;
+	rapidxml::xml_node<>* node;
+	ObjectLoad(const Object& object)
+	{
+		// serialize the object once and parse it in-situ
+		rapidxml::xml_document<> out;
+		rapidxml::xml_node<>* level = out.allocate_node(rapidxml::node_element, "level");
+		out.append_node(level);
+		__Object::save(*object, level, &out);
+		rapidxml::print(std::back_inserter(text), out, rapidxml::print_no_indenting);
+		text.push_back(0);
+		doc.parse<0>(&text[0]);
+		node = doc.first_node()->first_node();
+	}
+	void operator()()
+	{
+		Object object = __Object::load(node);
+		s_sink = object->getType();
+	}
+};
+
+static Compound createHingedCompound()
+{
+	Compound compound = __Compound::createCompound();
+	Object anchor = __RigidBody::createBox(Vec3f(0.0f, 5.0f, 0.0f), 0.5f, 0.5f, 0.5f, 0.0f, "metal");
+	Object link = __RigidBody::createBox(Vec3f(1.0f, 5.0f, 0.0f), 1.8f, 0.3f, 0.3f, 1.0f, "rope");
+	compound->add(anchor);
+	compound->add(link);
+	compound->createHinge(Vec3f(0.0f, 5.0f, 0.0f), Vec3f::zAxis(), link, anchor);
+	return compound;
+}
+
+static void runObjectBenchmarks(Runner& runner)
+{
+	const Mat4f identity = Mat4f::identity();
+
+	std::vector<Object> objects;
+	objects.push_back(__Domino::createDomino(__Object::DOMINO_SMALL, identity, -1.0f, "domino", false));
+	objects.push_back(__Domino::createDomino(__Object::DOMINO_MIDDLE, identity, -1.0f, "domino", false));
+	objects.push_back(__Domino::createDomino(__Object::DOMINO_LARGE, identity, -1.0f, "domino", false));
+	objects.push_back(__RigidBody::createBox(identity, 1.0f, 1.0f, 1.0f, 1.0f, "crate"));
+	objects.push_back(__RigidBody::createSphere(identity, 1.0f, 1.0f, 1.0f, 1.0f, "rubber"));
+	objects.push_back(__RigidBody::createCylinder(identity, 0.5f, 1.0f, 1.0f, "metal"));
+	objects.push_back(__RigidBody::createCapsule(identity, 0.5f, 2.0f, 1.0f, "metal"));
+	objects.push_back(__RigidBody::createCone(identity, 0.5f, 1.0f, 1.0f, "metal"));
+	objects.push_back(__RigidBody::createChamferCylinder(identity, 0.5f, 1.0f, 1.0f, "metal"));
+	objects.push_back(__Convex::createHull(identity, 2.0f, "tire", "data/models/tenpin.3ds"));
+	objects.push_back(__Convex::createAssembly(identity, 2.0f, "barrel", "data/models/barrel.3ds"));
+	objects.push_back(createHingedCompound());
+
+	for (std::vector<Object>::iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		const std::string type = __Object::TypeStr[(*itr)->getType()];
+		ObjectSave save(*itr);
+		runner.run("save " + type, 10000, save);
+		ObjectLoad load(*itr);
+		runner.run("load " + type, 1000, load);
+	}
+}
+
+
+// placement
+
+struct CompoundPlacement {
+	Compound compound;
+	CompoundPlacement(const Compound& compound) : compound(compound) {}
+	void operator()() { s_sink = compound->convexCastPlacement(); }
+};
+
+struct BatchPlacement {
+	std::vector<Object> objects;
+	BatchPlacement(const std::vector<Object>& objects) : objects(objects) {}
+	void operator()()
+	{
+		__Object::convexCastPlacements(objects);
+		s_sink = objects.front()->getMatrix()._42;
+	}
+};
+
+static void runPlacementBenchmarks(Runner& runner)
+{
+	// a terrain of static boxes with steps
+	std::vector<Object> ground;
+	for (int x = -10; x < 10; ++x)
+		for (int z = -10; z < 10; ++z)
+			ground.push_back(__RigidBody::createBox(Vec3f(x * 2.0f, (abs(x + z) % 3) * 0.1f, z * 2.0f),
+					2.0f, 1.0f, 2.0f, 0.0f, "stone"));
+
+	// 200 boxes as one template group and as single objects
+	{
+		Compound group = __Compound::createCompound();
+		for (unsigned i = 0; i < 200; ++i)
+			group->add(__RigidBody::createBox(Vec3f((i % 20) * 1.5f - 15.0f, 5.0f, (i / 20) * 1.5f - 7.5f),
+					1.0f, 1.0f, 1.0f, 1.0f, "crate"));
+		CompoundPlacement compoundPlacement(group);
+		runner.run("convexCastPlacement compound 200", 100, compoundPlacement);
+	}
+	{
+		std::vector<Object> objects;
+		for (unsigned i = 0; i < 200; ++i)
+			objects.push_back(__RigidBody::createBox(Vec3f((i % 20) * 1.5f - 15.0f, 5.0f, (i / 20) * 1.5f - 7.5f),
+					1.0f, 1.0f, 1.0f, 1.0f, "crate"));
+		BatchPlacement batchPlacement(objects);
+		runner.run("convexCastPlacements 200", 100, batchPlacement);
+	}
+}
+
+void writeCSV(std::ostream& out, const Measurement& m)
+{
+	out << m.name << "," << m.iterations << "," << m.ns << "," << m.allocations << std::endl;
+}
+
+int runMicroBenchmarks(int argc, char** argv)
+{
+	std::string filter;
+	unsigned long scale = 1;
+	std::string output = "microbench.csv";
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg(argv[i]);
+		if (arg == "--filter") filter = argv[i + 1];
+		else if (arg == "--scale") scale = std::max(atoi(argv[i + 1]), 1);
+		else if (arg == "--out") output = argv[i + 1];
+		else {
+			std::cerr << "unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	std::ofstream file(output.c_str());
+	std::cout << "name,iterations,ns_per_op,allocs_per_op" << std::endl;
+	if (file)
+		file << "name,iterations,ns_per_op,allocs_per_op" << std::endl;
+
+	Runner runner(filter, scale, file);
+
+	Mat4Multiply mat4Multiply;
+	runner.run("Mat4f multiply", 1000000, mat4Multiply);
+	Mat4Inverse mat4Inverse;
+	runner.run("Mat4f inverse", 1000000, mat4Inverse);
+	Mat4Str mat4Str;
+	runner.run("Mat4f str", 100000, mat4Str);
+	Mat4Assign mat4Assign;
+	runner.run("Mat4f assign", 100000, mat4Assign);
+	QuatMultiply quatMultiply;
+	runner.run("Quatf multiply", 1000000, quatMultiply);
+	QuatRotate quatRotate;
+	runner.run("Quatf rotate", 1000000, quatRotate);
+	QuatMat4 quatMat4;
+	runner.run("Quatf mat4", 1000000, quatMat4);
+
+	SplineUpdate splineUpdate;
+	runner.run("CRSpline update", 1000, splineUpdate);
+	SplineGetPoint splineGetPoint;
+	runner.run("CRSpline getPoint", 100000, splineGetPoint);
+	SplineAppend splineAppend;
+	runner.run("CRSpline update 1000 knots", 1000, splineAppend);
+	SplineSweep splineSweep;
+	runner.run("CRSpline sweep", 100000, splineSweep);
+
+	MaterialMgr::instance().load("data/materials.xml");
+	std::set<std::string> materials;
+	if (MaterialMgr::instance().getMaterials(materials) > 0) {
+		MaterialGetID materialGetID;
+		runner.run("MaterialMgr getID", 1000000, materialGetID);
+		MaterialFromID materialFromID;
+		runner.run("MaterialMgr fromID", 1000000, materialFromID);
+		MaterialGetPair materialGetPair;
+		runner.run("MaterialMgr getPair", 1000000, materialGetPair);
+	} else {
+		std::cerr << "no materials loaded, skipping the material benchmarks" << std::endl;
+	}
+
+	// the objects need a world, but no OpenGL context
+	newton::world = NewtonCreate();
+	Vec3f minSize(-2000.0f, -2000.0f, -2000.0f);
+	Vec3f maxSize(2000.0f, 2000.0f, 2000.0f);
+	NewtonSetWorldSize(newton::world, &minSize[0], &maxSize[0]);
+
+	runObjectBenchmarks(runner);
+	runPlacementBenchmarks(runner);
+
+	__Domino::freeCollisions();
+	__Convex::freeShapes();
+	NewtonDestroy(newton::world);
+	newton::world = NULL;
+
+	return 0;
+}
+
+}
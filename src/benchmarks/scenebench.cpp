@@ -0,0 +1,198 @@
+/**
+ * @date Oct 19, 2026
+ * @file benchmarks/scenebench.cpp
+ */
+
+#include <benchmarks/scenebench.hpp>
+#include <gui/renderwidget.hpp>
+#include <simulation/simulation.hpp>
+#include <simulation/scenegen.hpp>
+#include <simulation/material.hpp>
+#include <opengl/texture.hpp>
+#include <newton/util.hpp>
+#include <util/clock.hpp>
+#include <util/memory.hpp>
+#include <QtGui/QApplication>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#ifdef _WIN32
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <unistd.h>
+#endif
+
+namespace bench {
+
+/**
+ * Returns the current resident memory of the process in kB. The peak
+ * of the process would include the scenes that ran before.
+ */
+static long getResidentMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize / 1024;
+	return 0;
+#else
+	// the second value of statm is the number of resident pages
+	long size = 0, resident = 0;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (!file)
+		return 0;
+	if (fscanf(file, "%ld %ld", &size, &resident) != 2)
+		resident = 0;
+	fclose(file);
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+}
+
+static SceneResult runScene(gui::RenderWidget& widget, const std::string& scene, unsigned scale,
+		unsigned steps, unsigned frames, const std::string& exportName)
+{
+	using namespace sim;
+	Simulation& simulation = Simulation::instance();
+	// layout files are given with their path
+	const std::string name = scene.substr(scene.find_last_of("/\\") + 1);
+	const std::string fileName = "benchmark_" + name + ".xml";
+
+	SceneResult result;
+	result.scene = scene;
+	result.steps = steps;
+	result.frames = frames;
+
+	widget.makeCurrent();
+
+	// generate the scene through the public API
+	simulation.init();
+	const long resident = getResidentMemory();
+	util::Clock clock;
+	SceneGenerator::ground();
+	result.objects = SceneGenerator::generate(scene, scale);
+	result.addTime = clock.get() * 1000.0f;
+
+	// round trip through the level format
+	simulation.save(fileName);
+	clock.reset();
+	simulation.load(fileName);
+	result.loadTime = clock.get() * 1000.0f;
+	remove(fileName.c_str());
+	result.bodies = NewtonWorldGetBodyCount(newton::world);
+
+	simulation.getCamera().positionCamera(Vec3f(0.0f, 60.0f, 120.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f::yAxis());
+	if (!exportName.empty())
+		simulation.startExport(exportName + "_" + name);
+
+	clock.reset();
+	for (unsigned i = 0; i < steps; ++i)
+		simulation.step();
+	const float stepTotal = clock.get();
+	result.stepTime = steps ? stepTotal * 1000.0f / steps : 0.0f;
+	result.stepsPerSecond = stepTotal > 0.0f ? steps / stepTotal : 0.0f;
+	result.newtonMemory = NewtonGetMemoryUsed() / 1024;
+	result.topple = simulation.getToppleTracker().getSummary();
+	result.lod = simulation.getToppleLod().getSummary();
+	result.settled = simulation.getSettleManager().getSettledCount();
+	result.physics = simulation.getPhysicsLod().getSummary();
+	simulation.stopExport();
+
+	// glFinish, so that the GPU time is included
+	clock.reset();
+	for (unsigned i = 0; i < frames; ++i) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		simulation.render();
+		glFinish();
+	}
+	result.frameTime = frames ? clock.get() * 1000.0f / frames : 0.0f;
+
+	result.residentMemory = getResidentMemory();
+	result.residentGrowth = result.residentMemory - resident;
+	result.accountedMemory = util::MemoryStats::instance().getTotal() / 1024;
+	return result;
+}
+
+void writeCSVHeader(std::ostream& out)
+{
+	out << "scene,objects,bodies,add_ms,load_ms,steps,step_ms,steps_per_s,"
+		<< "frames,frame_ms,resident_memory_kb,resident_growth_kb,newton_memory_kb,accounted_memory_kb,"
+		<< "dominoes_hit,cascade_s,wave_speed,stalls,lod_peak_dynamic,settled,"
+		<< "physics_frozen,physics_reduced_steps" << std::endl;
+}
+
+void writeCSV(std::ostream& out, const SceneResult& result)
+{
+	out << result.scene << "," << result.objects << "," << result.bodies << ","
+		<< result.addTime << "," << result.loadTime << ","
+		<< result.steps << "," << result.stepTime << "," << result.stepsPerSecond << ","
+		<< result.frames << "," << result.frameTime << ","
+		<< result.residentMemory << "," << result.residentGrowth << "," << result.newtonMemory << "," << result.accountedMemory << ","
+		<< result.topple.hit << "," << result.topple.duration << "," << result.topple.waveSpeed << ","
+		<< result.topple.stalls << "," << result.lod.peakDynamic << "," << result.settled << ","
+		<< result.physics.frozen << "," << result.physics.reducedSteps << std::endl;
+}
+
+int runSceneBenchmark(int argc, char** argv)
+{
+	std::vector<std::string> scenes;
+	unsigned scale = 1, steps = 500, frames = 100;
+	std::string output = "benchmark.csv";
+	std::string exportName;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg(argv[i]);
+		if (arg == "--scene") scenes.push_back(argv[i + 1]);
+		else if (arg == "--scale") scale = atoi(argv[i + 1]);
+		else if (arg == "--steps") steps = atoi(argv[i + 1]);
+		else if (arg == "--frames") frames = atoi(argv[i + 1]);
+		else if (arg == "--out") output = argv[i + 1];
+		else if (arg == "--export") exportName = argv[i + 1];
+		else {
+			std::cerr << "unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	if (scenes.empty()) {
+		scenes.push_back("spiral");
+		scenes.push_back("grid");
+		scenes.push_back("stacks");
+		scenes.push_back("tenpins");
+		scenes.push_back("chains");
+	}
+
+	// the render widget creates the context and the simulation
+	QApplication app(argc, argv);
+	sim::MaterialMgr::instance().load("data/materials.xml");
+	ogl::TextureMgr::instance().index("data/textures/");
+
+	gui::RenderWidget widget;
+	widget.resize(1280, 720);
+	widget.show();
+	app.processEvents();
+
+	std::ofstream file(output.c_str());
+	writeCSVHeader(std::cout);
+	if (file)
+		writeCSVHeader(file);
+
+	for (std::vector<std::string>::const_iterator itr = scenes.begin(); itr != scenes.end(); ++itr) {
+		SceneResult result = runScene(widget, *itr, scale, steps, frames, exportName);
+		if (!result.objects) {
+			std::cerr << "unknown scene " << *itr << std::endl;
+			continue;
+		}
+		writeCSV(std::cout, result);
+		if (file)
+			writeCSV(file, result);
+	}
+
+	util::MemoryStats::instance().report(std::cout);
+	sim::Simulation::instance().clear();
+	return 0;
+}
+
+}
@@ -7,12 +7,22 @@
 #include <gui/mainwindow.hpp>
 
 #include <iostream>
+#include <sstream>
 
 #include <gui/dialogs.hpp>
 #include <gui/qutils.hpp>
 #include <newton/util.hpp>
+#include <opengl/texture.hpp>
+#include <simulation/layout.hpp>
+#include <simulation/material.hpp>
+#include <simulation/template.hpp>
 #include <sound/soundmgr.hpp>
+#include <util/clock.hpp>
 #include <util/config.hpp>
+#include <util/memory.hpp>
+#include <util/taskgraph.hpp>
+
+#include <boost/bind.hpp>
 
 #include <QtCore/QList>
 #include <QtCore/QTextCodec>
@@ -34,11 +44,47 @@
 
 namespace gui {
 
+/**
+ * Advances the splash screen each time a startup stage has been finished.
+ */
+struct StartupProgress {
+	SplashScreen* splash;
+	QApplication* app;
+	int from, to;
+
+	void operator()(const std::string& stage, int finished, int count)
+	{
+		splash->updateProgress(from + (to - from) * finished / count,
+				QString::fromStdString("Loaded " + stage));
+		app->processEvents();
+	}
+};
+
+/**
+ * Decodes the textures of all materials, so that initializeGL only has
+ * to upload them.
+ */
+static void decodeMaterialTextures()
+{
+	std::set<std::string> materials, textures;
+	sim::MaterialMgr::instance().getMaterials(materials);
+	for (std::set<std::string>::iterator itr = materials.begin(); itr != materials.end(); ++itr) {
+		const sim::Material* mat = sim::MaterialMgr::instance().get(*itr);
+		if (mat) {
+			textures.insert(mat->texture);
+			textures.insert(mat->texture1);
+		}
+	}
+	ogl::TextureMgr::instance().decode(textures);
+}
+
 MainWindow::MainWindow(QApplication* app)
 {
 	m_modified = true;
 	m_tmp_file = NULL;
 
+	util::Clock startupClock;
+
 	// load the splash screen
 	SplashScreen splash(100);
 	splash.show();
@@ -58,14 +104,45 @@ MainWindow::MainWindow(QApplication* app)
 	app->processEvents();
 
 	m_toolBox = new ToolBox();
-	splash.updateProgress(50, "Loading materials");
-	m_toolBox->loadMaterials("data/materials.xml");
-	splash.updateProgress(60, "Loading sounds");
-	snd::SoundMgr::instance().LoadSound("data/sounds");
-	splash.updateProgress(70, "Loading music");
-	snd::SoundMgr::instance().LoadMusic("data/music");
-	snd::SoundMgr::instance().setMusicEnabled(util::Config::instance().get("enableMusic", false));
+	splash.updateProgress(30, "Loading resources");
 	app->processEvents();
+
+	// independent stages run on the pool, widgets are created on this thread
+	{
+		using namespace boost;
+		snd::SoundMgr& sound = snd::SoundMgr::instance();
+		util::TaskGraph startup("startup");
+
+		int materials = startup.add("materials", bind(&sim::MaterialMgr::load,
+				&sim::MaterialMgr::instance(), std::string("data/materials.xml")));
+		int materialList = startup.add("material list", bind(&ToolBox::showMaterials, m_toolBox), true);
+		startup.depends(materialList, materials);
+
+		// the FMOD system is not thread-safe, the sound stages run one after another
+		int sounds = startup.add("sounds", bind(&snd::SoundMgr::LoadSound, &sound, std::string("data/sounds")));
+		int music = startup.add("music", bind(&snd::SoundMgr::LoadMusic, &sound, std::string("data/music")));
+		int musicEnabled = startup.add("music settings", bind(&snd::SoundMgr::setMusicEnabled, &sound,
+				util::Config::instance().get("enableMusic", false)));
+		startup.depends(music, sounds);
+		startup.depends(musicEnabled, sounds);
+		startup.depends(musicEnabled, music);
+
+		int textures = startup.add("texture index", bind(&ogl::TextureMgr::index,
+				&ogl::TextureMgr::instance(), std::string("data/textures/")));
+		int decode = startup.add("texture decode", &decodeMaterialTextures);
+		startup.depends(decode, textures);
+		startup.depends(decode, materials);
+
+		startup.add("template prototypes", bind(&sim::TemplateMgr::load,
+				&sim::TemplateMgr::instance(), std::string("data/templates/")));
+		startup.add("templates", bind(&ToolBox::loadTemplates, m_toolBox, QString("data/templates/")), true);
+
+		StartupProgress progress = { &splash, app, 30, 80 };
+		util::ThreadPool pool;
+		startup.run(pool, progress);
+		startup.print();
+	}
+	QtErrorListerner::flush();
 	splash.updateProgress(80, "Creating UI – Apply screen resolution");
 
 	m_renderWidget = new RenderWidget(this);
@@ -91,6 +168,8 @@ MainWindow::MainWindow(QApplication* app)
 	// connect the newly created widgets with specific slots
 	connect(m_renderWidget, SIGNAL(framesPerSecondChanged(int)), this, SLOT(updateFramesPerSecond(int)));
 	connect(m_renderWidget, SIGNAL(objectsCountChanged(int)), this, SLOT(updateObjectsCount(int)));
+	connect(m_renderWidget, SIGNAL(physicsStatsChanged(int, int, int, int)), this, SLOT(updatePhysicsStats(int, int, int, int)));
+	connect(m_renderWidget, SIGNAL(memoryChanged(int, int)), this, SLOT(updateMemory(int, int)));
 
 	connect(m_renderWidget, SIGNAL(objectSelected(sim::Object)), m_toolBox, SLOT(updateData(sim::Object)));
 	connect(m_renderWidget, SIGNAL(objectSelected(sim::__Object::Type)), m_toolBox, SLOT(showModificationWidgets(sim::__Object::Type)));
@@ -102,6 +181,7 @@ MainWindow::MainWindow(QApplication* app)
 
 	showMaximized();
 	m_renderWidget->updateGL();
+	std::cout << "startup: first frame after " << startupClock.get() * 1000.0f << " ms" << std::endl;
 	m_renderWidget->m_timer->start();
 	m_toolBox->updateMaterials();
 	splash.updateProgress(100, "Starting ...");
@@ -176,6 +256,26 @@ void MainWindow::createMenu()
 	connect(m_gravity, SIGNAL(triggered()), this, SLOT(onGravityPressed()));
 	m_menuSimulation->addAction(m_gravity);
 
+	m_layout = new QAction("Generate &Layout...", this);
+	connect(m_layout, SIGNAL(triggered()), this, SLOT(onLayoutPressed()));
+	m_menuSimulation->addAction(m_layout);
+
+	m_menuSimulation->addSeparator();
+
+	m_record = new QAction("&Record", this);
+	m_record->setCheckable(true);
+	connect(m_record, SIGNAL(triggered()), this, SLOT(onRecordPressed()));
+	m_menuSimulation->addAction(m_record);
+
+	m_replay = new QAction("Re&play Recording", this);
+	connect(m_replay, SIGNAL(triggered()), this, SLOT(onReplayPressed()));
+	m_menuSimulation->addAction(m_replay);
+
+	m_stop_replay = new QAction("Stop Replay", this);
+	m_stop_replay->setEnabled(false);
+	connect(m_stop_replay, SIGNAL(triggered()), this, SLOT(onReplayPressed()));
+	m_menuSimulation->addAction(m_stop_replay);
+
 	// Options
 	m_menuOptions = menuBar()->addMenu("&Options");
 
@@ -223,6 +323,17 @@ void MainWindow::createStatusBar()
 	m_objectsCount->setToolTip("There is 1 object in the world");
 	statusBar()->addWidget(m_objectsCount);
 
+	m_physicsStats = new QLabel("");
+	m_physicsStats->setMinimumSize(m_physicsStats->sizeHint());
+	m_physicsStats->setAlignment(Qt::AlignLeft);
+	m_physicsStats->setToolTip("Active and sleeping bodies, islands and contact joints of the last step");
+	statusBar()->addWidget(m_physicsStats);
+
+	m_memory = new QLabel("");
+	m_memory->setMinimumSize(m_memory->sizeHint());
+	m_memory->setAlignment(Qt::AlignLeft);
+	statusBar()->addWidget(m_memory);
+
 	m_simulationStatus = new QLabel("");
 	m_simulationStatus->setMinimumSize(m_simulationStatus->sizeHint());
 	m_simulationStatus->setAlignment(Qt::AlignLeft);
@@ -255,6 +366,21 @@ void MainWindow::updateObjectsCount(int count)
 	}
 }
 
+void MainWindow::updatePhysicsStats(int active, int sleeping, int islands, int joints)
+{
+	m_physicsStats->setText(QString("%1 active / %2 sleeping, %3 islands, %4 contacts   ")
+			.arg(active).arg(sleeping).arg(islands).arg(joints));
+}
+
+void MainWindow::updateMemory(int current, int peak)
+{
+	m_memory->setText(QString("%1 MB (peak %2 MB)   ").arg(current).arg(peak));
+
+	std::stringstream report;
+	util::MemoryStats::instance().report(report);
+	m_memory->setToolTip(QString::fromStdString(report.str()));
+}
+
 void MainWindow::selectInteraction(sim::Simulation::InteractionType type)
 {
 	sim::Simulation::instance().setInteractionType(util::RIGHT, type);
@@ -345,6 +471,45 @@ void MainWindow::onGravityPressed()
 	newton::gravity = dialog->run();
 }
 
+void MainWindow::onLayoutPressed()
+{
+	QString fileName = QFileDialog::getOpenFileName(this, "TUStudios Dominator - Generate Layout", "data/layouts", "TUStudios Dominator Layout (*.xml)");
+	if (fileName != "" && sim::LayoutGenerator::load(fileName.toStdString()))
+		m_modified = true;
+}
+
+void MainWindow::onRecordPressed()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	if (simulation.getRecorder()) {
+		simulation.stopRecording();
+	} else {
+		QString fileName = QFileDialog::getSaveFileName(this, "TUStudios Dominator - Record", 0, "TUStudios Dominator Recording (*.rec)");
+		if (fileName != "") {
+			m_stop_replay->setEnabled(false);
+			simulation.startRecording(fileName.toStdString());
+		}
+	}
+	m_record->setChecked(simulation.getRecorder() != NULL);
+}
+
+void MainWindow::onReplayPressed()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	if (QObject::sender() == m_stop_replay) {
+		simulation.stopReplay();
+	} else {
+		QString fileName = QFileDialog::getOpenFileName(this, "TUStudios Dominator - Replay", 0, "TUStudios Dominator Recording (*.rec)");
+		if (fileName != "" && simulation.startReplay(fileName.toStdString())) {
+			m_play->setEnabled(true);
+			m_stop->setEnabled(false);
+			m_stop_no_reset->setEnabled(false);
+		}
+	}
+	m_record->setChecked(simulation.getRecorder() != NULL);
+	m_stop_replay->setEnabled(simulation.getPlayer() != NULL);
+}
+
 void MainWindow::onSoundControlsPressed()
 {
 	bool status;
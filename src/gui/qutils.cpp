@@ -6,7 +6,9 @@
 
 #include <gui/qutils.hpp>
 #include <gui/dialogs.hpp>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThread>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QLabel>
 #include <QtGui/QMouseEvent>
@@ -63,11 +65,31 @@ void SplashScreen::updateProgress(const int progress, const QString message)
 	m_message->setText(message);
 }
 
+std::list<std::string> QtErrorListerner::s_queue;
+QMutex QtErrorListerner::s_mutex;
+
 void QtErrorListerner::displayError(const std::string& message)
 {
+	// widgets must only be created on the GUI thread
+	if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+		QMutexLocker lock(&s_mutex);
+		s_queue.push_back(message);
+		return;
+	}
 	gui::MessageDialog("Error", message, gui::MessageDialog::QERROR);
 }
 
+void QtErrorListerner::flush()
+{
+	std::list<std::string> messages;
+	{
+		QMutexLocker lock(&s_mutex);
+		messages.swap(s_queue);
+	}
+	for (std::list<std::string>::iterator itr = messages.begin(); itr != messages.end(); ++itr)
+		gui::MessageDialog("Error", *itr, gui::MessageDialog::QERROR);
+}
+
 void QtKeyAdapter::keyEvent(QKeyEvent* event)
 {
 	// do nothing if the key was already pressed
@@ -6,18 +6,26 @@
 
 #include <gui/renderwidget.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 
 #include <m3d/m3d.hpp>
+#include <opengl/gpuprofiler.hpp>
 #include <opengl/shader.hpp>
 #include <opengl/texture.hpp>
 #include <util/inputadapters.hpp>
 #include <simulation/material.hpp>
 #include <simulation/simulation.hpp>
 #include <util/config.hpp>
+#include <util/profiler.hpp>
+#include <util/memory.hpp>
+#include <newton/stats.hpp>
 
 #include <QtCore/QString>
 
+#include <QtGui/QFont>
+#include <QtGui/QKeyEvent>
 #include <QtGui/QWheelEvent>
 #include <QtGui/QWidget>
 
@@ -29,7 +37,7 @@ using namespace m3d;
 namespace gui {
 
 RenderWidget::RenderWidget(QWidget* parent) :
-	QGLWidget(parent)
+	QGLWidget(parent), m_showProfiler(false), m_showTimeline(false)
 {
 	setFocusPolicy(Qt::WheelFocus);
 	//updateGL();
@@ -40,6 +48,8 @@ RenderWidget::RenderWidget(QWidget* parent) :
 
 void RenderWidget::initializeGL()
 {
+	util::Profiler::instance().setThreadName("main");
+
 	GLenum err = glewInit();
 	if (err != GLEW_OK) {
 		util::ErrorAdapter::instance().displayErrorMessage("Could not initialize GLEW!");
@@ -47,9 +57,14 @@ void RenderWidget::initializeGL()
 	}
 
 	// load per-pixel lighting shader
-
+	util::Clock clock;
 	ogl::ShaderMgr::instance().load(util::Config::instance().get("enableShadows", false) ? "data/shaders_shadow/" : "data/shaders/");
-	ogl::TextureMgr::instance().load("data/textures/");
+	std::cout << "startup: shaders took " << clock.get() * 1000.0f << " ms" << std::endl;
+
+	// upload the textures decoded during startup
+	clock.reset();
+	ogl::TextureMgr::instance().upload();
+	std::cout << "startup: texture upload took " << clock.get() * 1000.0f << " ms" << std::endl;
 
 	glShadeModel(GL_SMOOTH);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -81,16 +96,32 @@ void RenderWidget::resizeGL(int width, int height)
 
 void RenderWidget::paintGL()
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	{
+		util::ProfileZone zone("frame");
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	sim::Simulation::instance().update();
-	sim::Simulation::instance().render();
+		sim::Simulation::instance().update();
+		sim::Simulation::instance().render();
+	}
+	ogl::GpuProfiler::instance().frame();
+	util::Profiler::instance().frame();
+
+	if (m_showProfiler)
+		renderProfiler();
+	if (m_showTimeline)
+		renderTimeline();
+	if (sim::Simulation::instance().getChainColors())
+		renderChainSummary();
 
 	static int frames = 0;
 	frames++;
 	if (m_clock.get() >= 1.0f) {
 		emit framesPerSecondChanged(frames);
 		emit objectsCountChanged(sim::Simulation::instance().getObjectCount());
+		const newton::StepStats& step = newton::Stats::instance().getLast();
+		emit physicsStatsChanged(step.active, step.sleeping, step.islands, step.contactJoints);
+		emit memoryChanged(util::MemoryStats::instance().getTotal() / (1024 * 1024),
+				util::MemoryStats::instance().getTotalPeak() / (1024 * 1024));
 		if (sim::Simulation::instance().getSelectedObject()) {
 			emit objectSelected(sim::Simulation::instance().getSelectedObject());
 		}
@@ -99,8 +130,223 @@ void RenderWidget::paintGL()
 	}
 }
 
+void RenderWidget::renderProfiler()
+{
+	std::vector<util::Profiler::Stats> stats;
+	util::Profiler::instance().getStats(stats);
+
+	glDisable(GL_DEPTH_TEST);
+	glColor3f(1.0f, 1.0f, 1.0f);
+
+	int y = 20;
+	renderText(10, y, QString("phase               last     min     avg     p99   (ms)"), QFont("Monospace", 9));
+	std::vector<util::Profiler::Stats>::const_iterator itr = stats.begin();
+	for ( ; itr != stats.end(); ++itr) {
+		y += 14;
+		QString line = QString("%1 %2 %3 %4 %5")
+				.arg(QString::fromStdString(itr->name), -16)
+				.arg(itr->last, 7, 'f', 2)
+				.arg(itr->min, 7, 'f', 2)
+				.arg(itr->avg, 7, 'f', 2)
+				.arg(itr->p99, 7, 'f', 2);
+		renderText(10, y, line, QFont("Monospace", 9));
+	}
+
+	// the solver statistics of the last step
+	const newton::StepStats& step = newton::Stats::instance().getLast();
+	y += 28;
+	renderText(10, y, QString("bodies %1 (%2 active, %3 sleeping)")
+			.arg(step.bodies).arg(step.active).arg(step.sleeping), QFont("Monospace", 9));
+	y += 14;
+	renderText(10, y, QString("islands %1 (largest %2)   sizes 1:%3 2-3:%4 4-7:%5 8-15:%6 16-31:%7 32+:%8")
+			.arg(step.islands).arg(step.largestIsland)
+			.arg(step.islandSizes[0]).arg(step.islandSizes[1]).arg(step.islandSizes[2])
+			.arg(step.islandSizes[3]).arg(step.islandSizes[4]).arg(step.islandSizes[5]), QFont("Monospace", 9));
+	y += 14;
+	renderText(10, y, QString("contact joints %1, contacts %2, callbacks %3, step %4 ms")
+			.arg(step.contactJoints).arg(step.contacts).arg(step.callbacks)
+			.arg(step.time, 0, 'f', 2), QFont("Monospace", 9));
+
+	std::map<std::pair<int, int>, unsigned> pairs;
+	newton::Stats::instance().getPairCounts(pairs);
+	std::map<std::pair<int, int>, unsigned>::const_iterator pair = pairs.begin();
+	for ( ; pair != pairs.end(); ++pair) {
+		const sim::Material* mat0 = sim::MaterialMgr::instance().fromID(pair->first.first);
+		const sim::Material* mat1 = sim::MaterialMgr::instance().fromID(pair->first.second);
+		y += 14;
+		renderText(10, y, QString("  %1 / %2: %3")
+				.arg(mat0 ? QString::fromStdString(mat0->name) : QString("default"))
+				.arg(mat1 ? QString::fromStdString(mat1->name) : QString("default"))
+				.arg(pair->second), QFont("Monospace", 9));
+	}
+
+	glEnable(GL_DEPTH_TEST);
+}
+
+void RenderWidget::renderTimeline()
+{
+	const sim::ToppleTracker& topple = sim::Simulation::instance().getToppleTracker();
+	const std::vector<float>& hits = topple.getHitTimes();
+	const std::vector<float>& rests = topple.getRestTimes();
+	const std::vector<sim::ToppleStall>& stalls = topple.getStalls();
+	const sim::ToppleSummary summary = topple.getSummary();
+
+	// the panel at the bottom of the view, in window coordinates
+	const float left = 10.0f, right = width() - 10.0f;
+	const float bottom = height() - 10.0f, top = bottom - 120.0f;
+	const float time = std::max(topple.getTime(), 1.0f);
+	const float count = std::max(summary.dominoes, 1u);
+	const float sx = (right - left) / time;
+	const float sy = (bottom - top) / count;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_2D);
+	glUseProgram(0);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0.0, width(), height(), 0.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	// the stalls, until the wave resumed or until now
+	glColor3f(0.5f, 0.5f, 0.0f);
+	glBegin(GL_QUADS);
+	for (std::vector<sim::ToppleStall>::const_iterator itr = stalls.begin(); itr != stalls.end(); ++itr) {
+		const float end = itr->duration < 0.0f ? topple.getTime() : itr->time + itr->duration;
+		glVertex2f(left + itr->time * sx, top);
+		glVertex2f(left + itr->time * sx, bottom);
+		glVertex2f(left + end * sx, bottom);
+		glVertex2f(left + end * sx, top);
+	}
+	glEnd();
+
+	glColor3f(0.5f, 0.5f, 0.5f);
+	glBegin(GL_LINE_LOOP);
+	glVertex2f(left, top);
+	glVertex2f(right, top);
+	glVertex2f(right, bottom);
+	glVertex2f(left, bottom);
+	glEnd();
+
+	// the number of hit dominoes over time
+	glColor3f(0.0f, 1.0f, 0.0f);
+	glBegin(GL_LINE_STRIP);
+	glVertex2f(left, bottom);
+	for (unsigned i = 0; i < hits.size(); ++i) {
+		glVertex2f(left + hits[i] * sx, bottom - i * sy);
+		glVertex2f(left + hits[i] * sx, bottom - (i + 1) * sy);
+	}
+	glVertex2f(left + topple.getTime() * sx, bottom - hits.size() * sy);
+	glEnd();
+
+	// the number of fallen dominoes at rest over time
+	glColor3f(1.0f, 0.0f, 0.0f);
+	glBegin(GL_LINE_STRIP);
+	glVertex2f(left, bottom);
+	for (unsigned i = 0; i < rests.size(); ++i) {
+		glVertex2f(left + rests[i] * sx, bottom - i * sy);
+		glVertex2f(left + rests[i] * sx, bottom - (i + 1) * sy);
+	}
+	glVertex2f(left + topple.getTime() * sx, bottom - rests.size() * sy);
+	glEnd();
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+
+	glColor3f(1.0f, 1.0f, 1.0f);
+	renderText(10, (int)top - 6, QString("dominoes %1, hit %2, fallen %3, cascade %4 s, wave %5/s, length %6, stalls %7")
+			.arg(summary.dominoes).arg(summary.hit).arg(summary.fallen)
+			.arg(summary.duration, 0, 'f', 2).arg(summary.waveSpeed, 0, 'f', 2)
+			.arg(summary.length, 0, 'f', 1).arg(summary.stalls), QFont("Monospace", 9));
+
+	glPopAttrib();
+}
+
+void RenderWidget::renderChainSummary()
+{
+	const sim::ChainChecker& chains = sim::Simulation::instance().getChainChecker();
+	if (!chains.isChecked())
+		return;
+
+	const sim::ChainSummary summary = chains.getSummary();
+	glDisable(GL_DEPTH_TEST);
+	glColor3f(1.0f, 1.0f, 1.0f);
+	renderText(10, height() - 10, QString("dominoes %1, chains %2, links %3, weak %4, failing %5")
+			.arg(summary.dominoes).arg(summary.chains).arg(summary.links)
+			.arg(summary.weak).arg(summary.failing), QFont("Monospace", 9));
+	glEnable(GL_DEPTH_TEST);
+}
+
 void RenderWidget::keyPressEvent(QKeyEvent* event)
 {
+	// profiler overlay and trace, these keys are not passed to the simulation
+	if (event->key() == Qt::Key_F3) {
+		m_showProfiler = !m_showProfiler;
+		if (m_showProfiler)
+			util::Profiler::setEnabled(true);
+		else if (!util::Config::instance().get("enableProfiler", false))
+			util::Profiler::setEnabled(false);
+		return;
+	}
+	if (event->key() == Qt::Key_F4) {
+		util::Profiler::instance().writeTrace(
+				util::Config::instance().get<std::string>("profilerTrace", "profile.json"));
+		return;
+	}
+
+	// topple timeline and colours
+	if (event->key() == Qt::Key_F8) {
+		m_showTimeline = !m_showTimeline;
+		return;
+	}
+	if (event->key() == Qt::Key_F10) {
+		sim::Simulation& simulation = sim::Simulation::instance();
+		simulation.setToppleColors(!simulation.getToppleColors());
+		return;
+	}
+
+	// predicted links of the dominoes
+	if (event->key() == Qt::Key_F11) {
+		sim::Simulation& simulation = sim::Simulation::instance();
+		simulation.setChainColors(!simulation.getChainColors());
+		return;
+	}
+	if (event->key() == Qt::Key_F12) {
+		std::ofstream out(util::Config::instance().get<std::string>("chainLinksFile", "links.csv").c_str());
+		sim::Simulation::instance().getChainChecker().writeLinks(out);
+		return;
+	}
+
+	// playback controls of a recording
+	if (sim::Player* player = sim::Simulation::instance().getPlayer()) {
+		const int second = (int)(1000.0f / SIMULATION_STEP);
+		switch (event->key()) {
+		case Qt::Key_F5:
+			player->setPaused(!player->isPaused());
+			return;
+		case Qt::Key_F6:
+			player->setSpeed(player->getSpeed() * 0.5f);
+			return;
+		case Qt::Key_F7:
+			player->setSpeed(player->getSpeed() * 2.0f);
+			return;
+		case Qt::Key_Left:
+			player->seek(player->getFrame() - second);
+			return;
+		case Qt::Key_Right:
+			player->seek(player->getFrame() + second);
+			return;
+		default:
+			break;
+		}
+	}
 	m_keyAdapter.keyEvent(event);
 }
 
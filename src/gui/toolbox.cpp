@@ -104,9 +104,8 @@ void ToolBox::create_m_objects()
 	menu->addAction(new QObjectAction(__Object::SPHERE));
 	m_objectMenu->addMenu(menu);
 
-	// create the menu for templates
+	// create the menu for templates, filled by loadTemplates()
 	m_template_menu = new QMenu("Templates");
-	loadTemplates("data/templates/");
 	m_objectMenu->addMenu(m_template_menu);
 
 	m_objects = new QPushButton("Add an object");
@@ -250,6 +249,11 @@ void ToolBox::create_m_buttonbox()
 	m_mouseinteraction->addButton(m_rotate, (int) Simulation::INT_ROTATE);
 	buttonLayout->addWidget(m_rotate, 1, 1);
 
+	m_editPath = new QPushButton("Edit\nPath");
+	m_editPath->setCheckable(true);
+	m_mouseinteraction->addButton(m_editPath, (int) Simulation::INT_EDIT_PATH);
+	buttonLayout->addWidget(m_editPath, 2, 0);
+
 	m_mouseinteraction->setParent(this);
 	connect(m_mouseinteraction, SIGNAL(buttonClicked(int)), this, SLOT(onInteractionPressed(int)));
 }
@@ -257,16 +261,21 @@ void ToolBox::create_m_buttonbox()
 void ToolBox::loadMaterials(QString filename)
 {
 	if (MaterialMgr::instance().load(filename.toStdString())) {
-		disconnect(m_materials, SIGNAL(currentIndexChanged(int)), this, SLOT(materialSelected(int)));
-		std::set<std::string> materials;
-		MaterialMgr::instance().getMaterials(materials);
-		for (std::set<std::string>::iterator itr = materials.begin(); itr != materials.end(); itr++) {
-			m_materials->addItem(QString::fromStdString(*itr), QString::fromStdString(*itr));
-		}
-		connect(m_materials, SIGNAL(currentIndexChanged(int)), this, SLOT(materialSelected(int)));
+		showMaterials();
 	} // otherwise a catched exception message
 }
 
+void ToolBox::showMaterials()
+{
+	disconnect(m_materials, SIGNAL(currentIndexChanged(int)), this, SLOT(materialSelected(int)));
+	std::set<std::string> materials;
+	MaterialMgr::instance().getMaterials(materials);
+	for (std::set<std::string>::iterator itr = materials.begin(); itr != materials.end(); itr++) {
+		m_materials->addItem(QString::fromStdString(*itr), QString::fromStdString(*itr));
+	}
+	connect(m_materials, SIGNAL(currentIndexChanged(int)), this, SLOT(materialSelected(int)));
+}
+
 void ToolBox::updateMaterials(QString filename)
 {
 	if (filename != "") {
@@ -514,7 +523,8 @@ void ToolBox::updateData(Object object)
 
 void ToolBox::deselectInteraction()
 {
-	if (!Simulation::instance().getSelectedObject() && m_mouseinteraction->checkedButton()) {
+	if (!Simulation::instance().getSelectedObject() && m_mouseinteraction->checkedButton()
+			&& m_mouseinteraction->checkedId() != Simulation::INT_EDIT_PATH) {
 		m_mouseinteraction->setExclusive(false);
 		m_mouseinteraction->checkedButton()->setChecked(false);
 		m_mouseinteraction->setExclusive(true);
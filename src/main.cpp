@@ -5,6 +5,8 @@
  */
 
 //#define UNIT_TESTS
+//#define SCENE_BENCHMARK
+//#define MICRO_BENCHMARK
 #ifdef UNIT_TESTS
 
 #include <cppunit/CompilerOutputter.h>
@@ -33,6 +35,51 @@ int main (int argc, char* argv[])
 
     return collectedresults.wasSuccessful() ? 0 : 1;
 }
+#elif defined(SCENE_BENCHMARK)
+
+#include <clocale>
+#include <util/config.hpp>
+#include <util/profiler.hpp>
+#include <benchmarks/scenebench.hpp>
+
+int main(int argc, char* argv[])
+{
+	setlocale(LC_ALL,"C");
+	util::Config::instance().load("data/config.xml");
+	util::Profiler::instance();
+	return bench::runSceneBenchmark(argc, argv);
+}
+#elif defined(MICRO_BENCHMARK)
+
+#include <clocale>
+#include <cstdlib>
+#include <new>
+#include <util/config.hpp>
+#include <util/profiler.hpp>
+#include <benchmarks/microbench.hpp>
+
+// count the allocations of the benchmarked operations
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+	bench::allocations++;
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) throw()
+{
+	free(p);
+}
+
+int main(int argc, char* argv[])
+{
+	setlocale(LC_ALL,"C");
+	util::Config::instance().load("data/config.xml");
+	util::Profiler::instance();
+	return bench::runMicroBenchmarks(argc, argv);
+}
 #else
 
 #include <iostream>
@@ -40,6 +87,7 @@ int main (int argc, char* argv[])
 #include <gui/mainwindow.hpp>
 #include <clocale>
 #include <util/config.hpp>
+#include <util/profiler.hpp>
 
 int main(int argc, char **argv) {
 
@@ -50,6 +98,9 @@ int main(int argc, char **argv) {
 	using namespace util;
 	Config::instance().load("data/config.xml");
 
+	// created before any thread is started, the workers only use it
+	Profiler::instance();
+
 	std::cout << "Totally Unrelated Studios proudly presents:" << std::endl
 			  << "\tDOMINATOR" << std::endl << std::endl;
 
@@ -0,0 +1,181 @@
+/**
+ * @date Oct 19, 2026
+ * @file newton/heightcache.cpp
+ */
+
+#include <newton/heightcache.hpp>
+#include <newton/util.hpp>
+#include <util/config.hpp>
+#include <util/memory.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace newton {
+
+HeightCache* HeightCache::s_instance = NULL;
+
+/** The number of samples along each side of a tile */
+static const int TILE_SAMPLES = HEIGHT_TILE_CELLS + 1;
+
+HeightCache::HeightCache()
+{
+	util::Config& config = util::Config::instance();
+	m_resolution = std::max(0.01f, config.get("heightCacheResolution", 0.5f));
+	m_threshold = config.get("heightCacheThreshold", 0.1f);
+}
+
+HeightCache::HeightCache(const HeightCache& other)
+{
+}
+
+HeightCache::~HeightCache()
+{
+	clear();
+}
+
+HeightCache& HeightCache::instance()
+{
+	if (!s_instance)
+		s_instance = new HeightCache();
+	return *s_instance;
+}
+
+void HeightCache::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+HeightCache::TileKey HeightCache::getTile(float x, float z) const
+{
+	const float size = m_resolution * HEIGHT_TILE_CELLS;
+	return std::make_pair((int)floor(x / size), (int)floor(z / size));
+}
+
+void HeightCache::erase(const TileMap::iterator& itr)
+{
+	util::MemoryStats::instance().add(util::MemoryStats::ENVIRONMENT,
+			-(long)(itr->second.size() * sizeof(float)));
+	m_tiles.erase(itr);
+}
+
+void HeightCache::clear()
+{
+	while (!m_tiles.empty())
+		erase(m_tiles.begin());
+}
+
+void HeightCache::invalidate(const Vec3f& min, const Vec3f& max)
+{
+	// the samples on the border of a tile are shared with its neighbor
+	const TileKey lower = getTile(min.x, min.z);
+	const TileKey first(lower.first - 1, lower.second - 1);
+	const TileKey last = getTile(max.x, max.z);
+
+	// the tiles are sorted by x and z, so only the columns in the range are visited
+	TileMap::iterator itr = m_tiles.lower_bound(first);
+	while (itr != m_tiles.end() && itr->first.first <= last.first) {
+		const TileKey& key = itr->first;
+		if (key.second < first.second)
+			itr = m_tiles.lower_bound(TileKey(key.first, first.second));
+		else if (key.second > last.second)
+			itr = m_tiles.lower_bound(TileKey(key.first + 1, first.second));
+		else
+			erase(itr++);
+	}
+}
+
+void HeightCache::build(const std::set<TileKey>& keys)
+{
+	const float size = m_resolution * HEIGHT_TILE_CELLS;
+
+	std::vector<Vec2f> samples;
+	samples.reserve(keys.size() * TILE_SAMPLES * TILE_SAMPLES);
+	for (std::set<TileKey>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr) {
+		const Vec2f origin(itr->first * size, itr->second * size);
+		for (int z = 0; z < TILE_SAMPLES; ++z)
+			for (int x = 0; x < TILE_SAMPLES; ++x)
+				samples.push_back(origin + Vec2f(x * m_resolution, z * m_resolution));
+	}
+
+	std::vector<float> heights;
+	getVerticalPositions(samples, heights, HEIGHT_STATIC_EXACT);
+
+	std::vector<float>::const_iterator begin = heights.begin();
+	for (std::set<TileKey>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr) {
+		std::vector<float>& tile = m_tiles[*itr];
+		tile.assign(begin, begin + TILE_SAMPLES * TILE_SAMPLES);
+		begin += TILE_SAMPLES * TILE_SAMPLES;
+	}
+	util::MemoryStats::instance().add(util::MemoryStats::ENVIRONMENT, heights.size() * sizeof(float));
+}
+
+bool HeightCache::interpolate(const Vec2f& point, float& height) const
+{
+	const TileKey key = getTile(point.x, point.y);
+	const std::vector<float>& tile = m_tiles.find(key)->second;
+
+	// the cell and the position inside of it
+	const float u = point.x / m_resolution - key.first * HEIGHT_TILE_CELLS;
+	const float v = point.y / m_resolution - key.second * HEIGHT_TILE_CELLS;
+	const int x = std::min(std::max((int)floor(u), 0), HEIGHT_TILE_CELLS - 1);
+	const int z = std::min(std::max((int)floor(v), 0), HEIGHT_TILE_CELLS - 1);
+	const float s = u - x;
+	const float t = v - z;
+
+	const float* row = &tile[z * TILE_SAMPLES + x];
+	const float h00 = row[0], h10 = row[1];
+	const float h01 = row[TILE_SAMPLES], h11 = row[TILE_SAMPLES + 1];
+
+	const float lower = std::min(std::min(h00, h10), std::min(h01, h11));
+	const float upper = std::max(std::max(h00, h10), std::max(h01, h11));
+	if (upper - lower > m_threshold)
+		return false;
+
+	height = (h00 * (1.0f - s) + h10 * s) * (1.0f - t) + (h01 * (1.0f - s) + h11 * s) * t;
+	return true;
+}
+
+float HeightCache::get(float x, float z)
+{
+	std::vector<Vec2f> points(1, Vec2f(x, z));
+	std::vector<float> result;
+	get(points, result);
+	return result[0];
+}
+
+void HeightCache::get(const std::vector<Vec2f>& points, std::vector<float>& result)
+{
+	result.resize(points.size());
+	if (!world || points.empty())
+		return;
+
+	std::set<TileKey> missing;
+	for (std::vector<Vec2f>::const_iterator itr = points.begin(); itr != points.end(); ++itr) {
+		const TileKey key = getTile(itr->x, itr->y);
+		if (m_tiles.find(key) == m_tiles.end())
+			missing.insert(key);
+	}
+	if (!missing.empty())
+		build(missing);
+
+	// cells with a step are refined in a second batch
+	std::vector<Vec2f> exact;
+	std::vector<unsigned> indices;
+	for (unsigned i = 0; i < points.size(); ++i) {
+		if (!interpolate(points[i], result[i])) {
+			exact.push_back(points[i]);
+			indices.push_back(i);
+		}
+	}
+
+	if (!exact.empty()) {
+		std::vector<float> heights;
+		getVerticalPositions(exact, heights, HEIGHT_STATIC_EXACT);
+		for (unsigned i = 0; i < indices.size(); ++i)
+			result[indices[i]] = heights[i];
+	}
+}
+
+}
@@ -0,0 +1,152 @@
+/**
+ * @date Oct 19, 2026
+ * @file newton/stats.cpp
+ */
+
+#include <newton/stats.hpp>
+#include <util/clock.hpp>
+#include <util/config.hpp>
+#include <util/threadcounter.hpp>
+#include <iostream>
+#include <algorithm>
+
+namespace newton {
+
+Stats* Stats::s_instance = NULL;
+
+StepStats::StepStats()
+	: step(0), time(0.0f), bodies(0), active(0), sleeping(0), islands(0), largestIsland(0),
+	  contactJoints(0), contacts(0), callbacks(0)
+{
+	for (int i = 0; i < ISLAND_BUCKETS; ++i)
+		islandSizes[i] = 0;
+}
+
+Stats::Stats()
+{
+	std::string fileName = util::Config::instance().get<std::string>("newtonStatsFile", "");
+	if (fileName.size()) {
+		m_csv.open(fileName.c_str());
+		if (m_csv)
+			writeCSVHeader(m_csv);
+		else
+			std::cout << "could not open " << fileName << std::endl;
+	}
+}
+
+Stats::Stats(const Stats& other)
+{
+}
+
+Stats::~Stats()
+{
+}
+
+Stats& Stats::instance()
+{
+	if (!s_instance)
+		s_instance = new Stats();
+	return *s_instance;
+}
+
+void Stats::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+void Stats::install(NewtonWorld* world)
+{
+	NewtonSetIslandUpdateEvent(world, islandUpdate);
+	m_current = StepStats();
+	m_last = StepStats();
+	m_pairs.clear();
+}
+
+int Stats::islandUpdate(const NewtonWorld* world, const void* islandHandle, int bodyCount)
+{
+	Stats& stats = instance();
+	boost::mutex::scoped_lock lock(stats.m_islandMutex);
+
+	StepStats& step = stats.m_current;
+	step.islands++;
+	step.active += bodyCount;
+	if ((unsigned)bodyCount > step.largestIsland)
+		step.largestIsland = bodyCount;
+
+	int bucket = 0;
+	while (bucket < ISLAND_BUCKETS - 1 && bodyCount >= (2 << bucket))
+		bucket++;
+	step.islandSizes[bucket]++;
+
+	// simulate the island
+	return 1;
+}
+
+void Stats::countBodies(const NewtonWorld* world)
+{
+	for (NewtonBody* body = NewtonWorldGetFirstBody(world); body; body = NewtonWorldGetNextBody(world, body)) {
+		m_current.bodies++;
+		if (NewtonBodyGetSleepState(body))
+			m_current.sleeping++;
+
+		// each contact joint is attached to two bodies, count it once
+		for (NewtonJoint* joint = NewtonBodyGetFirstContactJoint(body); joint;
+				joint = NewtonBodyGetNextContactJoint(body, joint)) {
+			if (NewtonJointGetBody0(joint) != body)
+				continue;
+			m_current.contactJoints++;
+			m_current.contacts += NewtonContactJointGetContactCount(joint);
+		}
+	}
+}
+
+void Stats::update(NewtonWorld* world, float timestep)
+{
+	unsigned threads = (unsigned)std::max(NewtonGetThreadsCount(world), util::getThreadCount());
+	if (m_threads.size() < threads)
+		m_threads.resize(threads);
+
+	m_current = StepStats();
+	m_current.step = m_last.step + 1;
+
+	const double begin = util::Clock::now();
+	NewtonUpdate(world, timestep);
+	m_current.time = (util::Clock::now() - begin) * 1000.0;
+
+	countBodies(world);
+
+	// merge the counters of the Newton threads
+	m_pairs.clear();
+	std::vector<ThreadCounts>::iterator itr = m_threads.begin();
+	for ( ; itr != m_threads.end(); ++itr) {
+		m_current.callbacks += itr->callbacks;
+		for (PairCounts::const_iterator pair = itr->pairs.begin(); pair != itr->pairs.end(); ++pair)
+			m_pairs[pair->first] += pair->second;
+		itr->callbacks = 0;
+		itr->pairs.clear();
+	}
+
+	m_last = m_current;
+	if (m_csv.is_open())
+		writeCSV(m_csv, m_last);
+}
+
+void Stats::writeCSVHeader(std::ostream& out)
+{
+	out << "step,time_ms,bodies,active,sleeping,islands,largest_island,"
+		<< "islands_1,islands_2_3,islands_4_7,islands_8_15,islands_16_31,islands_32_plus,"
+		<< "contact_joints,contacts,callbacks" << std::endl;
+}
+
+void Stats::writeCSV(std::ostream& out, const StepStats& stats)
+{
+	out << stats.step << "," << stats.time << "," << stats.bodies << "," << stats.active << ","
+		<< stats.sleeping << "," << stats.islands << "," << stats.largestIsland;
+	for (int i = 0; i < ISLAND_BUCKETS; ++i)
+		out << "," << stats.islandSizes[i];
+	out << "," << stats.contactJoints << "," << stats.contacts << "," << stats.callbacks << "\n";
+}
+
+}
@@ -6,7 +6,13 @@
 
 #include <opengl/oglutil.hpp>
 #include <newton/util.hpp>
+#include <newton/heightcache.hpp>
+#include <util/memory.hpp>
+#include <util/threadpool.hpp>
+#include <boost/bind.hpp>
 #include <iostream>
+#include <algorithm>
+#include <stdlib.h>
 #include <dVector.h>
 #include <dMatrix.h>
 
@@ -16,6 +22,25 @@ namespace newton {
 NewtonWorld* world = NULL;
 float gravity = 0.0f;
 
+static void* allocMemory(int sizeInBytes)
+{
+	util::MemoryStats::instance().add(util::MemoryStats::NEWTON, sizeInBytes);
+	return malloc(sizeInBytes);
+}
+
+static void freeMemory(void* ptr, int sizeInBytes)
+{
+	util::MemoryStats::instance().add(util::MemoryStats::NEWTON, -(long)sizeInBytes);
+	free(ptr);
+}
+
+void installMemorySystem()
+{
+	// create the instance before Newton allocates from other threads
+	util::MemoryStats::instance();
+	NewtonSetMemorySystem(allocMemory, freeMemory);
+}
+
 
 struct ExplosionData {
 	Vec3f position;
@@ -89,8 +114,41 @@ static float getVerticalPositionCallback(const NewtonBody* body, const float* no
 	return paramPtr[0];
 }
 
-float getVerticalPosition(float x, float z)
+/** The dynamic bodies without mass, see setDemoted() */
+static BodySet s_demoted;
+
+void setDemoted(const NewtonBody* body, bool demoted)
+{
+	if (demoted)
+		s_demoted.insert(body);
+	else
+		s_demoted.erase(body);
+}
+
+void clearDemoted()
+{
+	s_demoted.clear();
+}
+
+/** Skips all bodies with mass and the demoted ones */
+static unsigned staticBodyPrefilter(const NewtonBody* body, const NewtonCollision* collision, void* userData)
+{
+	float mass, Ixx, Iyy, Izz;
+	NewtonBodyGetMassMatrix(body, &mass, &Ixx, &Iyy, &Izz);
+	return mass == 0.0f && s_demoted.find(body) == s_demoted.end();
+}
+
+/** @return The ray prefilter of the height filter */
+static NewtonWorldRayPrefilterCallback getPrefilter(HeightFilter filter)
+{
+	return filter == HEIGHT_ALL ? NULL : staticBodyPrefilter;
+}
+
+float getVerticalPosition(float x, float z, HeightFilter filter)
 {
+	if (filter == HEIGHT_STATIC)
+		return HeightCache::instance().get(x, z);
+
 	float parameter;
 
 	// shoot a vertical ray from a high altitude and collect the intersection parameter.
@@ -98,59 +156,280 @@ float getVerticalPosition(float x, float z)
 	Vec3f p1(x, -1000.0f, z);
 
 	parameter = 1.2f;
-	NewtonWorldRayCast(world, &p0[0], &p1[0], getVerticalPositionCallback, &parameter, NULL);
+	NewtonWorldRayCast(world, &p0[0], &p1[0], getVerticalPositionCallback, &parameter, getPrefilter(filter));
 	//_ASSERTE (parameter < 1.0f);
 
 	// the intersection is the interpolated value
 	return 1000.0f - 2000.0f * parameter;
 }
 
+bool getWorldAABB(Vec3f& min, Vec3f& max)
+{
+	NewtonBody* body = NewtonWorldGetFirstBody(world);
+	if (!body)
+		return false;
+
+	NewtonBodyGetAABB(body, &min[0], &max[0]);
+	for (body = NewtonWorldGetNextBody(world, body); body; body = NewtonWorldGetNextBody(world, body)) {
+		Vec3f bodyMin, bodyMax;
+		NewtonBodyGetAABB(body, &bodyMin[0], &bodyMax[0]);
+		for (int i = 0; i < 3; ++i) {
+			min[i] = std::min(min[i], bodyMin[i]);
+			max[i] = std::max(max[i], bodyMax[i]);
+		}
+	}
+	return true;
+}
+
+/** The minimum number of points per task of getVerticalPositions */
+static const unsigned VERTICAL_RAYS_PER_TASK = 256;
 
-static unsigned ConvexCastCallback(const NewtonBody* body, const NewtonCollision* collision, void* userData)
+static void castVerticalRays(const Vec2f* points, float* result, unsigned count, float top, float bottom,
+		NewtonWorldRayPrefilterCallback prefilter)
 {
-	//NewtonBody* other = (NewtonBody*)userData;
-	std::list<NewtonBody*>* others = (std::list<NewtonBody*>*)userData;
-	return std::find(others->begin(), others->end(), body) == others->end();
-	//return (other == body) ? 0 : 1;
+	for (unsigned i = 0; i < count; ++i) {
+		Vec3f p0(points[i].x, top, points[i].y);
+		Vec3f p1(points[i].x, bottom, points[i].y);
+
+		float parameter = 1.2f;
+		NewtonWorldRayCast(world, &p0[0], &p1[0], getVerticalPositionCallback, &parameter, prefilter);
+		result[i] = top + (bottom - top) * parameter;
+	}
 }
 
-float getConvexCastPlacement(NewtonBody* body, std::list<NewtonBody*>* noCollision)
+void getVerticalPositions(const std::vector<Vec2f>& points, std::vector<float>& result, HeightFilter filter)
 {
-	std::list<NewtonBody*> temp;
-	if (noCollision == NULL) {
-		noCollision = &temp;
+	if (filter == HEIGHT_STATIC) {
+		HeightCache::instance().get(points, result);
+		return;
 	}
-	noCollision->push_back(body);
 
+	result.resize(points.size());
+	if (points.empty())
+		return;
+
+	// the rays start above and end below all bodies
+	Vec3f min(0.0f, -1000.0f, 0.0f), max(0.0f, 1000.0f, 0.0f);
+	getWorldAABB(min, max);
+	const float top = max.y + 1.0f;
+	const float bottom = min.y - 1.0f;
+
+	if (points.size() <= VERTICAL_RAYS_PER_TASK) {
+		castVerticalRays(&points[0], &result[0], points.size(), top, bottom, getPrefilter(filter));
+		return;
+	}
+
+	// the pool waits for the workers
+	util::ThreadPool pool;
+	const unsigned tasks = pool.size() * 4;
+	const unsigned count = std::max((points.size() + tasks - 1) / tasks, (size_t)VERTICAL_RAYS_PER_TASK);
+	for (unsigned begin = 0; begin < points.size(); begin += count) {
+		const unsigned size = std::min(count, (unsigned)points.size() - begin);
+		pool.schedule(boost::bind(&castVerticalRays, &points[begin], &result[begin], size, top, bottom, getPrefilter(filter)));
+	}
+}
+
+
+/** The contacts of a convex cast that are checked against the pieces */
+static const int CONVEX_CAST_CONTACTS = 16;
+
+/** A contact that is closer to a piece lies on its surface */
+static const float CONTACT_TOLERANCE = 0.01f;
+
+/** The casts start above and end below the bodies in their way */
+static const float CAST_MARGIN = 1.0f;
+
+static unsigned convexCastPrefilter(const NewtonBody* body, const NewtonCollision* collision, void* userData)
+{
+	const BodySet* exclude = (const BodySet*)userData;
+	return exclude->find(body) == exclude->end();
+}
+
+struct ColumnData {
+	const BodySet* exclude;
+	bool found;
+	float min, max;
+};
+
+static void columnCallback(const NewtonBody* body, void* userData)
+{
+	ColumnData* data = (ColumnData*)userData;
+	if (data->exclude->find(body) != data->exclude->end())
+		return;
+
+	Vec3f min, max;
+	NewtonBodyGetAABB(body, &min[0], &max[0]);
+	data->min = data->found ? std::min(data->min, min.y) : min.y;
+	data->max = data->found ? std::max(data->max, max.y) : max.y;
+	data->found = true;
+}
+
+/** A convex collision and its matrix in the world */
+struct ConvexPiece {
+	const NewtonCollision* collision;
 	Mat4f matrix;
-	NewtonBodyGetMatrix(body, matrix[0]);
-	matrix._42 += 200.0f;
-	Vec3f p(matrix.getW());
-	p.y -= 400.0f;
+};
 
+/** Appends the convex pieces of the body, i.e. the children of a compound collision */
+static void getConvexPieces(NewtonBody* body, std::vector<ConvexPiece>& pieces)
+{
+	ConvexPiece piece;
+	NewtonBodyGetMatrix(body, piece.matrix[0]);
 	NewtonCollision* collision = NewtonBodyGetCollision(body);
 
-	float param = 0.0f;
-	NewtonWorldConvexCastReturnInfo info[16];
-
 	NewtonCollisionInfoRecord collisionInfo;
 	NewtonCollisionGetInfo(collision, &collisionInfo);
-
 	if (collisionInfo.m_collisionType == SERIALIZE_ID_COMPOUND) {
-		float maximum = -200.0f;
 		for (int i = 0; i < collisionInfo.m_compoundCollision.m_chidrenCount; ++i) {
-			NewtonCollision* node = collisionInfo.m_compoundCollision.m_chidren[i];
-			NewtonWorldConvexCast(world, matrix[0], &p[0], node, &param, noCollision, ConvexCastCallback, info, 16, 0);
-			float current = matrix._42 + (p.y - matrix._42) * param;
-			if (current > maximum) maximum = current;
+			piece.collision = collisionInfo.m_compoundCollision.m_chidren[i];
+			pieces.push_back(piece);
 		}
-		return maximum;
 	} else {
-		NewtonWorldConvexCast(world, matrix[0], &p[0], collision, &param, noCollision, ConvexCastCallback, info, 16, 0);
+		piece.collision = collision;
+		pieces.push_back(piece);
+	}
+}
 
-		matrix._42 += (p.y - matrix._42) * param;
-		return matrix._42;
+static void collectVertices(void* userData, int vertexCount, const float* faceVertices, int id)
+{
+	std::vector<Vec3f>* vertices = (std::vector<Vec3f>*)userData;
+	for (int i = 0; i < vertexCount; ++i)
+		vertices->push_back(Vec3f(faceVertices[i * 3 + 0], faceVertices[i * 3 + 1], faceVertices[i * 3 + 2]));
+}
+
+/**
+ * Casts the piece from the start to the end offset.
+ *
+ * @return The number of contacts, the hit parameter is only valid if > 0
+ */
+static int castPiece(const ConvexPiece& piece, float start, float end, const BodySet& exclude,
+		float& param, NewtonWorldConvexCastReturnInfo* info)
+{
+	Mat4f matrix(piece.matrix);
+	matrix._42 += start;
+	Vec3f target(matrix.getW());
+	target.y += end - start;
+	return NewtonWorldConvexCast(world, matrix[0], &target[0], piece.collision, &param,
+			(void*)&exclude, convexCastPrefilter, info, CONVEX_CAST_CONTACTS, 0);
+}
+
+/** @return True, if the point lies on the surface of the piece moved by the offset */
+static bool isOnPiece(const ConvexPiece& piece, float offset, const float* point)
+{
+	Mat4f matrix(piece.matrix);
+	matrix._42 += offset;
+	Vec3f contact, normal;
+	if (!NewtonCollisionPointDistance(world, point, piece.collision, matrix[0], &contact[0], &normal[0], 0))
+		return true;
+	return (contact - Vec3f(point[0], point[1], point[2])).len() < CONTACT_TOLERANCE;
+}
+
+/** Places the bodies, which have to be part of the exclusion set */
+static float getOffset(const std::vector<NewtonBody*>& bodies, const BodySet& exclude)
+{
+	if (bodies.empty())
+		return 0.0f;
+
+	std::vector<ConvexPiece> pieces;
+	Vec3f min, max;
+	NewtonBodyGetAABB(bodies.front(), &min[0], &max[0]);
+	for (std::vector<NewtonBody*>::const_iterator itr = bodies.begin(); itr != bodies.end(); ++itr) {
+		getConvexPieces(*itr, pieces);
+		Vec3f bodyMin, bodyMax;
+		NewtonBodyGetAABB(*itr, &bodyMin[0], &bodyMax[0]);
+		for (int i = 0; i < 3; ++i) {
+			min[i] = std::min(min[i], bodyMin[i]);
+			max[i] = std::max(max[i], bodyMax[i]);
+		}
 	}
+
+	// only the bodies in the column of the bounding box can be hit
+	ColumnData column;
+	column.exclude = &exclude;
+	column.found = false;
+	Vec3f p0(min.x, -1000.0f, min.z);
+	Vec3f p1(max.x, 1000.0f, max.z);
+	NewtonWorldForEachBodyInAABBDo(world, &p0[0], &p1[0], columnCallback, &column);
+	if (!column.found || pieces.empty())
+		return 0.0f;
+
+	const float start = column.max - min.y + CAST_MARGIN;
+	const float end = column.min - max.y - CAST_MARGIN;
+
+	float param = 1.0f;
+	NewtonWorldConvexCastReturnInfo info[CONVEX_CAST_CONTACTS];
+	if (pieces.size() == 1) {
+		if (!castPiece(pieces.front(), start, end, exclude, param, info))
+			return 0.0f;
+		return start + (end - start) * param;
+	}
+
+	// a single cast of the convex hull of all pieces
+	std::vector<Vec3f> vertices;
+	for (std::vector<ConvexPiece>::const_iterator itr = pieces.begin(); itr != pieces.end(); ++itr)
+		NewtonCollisionForEachPolygonDo(itr->collision, itr->matrix[0], collectVertices, &vertices);
+
+	const Vec3f center = (min + max) * 0.5f;
+	for (std::vector<Vec3f>::iterator itr = vertices.begin(); itr != vertices.end(); ++itr)
+		*itr -= center;
+
+	float offset = start;
+	NewtonCollision* hull = vertices.size() >= 4 ?
+			NewtonCreateConvexHull(world, vertices.size(), &vertices[0][0], sizeof(Vec3f), 0.0f, 0, NULL) : NULL;
+	if (hull) {
+		ConvexPiece proxy;
+		proxy.collision = hull;
+		proxy.matrix = Mat4f::translate(center);
+		const int contacts = castPiece(proxy, start, end, exclude, param, info);
+		NewtonReleaseCollision(world, hull);
+		if (!contacts)
+			return 0.0f;
+		offset = start + (end - start) * param;
+
+		// the pieces are a subset of the hull, so they touch the ground
+		// at the same offset if one of the contacts lies on a piece
+		for (int i = 0; i < contacts; ++i)
+			for (std::vector<ConvexPiece>::const_iterator itr = pieces.begin(); itr != pieces.end(); ++itr)
+				if (isOnPiece(*itr, offset, info[i].m_point))
+					return offset;
+	}
+
+	// the hull hit the ground in a gap, the pieces can move further down
+	bool hit = false;
+	float result = end;
+	for (std::vector<ConvexPiece>::const_iterator itr = pieces.begin(); itr != pieces.end(); ++itr) {
+		if (castPiece(*itr, offset, end, exclude, param, info)) {
+			result = std::max(result, offset + (end - offset) * param);
+			hit = true;
+		}
+	}
+	return hit ? result : 0.0f;
+}
+
+float getConvexCastPlacement(NewtonBody* body, const BodySet* noCollision)
+{
+	Mat4f matrix;
+	NewtonBodyGetMatrix(body, matrix[0]);
+	return matrix._42 + getConvexCastOffset(std::vector<NewtonBody*>(1, body), noCollision);
+}
+
+float getConvexCastOffset(const std::vector<NewtonBody*>& bodies, const BodySet* noCollision)
+{
+	BodySet exclude(bodies.begin(), bodies.end());
+	if (noCollision)
+		exclude.insert(noCollision->begin(), noCollision->end());
+	return getOffset(bodies, exclude);
+}
+
+void getConvexCastOffsets(const std::vector<std::vector<NewtonBody*> >& groups, std::vector<float>& offsets)
+{
+	BodySet exclude;
+	for (std::vector<std::vector<NewtonBody*> >::const_iterator itr = groups.begin(); itr != groups.end(); ++itr)
+		exclude.insert(itr->begin(), itr->end());
+
+	offsets.resize(groups.size());
+	for (unsigned i = 0; i < groups.size(); ++i)
+		offsets[i] = getOffset(groups[i], exclude);
 }
 
 
@@ -0,0 +1,119 @@
+/**
+ * @date Oct 19, 2026
+ * @file opengl/gpuprofiler.cpp
+ */
+
+#include <opengl/gpuprofiler.hpp>
+#include <util/profiler.hpp>
+#include <string>
+
+namespace ogl {
+
+GpuProfiler* GpuProfiler::s_instance = NULL;
+
+GpuProfiler::GpuProfiler()
+	: m_current(0), m_active(false), m_dropped(0)
+{
+	m_arb = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+	for (unsigned i = 0; i <= GPU_PROFILER_LATENCY; ++i)
+		m_frames[i].used = 0;
+}
+
+GpuProfiler::GpuProfiler(const GpuProfiler& other)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (unsigned i = 0; i <= GPU_PROFILER_LATENCY; ++i) {
+		std::vector<GLuint>& queries = m_frames[i].queries;
+		if (!queries.empty())
+			glDeleteQueries(queries.size(), &queries[0]);
+	}
+}
+
+GpuProfiler& GpuProfiler::instance()
+{
+	if (!s_instance)
+		s_instance = new GpuProfiler();
+	return *s_instance;
+}
+
+void GpuProfiler::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+bool GpuProfiler::isSupported()
+{
+	return GLEW_VERSION_3_3 || GLEW_ARB_timer_query || GLEW_EXT_timer_query;
+}
+
+void GpuProfiler::begin(const char* name)
+{
+	if (!util::Profiler::isEnabled() || !isSupported() || m_active)
+		return;
+
+	Frame& frame = m_frames[m_current];
+	if (frame.used == frame.queries.size()) {
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		frame.queries.push_back(query);
+		frame.names.push_back(name);
+	}
+	frame.names[frame.used] = name;
+	glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used]);
+	frame.used++;
+	m_active = true;
+}
+
+void GpuProfiler::end()
+{
+	if (!m_active)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_active = false;
+}
+
+void GpuProfiler::collect(Frame& frame)
+{
+	util::Profiler& profiler = util::Profiler::instance();
+	float total = 0.0f;
+	for (unsigned i = 0; i < frame.used; ++i) {
+		// never wait for a result, drop it instead
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			m_dropped++;
+			continue;
+		}
+
+		GLuint64 elapsed = 0;
+		if (m_arb)
+			glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+		else
+			glGetQueryObjectui64vEXT(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+
+		const float ms = elapsed / 1000000.0f;
+		profiler.addSample(std::string("gpu ") + frame.names[i], ms);
+		total += ms;
+	}
+
+	if (frame.used > 0)
+		profiler.addSample("gpu total", total);
+	frame.used = 0;
+}
+
+void GpuProfiler::frame()
+{
+	end();
+
+	// the slot after the current one is the oldest frame
+	m_current = (m_current + 1) % (GPU_PROFILER_LATENCY + 1);
+	collect(m_frames[m_current]);
+}
+
+}
@@ -13,7 +13,7 @@
 namespace ogl {
 
 
-void __Mesh::genBuffers(ogl::VertexBuffer& vbo)
+void __Mesh::genBuffers(ogl::VertexBuffer& vbo, void* userData)
 {
 	// get the offset in floats and vertices
 	const unsigned vertexSize = vbo.floatSize();
@@ -28,7 +28,7 @@ void __Mesh::genBuffers(ogl::VertexBuffer& vbo)
 	BOOST_FOREACH(const ogl::SubBuffer* old, m_buffers) {
 		ogl::SubBuffer* buffer = new ogl::SubBuffer();
 		buffer->material = old->material;
-		buffer->userData = old->userData;
+		buffer->userData = userData ? userData : old->userData;
 
 		buffer->dataCount = old->dataCount;
 		buffer->dataOffset = old->dataOffset + vertexOffset;
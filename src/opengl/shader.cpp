@@ -13,28 +13,40 @@
 #include <math.h>
 #include <cstring>
 #include <string>
+#include <vector>
 #define BOOST_FILESYSTEM_VERSION 2
 #include <boost/filesystem.hpp>
 #include <stdexcept>
+#include <util/config.hpp>
+#include <util/hash.hpp>
 
 
 namespace ogl {
 
 ShaderMgr* ShaderMgr::s_instance = NULL;
 
+const std::string __Shader::s_cacheFolder = "data/cache/shaders/";
+
+/** Identifies shader cache files, followed by the version */
+static const char s_cacheMagic[4] = { 'D', 'S', 'H', 'D' };
+static const uint32_t s_cacheVersion = 1;
+
 __Shader::__Shader(GLchar* vertexSource, GLchar* fragmentSource) :
 	m_vertexSource(vertexSource), m_fragmentSource(fragmentSource) {
 	m_programObject = 0;
 	m_vertexObject = 0;
 	m_fragmentObject = 0;
+
+	m_hash = util::hash(m_vertexSource, strlen(m_vertexSource));
+	m_hash = util::hash(m_fragmentSource, strlen(m_fragmentSource), m_hash);
 }
 
 __Shader::~__Shader() {
 #ifdef _DEBUG
 	std::cout << "delete shader" << std::endl;
 #endif
-	if (m_vertexSource) delete m_vertexSource;
-	if (m_fragmentSource) delete m_fragmentSource;
+	if (m_vertexSource) delete[] m_vertexSource;
+	if (m_fragmentSource) delete[] m_fragmentSource;
 	if (m_programObject) glDeleteProgram(m_programObject);
 }
 
@@ -51,6 +63,12 @@ void __Shader::getInfoLog(GLuint object)
 }
 
 bool __Shader::compile()
+{
+	beginCompile();
+	return endCompile();
+}
+
+void __Shader::beginCompile()
 {
 	// load vertex source
 	m_vertexObject = glCreateShader(GL_VERTEX_SHADER);
@@ -58,40 +76,136 @@ bool __Shader::compile()
 	glShaderSource(m_vertexObject, 1, (const GLchar**)&m_vertexSource, &len);
 	glCompileShader(m_vertexObject);
 
-	GLint result[3];
-
-	// check if compiled
-	glGetObjectParameterivARB(m_vertexObject, GL_COMPILE_STATUS, &result[0]);
-	getInfoLog(m_vertexObject);
-
 	// load fragment source
 	m_fragmentObject = glCreateShader(GL_FRAGMENT_SHADER);
 	len = strlen(m_fragmentSource);
 	glShaderSource(m_fragmentObject, 1, (const GLchar**)&m_fragmentSource, &len);
 	glCompileShader(m_fragmentObject);
 
-	// check if compiled
-	glGetObjectParameterivARB(m_fragmentObject, GL_COMPILE_STATUS, &result[1]);
-	getInfoLog(m_fragmentObject);
-
 	// create and link program
 	m_programObject = glCreateProgram();
 
 	glAttachShader(m_programObject, m_vertexObject);
 	glAttachShader(m_programObject, m_fragmentObject);
 
+	if (useBinaryCache())
+		glProgramParameteri(m_programObject, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	glLinkProgram(m_programObject);
+}
+
+bool __Shader::endCompile()
+{
+	GLint result[3];
 
+	// the link status is only available if the driver is done
 	glGetProgramiv(m_programObject, GL_LINK_STATUS, &result[2]);
-	getInfoLog(m_programObject);
+	glGetShaderiv(m_vertexObject, GL_COMPILE_STATUS, &result[0]);
+	glGetShaderiv(m_fragmentObject, GL_COMPILE_STATUS, &result[1]);
+
+	// only query the info logs of failed objects
+	if (!result[0]) getInfoLog(m_vertexObject);
+	if (!result[1]) getInfoLog(m_fragmentObject);
+	if (!result[2]) getInfoLog(m_programObject);
 	if (!result[0] || !result[1] || !result[2]) return false;
 
+	glDetachShader(m_programObject, m_vertexObject);
+	glDetachShader(m_programObject, m_fragmentObject);
 	glDeleteShader(m_vertexObject);
 	glDeleteShader(m_fragmentObject);
+	m_vertexObject = m_fragmentObject = 0;
+
+	if (useBinaryCache())
+		saveBinary();
+
+	return true;
+}
+
+bool __Shader::useBinaryCache()
+{
+	return util::Config::instance().get("shaderCache", true) &&
+			(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary);
+}
+
+std::string __Shader::cacheFile() const
+{
+	// a binary is only valid for the driver that created it
+	std::string driver;
+	const GLubyte* str[3] = { glGetString(GL_VENDOR), glGetString(GL_RENDERER), glGetString(GL_VERSION) };
+	for (int i = 0; i < 3; ++i) {
+		if (str[i])
+			driver.append((const char*)str[i]);
+	}
 
+	return s_cacheFolder + util::hashToString(util::hash(driver, m_hash)) + ".bin";
+}
+
+bool __Shader::loadBinary()
+{
+	if (!useBinaryCache())
+		return false;
+
+	std::ifstream file(cacheFile().c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+		return false;
+
+	char magic[4];
+	uint32_t header[3];
+	file.read(magic, sizeof(magic));
+	file.read((char*)header, sizeof(header));
+	if (!file || memcmp(magic, s_cacheMagic, sizeof(magic)) != 0 ||
+			header[0] != s_cacheVersion || header[2] == 0)
+		return false;
+
+	std::vector<char> binary(header[2]);
+	file.read(&binary[0], binary.size());
+	if (!file)
+		return false;
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, header[1], &binary[0], binary.size());
+
+	// the binary is rejected if the driver has been updated
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE) {
+		glDeleteProgram(program);
+		return false;
+	}
+
+	if (m_programObject) glDeleteProgram(m_programObject);
+	m_programObject = program;
 	return true;
 }
 
+bool __Shader::saveBinary() const
+{
+	GLint length = 0;
+	glGetProgramiv(m_programObject, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return false;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(m_programObject, length, &length, &format, &binary[0]);
+
+	try {
+		boost::filesystem::create_directories(s_cacheFolder);
+	} catch (...) {
+		return false;
+	}
+
+	std::ofstream file(cacheFile().c_str(), std::ios::out | std::ios::binary);
+	if (!file)
+		return false;
+
+	uint32_t header[3] = { s_cacheVersion, (uint32_t)format, (uint32_t)length };
+	file.write(s_cacheMagic, sizeof(s_cacheMagic));
+	file.write((const char*)header, sizeof(header));
+	file.write(&binary[0], length);
+	return file.good();
+}
+
 
 static unsigned long getFileLength(std::ifstream& file)
 {
@@ -108,7 +222,7 @@ static unsigned long getFileLength(std::ifstream& file)
 static GLchar* getFileContent(std::string& fileName)
 {
 	std::ifstream file;
-	file.open(fileName.c_str(), std::ios::in);
+	file.open(fileName.c_str(), std::ios::in | std::ios::binary);
 
 	if (!file)
 		return NULL;
@@ -122,16 +236,9 @@ static GLchar* getFileContent(std::string& fileName)
 	if (source == 0)
 		return NULL;
 
-	source[len] = 0;
-
-	unsigned int i = 0;
-	while (file.good()) {
-		source[i] = file.get();
-		if (!file.eof())
-			i++;
-	}
-
-	source[i] = 0;
+	// read the whole file at once
+	file.read(source, len);
+	source[file.gcount()] = 0;
 
 	file.close();
 
@@ -145,7 +252,10 @@ Shader __Shader::load(std::string vertexFile, std::string fragmentFile)
 	if (!vsrc) return Shader();
 
 	GLchar* fsrc = getFileContent(fragmentFile);
-	if (!fsrc) return Shader();
+	if (!fsrc) {
+		delete[] vsrc;
+		return Shader();
+	}
 
 	return Shader(new __Shader(vsrc, fsrc));
 }
@@ -183,22 +293,38 @@ unsigned ShaderMgr::load(const std::string& folder)
 	using namespace boost::filesystem;
 
 	path p (folder);
-	
-	if(is_directory(p)) {
-		if(!is_empty(p)) {
-			directory_iterator end_itr;
-			for(directory_iterator itr(p); itr != end_itr; ++itr) {
-				if(itr->path().filename().find(".vs") != std::string::npos) {
-					std::string vs = itr->string();
-					std::string fs = vs;
-					fs.replace(vs.size() - 2, 1, "f");
-					Shader shader = __Shader::load(vs, fs);
-					shader->compile();
-					add(basename(*itr), shader);
-				}
-			}
+	if (!is_directory(p) || is_empty(p))
+		return count;
+
+	std::vector<std::pair<std::string, Shader> > shaders;
+	directory_iterator end_itr;
+	for(directory_iterator itr(p); itr != end_itr; ++itr) {
+		if(itr->path().filename().find(".vs") != std::string::npos) {
+			std::string vs = itr->string();
+			std::string fs = vs;
+			fs.replace(vs.size() - 2, 1, "f");
+			Shader shader = __Shader::load(vs, fs);
+			if (shader)
+				shaders.push_back(std::make_pair(basename(*itr), shader));
+			else
+				std::cout << "could not read shader " << vs << std::endl;
+		}
+	}
+
+	// issue all compilations first, so that the driver can work in parallel
+	std::vector<bool> compiled(shaders.size(), false);
+	for (unsigned i = 0; i < shaders.size(); ++i) {
+		if (!shaders[i].second->loadBinary()) {
+			shaders[i].second->beginCompile();
+			compiled[i] = true;
 		}
+	}
 
+	for (unsigned i = 0; i < shaders.size(); ++i) {
+		if (compiled[i] && !shaders[i].second->endCompile())
+			std::cout << "could not compile shader " << shaders[i].first << std::endl;
+		add(shaders[i].first, shaders[i].second);
+		++count;
 	}
 	return count;
 }
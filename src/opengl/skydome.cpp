@@ -49,9 +49,9 @@ void Skydome::load(float radius, const std::string& clouds, const std::string& s
 {
 	clear();
 	m_shader = ShaderMgr::instance().get(shader);
-	m_clouds = TextureMgr::instance().get(clouds)->m_textureID;
+	m_clouds = TextureMgr::instance().get(clouds);
 	m_radius = radius * 0.01f;
-	m_flares = TextureMgr::instance().get(flares)->m_textureID;
+	m_flares = TextureMgr::instance().get(flares);
 
 	Lib3dsFile* model = lib3ds_file_load(fileName.c_str());
 	if(!model)
@@ -95,7 +95,8 @@ void Skydome::clear()
 		glDeleteLists(m_list, 1);
 	m_list = 0;
 	m_shader = Shader();
-	m_clouds = 0;
+	m_clouds = Texture();
+	m_flares = Texture();
 	m_time = 0.0f;
 }
 
@@ -130,7 +131,7 @@ void Skydome::render(const Camera& cam, const Vec3f& light, bool concealed)
 {
 	// skydome
 	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, m_clouds);
+	glBindTexture(GL_TEXTURE_2D, m_clouds ? m_clouds->m_textureID : 0);
 
 	m_shader->bind();
 	m_shader->setUniform1f("time", m_time);
@@ -190,7 +191,7 @@ void Skydome::render(const Camera& cam, const Vec3f& light, bool concealed)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, m_flares);
+	glBindTexture(GL_TEXTURE_2D, m_flares ? m_flares->m_textureID : 0);
 
 	float alpha = 2.0f * m_fadeTime / 10.0f;
 	Vec2f tmp(cam.m_viewport[2] * 0.5f - window[0], cam.m_viewport[3] * 0.5f - (window[1] / alpha));
@@ -8,16 +8,24 @@
 #include "stb_image.hpp"
 #define BOOST_FILESYSTEM_VERSION 2
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
 #include <stdexcept>
 #include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
 #include <util/config.hpp>
+#include <util/hash.hpp>
+#include <util/memory.hpp>
+#include <util/threadpool.hpp>
 
 namespace ogl {
 
 TextureMgr* TextureMgr::s_instance = NULL;
 
 __Texture::__Texture(GLuint textureID, GLuint target)
-	: m_textureID(textureID), m_target(target)
+	: m_textureID(textureID), m_target(target), m_size(0)
 {
 }
 
@@ -27,41 +35,141 @@ __Texture::~__Texture()
 	std::cout << "delete texture" << std::endl;
 #endif
 	if (glIsTexture(m_textureID))
-		glDeleteTextures(0, &m_textureID);
+		glDeleteTextures(1, &m_textureID);
 }
 
 Texture __Texture::load(std::string file, GLuint target)
 {
-	int w, h, c;
-	unsigned char* data = stbi_load(file.c_str(), &w, &h, &c, STBI_rgb_alpha);
+	bool useCache = util::Config::instance().get("textureCache", true);
 
-	if (!data)
+	TextureImage image;
+	if (!image.decode(file, useCompression(), useCache, !canGenerateMipmaps()))
 		return Texture();
 
-    GLuint textureID = 0;
-    glGenTextures(1, &textureID);
-    glBindTexture(target, textureID);
+	Texture result = upload(image, target);
+	if (result && useCache && !image.cached) {
+		boost::filesystem::create_directories(TextureImage::s_cacheFolder);
+		image.writeCache();
+	}
+	return result;
+}
 
-    //glTexImage2D(stage, 0, GL_RGBA, Image.GetWidth(), Image.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, Image.GetPixelsPtr());
-    //gluBuild2DMipmaps(target, GL_RGBA, Image.GetWidth(), Image.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, Image.GetPixelsPtr());
-    gluBuild2DMipmaps(target, GL_RGBA, w, h, GL_RGBA, GL_UNSIGNED_BYTE, data);
+/** @return True, if textures may have arbitrary sizes */
+static bool supportsNPOT()
+{
+	return GLEW_VERSION_2_0 || GLEW_ARB_texture_non_power_of_two;
+}
 
-    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+static bool isPowerOfTwo(int width, int height)
+{
+	return (width & (width - 1)) == 0 && (height & (height - 1)) == 0;
+}
 
-    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+bool __Texture::canGenerateMipmaps()
+{
+	return (GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object || GLEW_EXT_framebuffer_object) &&
+			supportsNPOT();
+}
+
+bool __Texture::useCompression()
+{
+	return util::Config::instance().get("compressTextures", false) &&
+			GLEW_EXT_texture_compression_s3tc && GLEW_ARB_texture_compression;
+}
+
+Texture __Texture::upload(TextureImage& image, GLuint target)
+{
+	if (image.levels.empty())
+		return Texture();
 
-    // enable anisotropic filtering
-    if (util::Config::instance().get("useAF", false) && GLEW_EXT_texture_filter_anisotropic) {
+	// the image may have been decoded before the extensions were known
+	if (image.compressed && !(GLEW_EXT_texture_compression_s3tc && GLEW_ARB_texture_compression))
+		return Texture();
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(target, textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const TextureImage::Level& base = image.levels[0];
+	bool compress = !image.compressed && useCompression();
+	GLenum internalFormat = compress ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA;
+
+	if (image.compressed) {
+		for (unsigned i = 0; i < image.levels.size(); ++i) {
+			const TextureImage::Level& level = image.levels[i];
+			glCompressedTexImage2DARB(target, i, image.format, level.width, level.height, 0,
+					level.data.size(), &level.data[0]);
+		}
+	} else if (image.levels.size() > 1 && (supportsNPOT() || isPowerOfTwo(base.width, base.height))) {
+		// the whole mip chain has been built by a worker
+		for (unsigned i = 0; i < image.levels.size(); ++i) {
+			const TextureImage::Level& level = image.levels[i];
+			glTexImage2D(target, i, internalFormat, level.width, level.height, 0,
+					GL_RGBA, GL_UNSIGNED_BYTE, &level.data[0]);
+		}
+	} else if (canGenerateMipmaps()) {
+		glTexImage2D(target, 0, internalFormat, base.width, base.height, 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, &base.data[0]);
+		if (GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object)
+			glGenerateMipmap(target);
+		else
+			glGenerateMipmapEXT(target);
+	} else {
+		// rescales non-power-of-two images on old hardware
+		gluBuild2DMipmaps(target, internalFormat, base.width, base.height,
+				GL_RGBA, GL_UNSIGNED_BYTE, &base.data[0]);
+	}
+
+	// read back the compressed mip chain, so that it can be cached
+	if (compress) {
+		GLint isCompressed = GL_FALSE;
+		glGetTexLevelParameteriv(target, 0, GL_TEXTURE_COMPRESSED_ARB, &isCompressed);
+		if (isCompressed == GL_TRUE) {
+			std::vector<TextureImage::Level> levels;
+			for (int i = 0; ; ++i) {
+				TextureImage::Level level;
+				GLint size = 0;
+				glGetTexLevelParameteriv(target, i, GL_TEXTURE_WIDTH, &level.width);
+				glGetTexLevelParameteriv(target, i, GL_TEXTURE_HEIGHT, &level.height);
+				if (level.width <= 0 || level.height <= 0)
+					break;
+				glGetTexLevelParameteriv(target, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE_ARB, &size);
+				level.data.resize(size);
+				glGetCompressedTexImageARB(target, i, &level.data[0]);
+				levels.push_back(level);
+				if (level.width == 1 && level.height == 1)
+					break;
+			}
+			image.levels.swap(levels);
+			image.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			image.compressed = true;
+			image.cached = false;
+		}
+	}
+
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_REPEAT);
+	glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// enable anisotropic filtering
+	if (util::Config::instance().get("useAF", false) && GLEW_EXT_texture_filter_anisotropic) {
 		float maxAF;
 		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAF);
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAF);
-    }
+	}
 
-    Texture result(new __Texture(textureID, target));
-    return result;
+	Texture result(new __Texture(textureID, target));
+
+	// the mip chain adds a third of the size of the base level
+	if (image.levels.size() > 1 || image.compressed)
+		result->m_size = image.size();
+	else
+		result->m_size = base.data.size() * 4 / 3;
+	return result;
 }
 
 Texture __Texture::create(GLuint target)
@@ -74,9 +182,192 @@ Texture __Texture::create(GLuint target)
     return result;
 }
 
+const std::string TextureImage::s_cacheFolder = "data/cache/textures/";
+
+/** Identifies texture cache files, followed by the version */
+static const char s_cacheMagic[4] = { 'D', 'T', 'E', 'X' };
+static const uint32_t s_cacheVersion = 1;
+
+TextureImage::TextureImage()
+	: hash(0), format(GL_RGBA), compressed(false), cached(false)
+{
+}
+
+bool TextureImage::decode(const std::string& file, bool compress, bool useCache, bool mipmaps)
+{
+	this->file = file;
+	levels.clear();
+
+	// read the whole file at once, the hash is the cache key
+	std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+	if (!stream)
+		return false;
+	std::vector<unsigned char> content((std::istreambuf_iterator<char>(stream)),
+			std::istreambuf_iterator<char>());
+	stream.close();
+	if (content.empty())
+		return false;
+
+	hash = util::hash(&content[0], content.size());
+
+	if (useCache && ((compress && readCache(true)) || readCache(false)))
+		return true;
+
+	int w, h, c;
+	unsigned char* data = stbi_load_from_memory(&content[0], content.size(), &w, &h, &c, STBI_rgb_alpha);
+	if (!data)
+		return false;
+
+	Level base;
+	base.width = w;
+	base.height = h;
+	base.data.assign(data, data + w * h * 4);
+	stbi_image_free(data);
+
+	format = GL_RGBA;
+	compressed = false;
+	cached = false;
+	levels.push_back(base);
+
+	// a cached image always contains the whole mip chain
+	if (mipmaps || useCache)
+		buildMipmaps();
+	return true;
+}
+
+void TextureImage::buildMipmaps()
+{
+	if (levels.empty() || compressed)
+		return;
+	levels.resize(1);
+
+	while (levels.back().width > 1 || levels.back().height > 1) {
+		const Level& src = levels.back();
+		Level dst;
+		dst.width = std::max(1, src.width / 2);
+		dst.height = std::max(1, src.height / 2);
+		dst.data.resize(dst.width * dst.height * 4);
+
+		// average 2x2 texels, clamp at the border of odd sizes
+		for (int y = 0; y < dst.height; ++y) {
+			int y0 = std::min(y * 2, src.height - 1);
+			int y1 = std::min(y * 2 + 1, src.height - 1);
+			for (int x = 0; x < dst.width; ++x) {
+				int x0 = std::min(x * 2, src.width - 1);
+				int x1 = std::min(x * 2 + 1, src.width - 1);
+				const unsigned char* p00 = &src.data[(y0 * src.width + x0) * 4];
+				const unsigned char* p01 = &src.data[(y0 * src.width + x1) * 4];
+				const unsigned char* p10 = &src.data[(y1 * src.width + x0) * 4];
+				const unsigned char* p11 = &src.data[(y1 * src.width + x1) * 4];
+				unsigned char* out = &dst.data[(y * dst.width + x) * 4];
+				for (int i = 0; i < 4; ++i)
+					out[i] = (p00[i] + p01[i] + p10[i] + p11[i] + 2) / 4;
+			}
+		}
+		levels.push_back(dst);
+	}
+}
+
+std::string TextureImage::cacheFile(bool compressed) const
+{
+	uint64_t key = compressed ? util::hash("DXT5", 4, hash) : hash;
+	return s_cacheFolder + util::hashToString(key) + ".tex";
+}
+
+size_t TextureImage::size() const
+{
+	size_t result = 0;
+	for (unsigned i = 0; i < levels.size(); ++i)
+		result += levels[i].data.size();
+	return result;
+}
+
+bool TextureImage::writeCache() const
+{
+	if (levels.empty())
+		return false;
+
+	// write to a temporary file first, so that no partial files are read
+	std::string fileName = cacheFile(compressed);
+	std::string tmpName = fileName + ".tmp";
+	std::ofstream stream(tmpName.c_str(), std::ios::out | std::ios::binary);
+	if (!stream)
+		return false;
+
+	uint32_t header[4] = { s_cacheVersion, (uint32_t)format, (uint32_t)compressed, (uint32_t)levels.size() };
+	stream.write(s_cacheMagic, sizeof(s_cacheMagic));
+	stream.write((const char*)&hash, sizeof(hash));
+	stream.write((const char*)header, sizeof(header));
+
+	for (unsigned i = 0; i < levels.size(); ++i) {
+		const Level& level = levels[i];
+		uint32_t info[3] = { (uint32_t)level.width, (uint32_t)level.height, (uint32_t)level.data.size() };
+		stream.write((const char*)info, sizeof(info));
+		stream.write((const char*)&level.data[0], level.data.size());
+	}
+	stream.close();
+
+	if (stream.fail()) {
+		boost::filesystem::remove(tmpName);
+		return false;
+	}
+
+	try {
+		boost::filesystem::remove(fileName);
+		boost::filesystem::rename(tmpName, fileName);
+	} catch (...) {
+		std::cout << "could not write texture cache " << fileName << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TextureImage::readCache(bool compressed)
+{
+	std::ifstream stream(cacheFile(compressed).c_str(), std::ios::in | std::ios::binary);
+	if (!stream)
+		return false;
+
+	char magic[4];
+	uint64_t fileHash;
+	uint32_t header[4];
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)&fileHash, sizeof(fileHash));
+	stream.read((char*)header, sizeof(header));
+
+	if (!stream || memcmp(magic, s_cacheMagic, sizeof(magic)) != 0 ||
+			fileHash != hash || header[0] != s_cacheVersion ||
+			(header[2] != 0) != compressed)
+		return false;
+
+	std::vector<Level> result(header[3]);
+	for (unsigned i = 0; i < result.size(); ++i) {
+		uint32_t info[3];
+		stream.read((char*)info, sizeof(info));
+		if (!stream)
+			return false;
+		result[i].width = info[0];
+		result[i].height = info[1];
+		result[i].data.resize(info[2]);
+		stream.read((char*)&result[i].data[0], info[2]);
+	}
+
+	if (!stream || result.empty())
+		return false;
+
+	format = header[1];
+	this->compressed = compressed;
+	cached = true;
+	levels.swap(result);
+	return true;
+}
+
 TextureMgr::TextureMgr()
-	: std::map<std::string, Texture>()
+	: std::map<std::string, Texture>(),
+	  m_time(0),
+	  m_residentSize(0)
 {
+	m_budget = util::Config::instance().get<size_t>("textureBudget", 256) * 1024 * 1024;
 }
 
 TextureMgr::TextureMgr(const TextureMgr& other)
@@ -96,46 +387,206 @@ void TextureMgr::destroy()
 
 Texture TextureMgr::add(const std::string& name, Texture texture)
 {
+	TextureMgr::iterator it = this->find(name);
+	if (it != this->end() && it->second)
+		m_residentSize -= it->second->m_size;
+
 	(*this)[name] = texture;
+	m_lastUse[name] = ++m_time;
+	if (texture)
+		m_residentSize += texture->m_size;
+	util::MemoryStats::instance().set(util::MemoryStats::TEXTURES, m_residentSize);
 	return texture;
 }
 
+unsigned TextureMgr::index(const std::string& folder)
+{
+	unsigned count = 0;
+	using namespace boost::filesystem;
+
+	path p (folder);
+	if (!is_directory(p) || is_empty(p))
+		return count;
+
+	directory_iterator end_itr;
+	for (directory_iterator itr(p); itr != end_itr; ++itr) {
+		if (itr->leaf().size() > 3) {
+			m_files[basename(*itr)] = itr->string();
+			++count;
+		}
+	}
+	return count;
+}
+
 unsigned TextureMgr::load(const std::string& folder)
 {
-	int count = 0;
 	using namespace boost::filesystem;
 
 	path p (folder);
-	
-	if(is_directory(p)) {
-		if(!is_empty(p)) {
-			directory_iterator end_itr;
-			for(directory_iterator itr(p); itr != end_itr; ++itr) {
-				if(itr->leaf().size() > 3) {
-					Texture texture = __Texture::load(itr->string(), GL_TEXTURE_2D);
-					add(basename(*itr), texture);
-				}
-			}
+	if (!is_directory(p) || is_empty(p))
+		return 0;
+
+	std::set<std::string> names;
+	directory_iterator end_itr;
+	for (directory_iterator itr(p); itr != end_itr; ++itr) {
+		if (itr->leaf().size() > 3) {
+			m_files[basename(*itr)] = itr->string();
+			names.insert(basename(*itr));
 		}
+	}
+
+	decode(names);
+	return upload();
+}
 
+unsigned TextureMgr::prefetch(const std::set<std::string>& names)
+{
+	decode(names);
+	return upload();
+}
+
+unsigned TextureMgr::decode(const std::set<std::string>& names)
+{
+	std::vector<std::pair<std::string, std::string> > files;
+	std::set<std::string>::const_iterator itr = names.begin();
+	for ( ; itr != names.end(); ++itr) {
+		std::map<std::string, std::string>::iterator file = m_files.find(*itr);
+		if (file != m_files.end() && this->find(*itr) == this->end())
+			files.push_back(*file);
 	}
-	// open folder
-	// iterate over the folder
-	// find *.[a-zA-Z] files
-	// load with Texture Manager
-	// close folder
+	if (files.empty())
+		return 0;
+
+	bool useCache = util::Config::instance().get("textureCache", true);
+	bool compress = __Texture::useCompression();
+	bool mipmaps = !__Texture::canGenerateMipmaps();
+
+	// decode all images in parallel, the pool waits for the workers
+	std::vector<TextureImage> images(files.size());
+	{
+		util::ThreadPool pool;
+		for (unsigned i = 0; i < files.size(); ++i)
+			pool.schedule(boost::bind(&TextureImage::decode, &images[i],
+					files[i].second, compress, useCache, mipmaps));
+	}
+
+	unsigned count = 0;
+	boost::mutex::scoped_lock lock(m_pendingMutex);
+	for (unsigned i = 0; i < images.size(); ++i) {
+		if (images[i].levels.empty()) {
+			std::cout << "could not load texture " << files[i].second << std::endl;
+			continue;
+		}
+		m_pending.push_back(std::make_pair(files[i].first, TextureImage()));
+		std::swap(m_pending.back().second, images[i]);
+		++count;
+	}
+	return count;
+}
+
+unsigned TextureMgr::upload()
+{
+	std::vector<std::pair<std::string, TextureImage> > pending;
+	{
+		boost::mutex::scoped_lock lock(m_pendingMutex);
+		pending.swap(m_pending);
+	}
+
+	unsigned count = 0;
+	if (pending.empty())
+		return count;
+
+	bool useCache = util::Config::instance().get("textureCache", true);
+
+	std::vector<TextureImage*> uncached;
+	for (unsigned i = 0; i < pending.size(); ++i) {
+		TextureImage& image = pending[i].second;
+		Texture texture = __Texture::upload(image, GL_TEXTURE_2D);
+		if (!texture) {
+			std::cout << "could not upload texture " << image.file << std::endl;
+			continue;
+		}
+		add(pending[i].first, texture);
+		++count;
+
+		if (useCache && !image.cached)
+			uncached.push_back(&image);
+		else
+			std::vector<TextureImage::Level>().swap(image.levels);
+	}
+
+	// store the new images in the cache
+	if (!uncached.empty()) {
+		boost::filesystem::create_directories(TextureImage::s_cacheFolder);
+		util::ThreadPool pool;
+		for (unsigned i = 0; i < uncached.size(); ++i)
+			pool.schedule(boost::bind(&TextureImage::writeCache, uncached[i]));
+	}
+
+	evict();
 	return count;
 }
 
+void TextureMgr::evict()
+{
+	while (m_residentSize > m_budget) {
+		// find the least recently used texture that is only held by us
+		TextureMgr::iterator lru = this->end();
+		unsigned long lruTime = 0;
+		for (TextureMgr::iterator it = this->begin(); it != this->end(); ++it) {
+			if (!it->second || it->second.use_count() > 1)
+				continue;
+			unsigned long time = m_lastUse[it->first];
+			if (lru == this->end() || time < lruTime) {
+				lru = it;
+				lruTime = time;
+			}
+		}
+
+		if (lru == this->end())
+			break;
+
+#ifdef _DEBUG
+		std::cout << "unload texture " << lru->first << std::endl;
+#endif
+		m_residentSize -= lru->second->m_size;
+		m_lastUse.erase(lru->first);
+		this->erase(lru);
+	}
+	util::MemoryStats::instance().set(util::MemoryStats::TEXTURES, m_residentSize);
+}
+
+void TextureMgr::setBudget(size_t bytes)
+{
+	m_budget = bytes;
+	evict();
+}
+
 Texture TextureMgr::get(const std::string& name)
 {
 	TextureMgr::iterator it = this->find(name);
-	if (it == this->end()) {
+	if (it != this->end()) {
+		m_lastUse[name] = ++m_time;
+		return it->second;
+	}
+
+	// load the texture on first use
+	std::map<std::string, std::string>::iterator file = m_files.find(name);
+	if (file == m_files.end()) {
 		Texture result;
 		return result;
 	}
-	return it->second;
 
+	Texture result = __Texture::load(file->second, GL_TEXTURE_2D);
+	if (!result) {
+		// do not try to load it again
+		m_files.erase(file);
+		return result;
+	}
+
+	add(name, result);
+	evict();
+	return result;
 }
 
 }
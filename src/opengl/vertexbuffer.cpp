@@ -5,6 +5,7 @@
  */
 
 #include <opengl/vertexbuffer.hpp>
+#include <util/memory.hpp>
 
 namespace ogl {
 
@@ -12,13 +13,17 @@ VertexBuffer::VertexBuffer()
 	: m_format(GL_T2F_N3F_V3F),
 	  m_ibo(0), m_vbo(0),
 	  m_vboSize(0), m_vboUsedSize(0),
-	  m_iboSize(0), m_iboUsedSize(0)
+	  m_iboSize(0), m_iboUsedSize(0),
+	  m_accountedData(0), m_accountedBuffers(0)
 {
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	flush();
+
+	// the vectors keep their capacity until they are destroyed
+	util::MemoryStats::instance().add(util::MemoryStats::VERTEX_DATA, -(long)m_accountedData);
 }
 
 void VertexBuffer::bind(bool setup)
@@ -108,8 +113,11 @@ void VertexBuffer::upload()
 	} else if (m_ibo != 0) {
 		glDeleteBuffers(1, &m_ibo);
 		m_ibo = 0;
+		m_iboSize = m_iboUsedSize = 0;
 	}
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	account();
 }
 
 void VertexBuffer::flush() {
@@ -132,6 +140,22 @@ void VertexBuffer::flush() {
 		glDeleteBuffers(1, &m_ibo);
 		m_ibo = m_iboSize = m_iboUsedSize = 0;
 	}
+
+	account();
+}
+
+void VertexBuffer::account()
+{
+	using util::MemoryStats;
+
+	// the capacity is what is actually allocated
+	size_t data = m_data.capacity() * sizeof(float) + m_indices.capacity() * sizeof(GLuint);
+	size_t buffers = m_vboSize + m_iboSize;
+
+	MemoryStats::instance().add(MemoryStats::VERTEX_DATA, (long)data - (long)m_accountedData);
+	MemoryStats::instance().add(MemoryStats::GPU_BUFFERS, (long)buffers - (long)m_accountedBuffers);
+	m_accountedData = data;
+	m_accountedBuffers = buffers;
 }
 
 }
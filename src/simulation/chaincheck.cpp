@@ -0,0 +1,372 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/chaincheck.cpp
+ */
+
+#include <simulation/chaincheck.hpp>
+#include <simulation/material.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <map>
+
+namespace sim {
+
+/** A domino with a lower up vector is tilted, i.e. the start of a wave */
+static const float TILTED_COS = 0.99f;
+
+/** Neighbors further away than this factor of the height are not linked */
+static const float SEARCH_FACTOR = 1.25f;
+
+/**
+ * The falling domino may hit the next one this factor of its height
+ * above the ground, above it slides over the top edge
+ */
+static const float STEP_DOWN_FACTOR = 1.5f;
+
+/** The relative steps of the gaps tried by ChainChecker::getGap() */
+static const float GAP_STEP = 0.05f;
+static const int GAP_STEPS = 10;
+
+static const char* LinkReasonStr[] = {
+	"reach", "close", "step_up", "step_down", "slide", "offset", "angle"
+};
+
+/** @return The front vector of the matrix on the xz-plane */
+static Vec3f getFront(const Mat4f& matrix)
+{
+	Vec3f front = matrix.getZ();
+	front.y = 0.0f;
+	return front.normalized();
+}
+
+ChainChecker::ChainChecker()
+{
+	util::Config& config = util::Config::instance();
+	m_weakMargin = config.get("chainWeakMargin", 0.15f);
+	m_minOverlap = config.get("chainMinOverlap", 0.3f);
+	m_maxAngleCos = cos(config.get("chainMaxAngle", 35.0f) * PI / 180.0f);
+	m_groundMaterial = config.get<std::string>("chainGroundMaterial", "stone");
+	reset();
+}
+
+void ChainChecker::reset()
+{
+	m_checked = false;
+	m_dominoes.clear();
+	m_indices.clear();
+	m_links.clear();
+	m_status.clear();
+	m_chains = 0;
+}
+
+float ChainChecker::getFriction(const std::string& material) const
+{
+	MaterialMgr& mgr = MaterialMgr::instance();
+	return mgr.getPair(mgr.getID(material), mgr.getID(m_groundMaterial)).staticFriction;
+}
+
+LinkPrediction ChainChecker::predict(const Vec3f& sizeA, const Mat4f& a, const Vec3f& sizeB,
+		const Mat4f& b, float friction) const
+{
+	// the falling domino turns around its front edge towards b
+	Vec3f delta = b.getW() - a.getW();
+	const float dy = delta.y - (sizeB.y - sizeA.y) * 0.5f;
+	delta.y = 0.0f;
+
+	Vec3f fall = getFront(a);
+	float forward = fall * delta;
+	if (forward < 0.0f) {
+		fall = -fall;
+		forward = -forward;
+	}
+	const float lateral = (delta - fall * forward).len();
+	const float angleCos = fabs(fall * getFront(b));
+
+	// the clear distance between the faces and the contact height on b
+	const float clear = forward - (sizeA.z + sizeB.z * angleCos) * 0.5f;
+	const float contact = sqrt(std::max(sizeA.y * sizeA.y - clear * clear, 0.0f)) - dy;
+	const float slide = sizeB.z / (2.0f * std::max(friction, 0.01f));
+
+	float margins[7];
+	margins[LINK_REACH] = 1.0f - clear / sizeA.y;
+	margins[LINK_CLOSE] = clear / sizeA.z;
+	margins[LINK_STEP_UP] = contact / sizeB.y;
+	margins[LINK_STEP_DOWN] = (STEP_DOWN_FACTOR * sizeB.y - contact) / ((STEP_DOWN_FACTOR - 1.0f) * sizeB.y);
+	margins[LINK_SLIDE] = (contact - slide) / sizeB.y;
+	margins[LINK_OFFSET] = (1.0f - lateral / ((sizeA.x + sizeB.x) * 0.5f) - m_minOverlap) / (1.0f - m_minOverlap);
+	margins[LINK_ANGLE] = (angleCos - m_maxAngleCos) / (1.0f - m_maxAngleCos);
+
+	// a domino that is hit below its base is never hit at all
+	if (contact <= 0.0f)
+		margins[LINK_SLIDE] = 1.0f;
+
+	LinkPrediction result;
+	result.reason = LINK_REACH;
+	for (int i = 1; i < 7; ++i)
+		if (margins[i] < margins[result.reason])
+			result.reason = (LinkReason)i;
+	result.margin = margins[result.reason];
+	result.status = result.margin < 0.0f ? LINK_FAIL : result.margin < m_weakMargin ? LINK_WEAK : LINK_OK;
+	return result;
+}
+
+float ChainChecker::getGap(__Object::Type type, float gap, float curvature, float slope, float friction) const
+{
+	const Vec3f size = __Domino::s_domino_size[std::min(type, __Object::DOMINO_LARGE)];
+
+	// try the nominal gap first, then alternately shorter and longer ones
+	float best = gap, bestMargin = -1e10f;
+	for (int i = 0; i <= GAP_STEPS * 2; ++i) {
+		const int step = (i + 1) / 2 * (i % 2 ? -1 : 1);
+		const float g = gap * (1.0f + step * GAP_STEP);
+
+		// the next domino on a circle through both, turned by the angle of the arc
+		const float angle = g * curvature;
+		const Mat4f a(Vec3f::yAxis(), Vec3f::zAxis(), Vec3f());
+		const Vec3f pos(g * sin(angle * 0.5f), g * slope, g * cos(angle * 0.5f));
+		const Mat4f b(Vec3f::yAxis(), Vec3f(sin(angle), 0.0f, cos(angle)), pos);
+
+		const LinkPrediction prediction = predict(size, a, size, b, friction);
+		if (prediction.status == LINK_OK)
+			return g;
+		if (prediction.margin > bestMargin) {
+			bestMargin = prediction.margin;
+			best = g;
+		}
+	}
+	return best;
+}
+
+void ChainChecker::getSpacing(__Object::Type type, const std::string& material, float gap,
+		const std::vector<Vec3f>& points, std::vector<float>& result) const
+{
+	result.clear();
+	if (points.empty())
+		return;
+
+	const float friction = getFriction(material);
+
+	// the gap from each point to the next
+	std::vector<float> gaps(points.size(), gap);
+	for (unsigned i = 0; i + 1 < points.size(); ++i) {
+		Vec3f dir = points[i + 1] - points[i];
+		const float slope = dir.y / gap;
+		dir.y = 0.0f;
+
+		float curvature = 0.0f;
+		if (i > 0) {
+			Vec3f prev = points[i] - points[i - 1];
+			prev.y = 0.0f;
+			const float cosAngle = std::min(std::max(prev.normalized() * dir.normalized(), -1.0f), 1.0f);
+			curvature = acos(cosAngle) / gap;
+		}
+		gaps[i] = getGap(type, gap, curvature, slope, friction);
+	}
+
+	const float length = (points.size() - 1) * gap;
+	for (float t = 0.0f; t <= length + gap * 0.01f; ) {
+		result.push_back(t);
+		t += gaps[std::min((unsigned)(t / gap + 0.5f), (unsigned)gaps.size() - 1)];
+	}
+}
+
+void ChainChecker::findNeighbors(std::vector<std::vector<unsigned> >& neighbors) const
+{
+	typedef boost::unordered_map<std::pair<int, int>, std::vector<unsigned> > Grid;
+
+	// the cells are as large as the largest search radius
+	const float cellSize = __Domino::s_domino_size[__Object::DOMINO_LARGE].y * SEARCH_FACTOR;
+	Grid grid;
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		const Vec3f& pos = m_dominoes[i].matrix.getW();
+		grid[std::make_pair((int)floor(pos.x / cellSize), (int)floor(pos.z / cellSize))].push_back(i);
+	}
+
+	neighbors.assign(m_dominoes.size(), std::vector<unsigned>());
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		const DominoInfo& info = m_dominoes[i];
+		const Vec3f pos = info.matrix.getW();
+		const Vec3f front = getFront(info.matrix);
+		const float radius = info.size.y * SEARCH_FACTOR;
+
+		// the nearest domino in the way, in front and behind
+		int nearest[2] = { -1, -1 };
+		float distance[2] = { radius, radius };
+		const int cx = (int)floor(pos.x / cellSize), cz = (int)floor(pos.z / cellSize);
+		for (int x = cx - 1; x <= cx + 1; ++x) {
+			for (int z = cz - 1; z <= cz + 1; ++z) {
+				Grid::const_iterator cell = grid.find(std::make_pair(x, z));
+				if (cell == grid.end())
+					continue;
+				for (std::vector<unsigned>::const_iterator j = cell->second.begin(); j != cell->second.end(); ++j) {
+					if (*j == i)
+						continue;
+					Vec3f delta = m_dominoes[*j].matrix.getW() - pos;
+					delta.y = 0.0f;
+					const float forward = front * delta;
+					const float lateral = (delta - front * forward).len();
+					const int side = forward < 0.0f ? 1 : 0;
+					if (lateral < (info.size.x + m_dominoes[*j].size.x) * 0.5f && fabs(forward) < distance[side]) {
+						distance[side] = fabs(forward);
+						nearest[side] = *j;
+					}
+				}
+			}
+		}
+
+		for (int side = 0; side < 2; ++side) {
+			if (nearest[side] < 0)
+				continue;
+			const unsigned j = nearest[side];
+			if (std::find(neighbors[i].begin(), neighbors[i].end(), j) == neighbors[i].end()) {
+				neighbors[i].push_back(j);
+				neighbors[j].push_back(i);
+			}
+		}
+	}
+}
+
+void ChainChecker::link(const std::vector<std::vector<unsigned> >& neighbors)
+{
+	std::vector<bool> visited(m_dominoes.size(), false);
+	std::deque<unsigned> queue;
+
+	// the waves from the tilted dominoes
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		if (m_dominoes[i].tilted && !neighbors[i].empty()) {
+			visited[i] = true;
+			queue.push_back(i);
+		}
+	}
+
+	for (unsigned next = 0; ; ) {
+		while (!queue.empty()) {
+			const unsigned from = queue.front();
+			queue.pop_front();
+			const DominoInfo& a = m_dominoes[from];
+			for (std::vector<unsigned>::const_iterator itr = neighbors[from].begin(); itr != neighbors[from].end(); ++itr) {
+				if (visited[*itr])
+					continue;
+				visited[*itr] = true;
+				queue.push_back(*itr);
+
+				const DominoInfo& b = m_dominoes[*itr];
+				ChainLink link;
+				link.from = from;
+				link.to = *itr;
+				link.prediction = predict(a.size, a.matrix, b.size, b.matrix, b.friction);
+				m_status[link.to] = std::max(m_status[link.to], link.prediction.status);
+				m_links.push_back(link);
+			}
+		}
+
+		// the next chain without a tilted domino starts at its first end
+		while (next < m_dominoes.size() && (visited[next] || neighbors[next].empty()))
+			next++;
+		if (next == m_dominoes.size())
+			break;
+
+		std::vector<unsigned> component(1, next);
+		visited[next] = true;
+		unsigned start = next;
+		for (unsigned i = 0; i < component.size(); ++i) {
+			const unsigned current = component[i];
+			if (neighbors[current].size() == 1 && (neighbors[start].size() != 1 || current < start))
+				start = current;
+			for (std::vector<unsigned>::const_iterator itr = neighbors[current].begin(); itr != neighbors[current].end(); ++itr) {
+				if (!visited[*itr]) {
+					visited[*itr] = true;
+					component.push_back(*itr);
+				}
+			}
+		}
+		for (std::vector<unsigned>::const_iterator itr = component.begin(); itr != component.end(); ++itr)
+			visited[*itr] = *itr == start;
+		queue.push_back(start);
+		m_chains++;
+	}
+}
+
+void ChainChecker::check(const std::vector<const __Object*>& objects)
+{
+	reset();
+
+	std::map<std::string, float> frictions;
+	for (std::vector<const __Object*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		const __Domino* domino = dynamic_cast<const __Domino*>(*itr);
+		if (!domino)
+			continue;
+
+		__Domino* object = const_cast<__Domino*>(domino);
+		const std::string material = object->getMaterial();
+		std::map<std::string, float>::iterator friction = frictions.find(material);
+		if (friction == frictions.end())
+			friction = frictions.insert(std::make_pair(material, getFriction(material))).first;
+
+		DominoInfo info;
+		info.domino = domino;
+		info.matrix = domino->getMatrix();
+		info.size = __Domino::s_domino_size[std::min(object->getType(), __Object::DOMINO_LARGE)];
+		info.friction = friction->second;
+		info.tilted = info.matrix.getY().y < TILTED_COS;
+		m_indices[domino] = m_dominoes.size();
+		m_dominoes.push_back(info);
+	}
+
+	// the tilted dominoes are the starts of their chains
+	m_status.assign(m_dominoes.size(), LINK_OK);
+	std::vector<std::vector<unsigned> > neighbors;
+	findNeighbors(neighbors);
+	for (unsigned i = 0; i < m_dominoes.size(); ++i)
+		if (m_dominoes[i].tilted && !neighbors[i].empty())
+			m_chains++;
+	link(neighbors);
+	m_checked = true;
+}
+
+bool ChainChecker::getColor(const __Object* object, Vec4f& color) const
+{
+	boost::unordered_map<const __Object*, unsigned>::const_iterator itr = m_indices.find(object);
+	if (itr == m_indices.end() || m_status[itr->second] == LINK_OK)
+		return false;
+
+	if (m_status[itr->second] == LINK_FAIL)
+		color = Vec4f(1.0f, 0.0f, 0.0f, 1.0f);
+	else
+		color = Vec4f(1.0f, 0.8f, 0.0f, 1.0f);
+	return true;
+}
+
+ChainSummary ChainChecker::getSummary() const
+{
+	ChainSummary summary;
+	summary.dominoes = m_dominoes.size();
+	summary.chains = m_chains;
+	summary.links = m_links.size();
+	summary.weak = summary.failing = 0;
+	for (std::vector<ChainLink>::const_iterator itr = m_links.begin(); itr != m_links.end(); ++itr) {
+		if (itr->prediction.status == LINK_WEAK)
+			summary.weak++;
+		else if (itr->prediction.status == LINK_FAIL)
+			summary.failing++;
+	}
+	return summary;
+}
+
+void ChainChecker::writeLinks(std::ostream& out) const
+{
+	out << "from,to,x,y,z,status,reason,margin" << std::endl;
+	for (std::vector<ChainLink>::const_iterator itr = m_links.begin(); itr != m_links.end(); ++itr) {
+		if (itr->prediction.status == LINK_OK)
+			continue;
+		const Vec3f pos = m_dominoes[itr->to].matrix.getW();
+		out << m_dominoes[itr->from].domino->getID() << "," << m_dominoes[itr->to].domino->getID() << ","
+			<< pos.x << "," << pos.y << "," << pos.z << ","
+			<< (itr->prediction.status == LINK_FAIL ? "fail" : "weak") << ","
+			<< LinkReasonStr[itr->prediction.reason] << "," << itr->prediction.margin << std::endl;
+	}
+}
+
+}
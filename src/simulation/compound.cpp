@@ -61,25 +61,24 @@ void __Compound::getAABB(Vec3f& min, Vec3f& max)
 	}
 }
 
-float __Compound::convexCastPlacement(bool apply, std::list<NewtonBody*>* noCollision)
+float __Compound::convexCastPlacement(bool apply, const newton::BodySet* noCollision)
 {
-	std::list<NewtonBody*> temp;
-	for (std::list<Object>::iterator itr = m_nodes.begin(); itr != m_nodes.end(); ++itr) {
-		temp.push_back(((__RigidBody*)itr->get())->m_body);
-	}
-	float maximum = -1000.0f;
-	for (std::list<Object>::iterator itr = m_nodes.begin(); itr != m_nodes.end(); ++itr) {
-		float current = (*itr)->convexCastPlacement(false, &temp);
-		current += (m_matrix._42 - (*itr)->getMatrix()._42);
-		if (current > maximum) maximum = current;
-	}
+	// all nodes are cast at once
+	std::vector<NewtonBody*> bodies;
+	getBodies(bodies);
 	Mat4f matrix = m_matrix;
-	matrix._42 = maximum + 0.0001f;
+	matrix._42 += newton::getConvexCastOffset(bodies, noCollision) + 0.0001f;
 	if (apply)
 		setMatrix(matrix);
 	return matrix._42;
 }
 
+void __Compound::getBodies(std::vector<NewtonBody*>& bodies)
+{
+	for (std::list<Object>::iterator itr = m_nodes.begin(); itr != m_nodes.end(); ++itr)
+		(*itr)->getBodies(bodies);
+}
+
 void __Compound::save(__Compound& compound, rapidxml::xml_node<>* node, rapidxml::xml_document<>* doc)
 {
 	// foreach child_node
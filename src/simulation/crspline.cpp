@@ -7,6 +7,7 @@
 #include <simulation/crspline.hpp>
 #include <GL/glew.h>
 #include <newton/util.hpp>
+#include <algorithm>
 
 namespace sim {
 
@@ -50,6 +51,13 @@ static inline float lerp(float a, float a0, float a1, float t0, float t1) {
 }
 
 
+/**
+ * The number of help points a sweep steps over before it falls back
+ * to a binary search
+ */
+static const unsigned SWEEP_STEPS = 8;
+
+
 CRSpline::CRSpline(float error)
 	: m_error(error)
 {
@@ -59,7 +67,7 @@ CRSpline::~CRSpline()
 {
 }
 
-unsigned CRSpline::binarySearch(float length)
+unsigned CRSpline::binarySearch(float length) const
 {
 	unsigned upper = m_table.size();
 	unsigned lower = 0;
@@ -75,64 +83,138 @@ unsigned CRSpline::binarySearch(float length)
 	return lower;
 }
 
-float CRSpline::getT(float length)
+CRSpline::Sweep::Sweep(const CRSpline& spline)
+	: m_spline(spline),
+	  m_lower(0)
 {
-	// check if the length is out of bounds
-    if (length <= m_table.front().len)
-    	return m_table.front().t;
-    else if (length >= m_table.back().len)
-    	return m_table.back().t;
-
-    unsigned lower = binarySearch(length);
+}
 
-    return lerp(length, m_table[lower].len, m_table[lower + 1].len,
-    		m_table[lower].t, m_table[lower + 1].t);
+void CRSpline::Sweep::seek(float length)
+{
+	const HelpTable& table = m_spline.m_table;
+	if (length < table[m_lower].len) {
+		m_lower = m_spline.binarySearch(length);
+		return;
+	}
 
+	// step to the next help points, or search the rest of the table
+	for (unsigned i = 0; i < SWEEP_STEPS; ++i) {
+		if (m_lower + 2 >= table.size() || length < table[m_lower + 1].len)
+			return;
+		m_lower++;
+	}
+	m_lower = m_spline.binarySearch(length);
 }
 
-Vec3f CRSpline::getPos(float length)
+Vec2f CRSpline::Sweep::getPlanarPos(float length)
 {
-	float x = 0.0f;
-	float z = 0.0f;
-
-	if (length <= m_table.front().len) {
-		x = m_table.front().pos.x;
-		z = m_table.front().pos.y;
-	} else if (length >= m_table.back().len) {
-		x = m_table.back().pos.x;
-		z = m_table.back().pos.y;
-	} else {
-		// perform a linear interpolation between the two nearest help points
-		unsigned lower = binarySearch(length);
+	const HelpTable& table = m_spline.m_table;
 
-		x = lerp(length, m_table[lower].len, m_table[lower + 1].len,
-				m_table[lower].pos.x, m_table[lower +1].pos.x);
+	// check if the length is out of bounds
+	if (length <= table.front().len)
+		return table.front().pos;
+	else if (length >= table.back().len)
+		return table.back().pos;
+
+	// perform a linear interpolation between the two nearest help points
+	seek(length);
+	const HelpPoint& lower = table[m_lower];
+	const HelpPoint& upper = table[m_lower + 1];
+	return Vec2f(lerp(length, lower.len, upper.len, lower.pos.x, upper.pos.x),
+			lerp(length, lower.len, upper.len, lower.pos.y, upper.pos.y));
+}
 
-		z = lerp(length, m_table[lower].len, m_table[lower + 1].len,
-				m_table[lower].pos.y, m_table[lower + 1].pos.y);
-	}
+Vec3f CRSpline::Sweep::getTangent(float length)
+{
+	const HelpTable& table = m_spline.m_table;
 
-	return Vec3f(x, newton::getVerticalPosition(x, z), z);
+	// check if the length is out of bounds
+	if (length <= table.front().len)
+		return table.front().tangent.xz3(0.0f);
+	else if (length >= table.back().len)
+		return table.back().tangent.xz3(0.0f);
+
+	// perform a linear interpolation between the two nearest help points
+	seek(length);
+	const HelpPoint& lower = table[m_lower];
+	const HelpPoint& upper = table[m_lower + 1];
+	return Vec3f(lerp(length, lower.len, upper.len, lower.tangent.x, upper.tangent.x), 0.0f,
+			lerp(length, lower.len, upper.len, lower.tangent.y, upper.tangent.y));
 }
 
-Vec3f CRSpline::getTangent(float length)
+float CRSpline::getKnotLength(unsigned knot) const
+{
+	if (m_table.empty())
+		return 0.0f;
+	if (knot >= m_segments.size())
+		return m_table.back().len;
+	return m_table[m_segments[knot]].len;
+}
+
+float CRSpline::getT(float length)
 {
 	// check if the length is out of bounds
-    if (length <= m_table.front().len)
-    	return m_table.front().tangent.xz3(0.0f);
-    else if (length >= m_table.back().len)
-    	return m_table.back().tangent.xz3(0.0f);
+	float t;
+    if (length <= m_table.front().len) {
+    	t = m_table.front().t;
+    } else if (length >= m_table.back().len) {
+    	t = m_table.back().t;
+    } else {
+    	unsigned lower = binarySearch(length);
+    	t = lerp(length, m_table[lower].len, m_table[lower + 1].len,
+    			m_table[lower].t, m_table[lower + 1].t);
+    }
 
-    // perform a linear interpolation between the two nearest help points
-    unsigned lower = binarySearch(length);
+    // the table stores the parameter of the knots
+    return t / m_segments.size();
+}
+
+Vec2f CRSpline::getPlanarPos(float length)
+{
+	return Sweep(*this).getPlanarPos(length);
+}
+
+Vec3f CRSpline::getPos(float length)
+{
+	Vec2f p = getPlanarPos(length);
+	return p.xz3(newton::getVerticalPosition(p.x, p.y));
+}
 
-    float x = lerp(length, m_table[lower].len, m_table[lower + 1].len,
-			m_table[lower].tangent.x, m_table[lower + 1].tangent.x);
+void CRSpline::getPositions(float gap, std::vector<Vec3f>& result, newton::HeightFilter filter)
+{
+	result.clear();
+	if (m_table.empty())
+		return;
+
+	std::vector<float> lengths;
+	for (float t = 0.0f; t < m_table.back().len; t += gap)
+		lengths.push_back(t);
+	getPositions(lengths, result, filter);
+}
 
-	float z = lerp(length, m_table[lower].len, m_table[lower + 1].len,
-			m_table[lower].tangent.y, m_table[lower + 1].tangent.y);
+void CRSpline::getPositions(const std::vector<float>& lengths, std::vector<Vec3f>& result, newton::HeightFilter filter)
+{
+	result.clear();
+	if (m_table.empty())
+		return;
+
+	Sweep sweep(*this);
+	std::vector<Vec2f> points;
+	points.reserve(lengths.size());
+	for (std::vector<float>::const_iterator itr = lengths.begin(); itr != lengths.end(); ++itr)
+		points.push_back(sweep.getPlanarPos(*itr));
+
+	std::vector<float> heights;
+	newton::getVerticalPositions(points, heights, filter);
+
+	result.reserve(points.size());
+	for (unsigned i = 0; i < points.size(); ++i)
+		result.push_back(points[i].xz3(heights[i]));
+}
 
-    return Vec3f(x, 0.0f, z);
+Vec3f CRSpline::getTangent(float length)
+{
+	return Sweep(*this).getTangent(length);
 }
 
 std::pair<Vec3f, Vec3f> CRSpline::getPoint(float length)
@@ -142,52 +224,68 @@ std::pair<Vec3f, Vec3f> CRSpline::getPoint(float length)
 
 float CRSpline::update()
 {
-	m_table.clear();
-	if (m_knots.size() < 3)
+	if (m_knots.size() < 3) {
+		m_table.clear();
+		m_segments.clear();
+		m_tableKnots.clear();
 		return 0.0f;
+	}
 
-    // add the first help point to the temporary help list
-    HelpPoint helpPoint;
-    helpPoint.t = helpPoint.len = 0.0f;
-    helpPoint.pos = interpolate(m_knots[0], m_knots[0], m_knots[1], m_knots[2], 0.0f);
-    helpPoint.tangent = derive(m_knots[0], m_knots[0], m_knots[1], m_knots[2], 0.0f);
-
-    HelpList helpList;
-    helpList.push_back(helpPoint);
-
-    HelpList::iterator curPoint;
-    curPoint = helpList.begin();
-
-    // for each knot (except the last), insert the knot as a help point
-    for (unsigned i = 0; i < m_knots.size() - 1; ++i) {
-    	// construct the new help point at the end of the current knot
-        helpPoint.t = (float)(i + 1);
-        helpPoint.pos = interpolate(at(i-1), at(i), at(i+1), at(i+2), 1.0f);
-        helpPoint.tangent = derive(at(i-1), at(i), at(i+1), at(i+2), 1.0f);
-        helpPoint.len = (helpPoint.pos - curPoint->pos).len() + helpList.back().len;
-        helpList.push_back(helpPoint);
-
-		// recursively subdivide the segments
-        curPoint = divideSegment(helpList, curPoint, i);
-    }
+	// find the first knot that changed since the last update
+	unsigned changed = 0;
+	const unsigned count = std::min(m_knots.size(), m_tableKnots.size());
+	while (changed < count && m_knots[changed] == m_tableKnots[changed])
+		changed++;
+	if (changed == m_knots.size() && changed == m_tableKnots.size())
+		return m_table.back().len;
+
+	// the segment i depends on the knots i - 1 to i + 2, keep the
+	// help points of the segments before the first one that changed
+	const unsigned first = std::min(changed < 2 ? 0 : changed - 2, (unsigned)m_segments.size());
+	if (first == 0) {
+		m_table.clear();
+
+		// add the first help point
+		HelpPoint helpPoint;
+		helpPoint.t = helpPoint.len = 0.0f;
+		helpPoint.pos = interpolate(m_knots[0], m_knots[0], m_knots[1], m_knots[2], 0.0f);
+		helpPoint.tangent = derive(m_knots[0], m_knots[0], m_knots[1], m_knots[2], 0.0f);
+		m_table.push_back(helpPoint);
+	} else {
+		m_table.resize(m_segments[first] + 1);
+	}
+	m_segments.resize(first);
 
-    // add the list of help point to the table
-    float param = 1.0f / helpList.back().t;
-    for (curPoint = helpList.begin(); curPoint != helpList.end(); ++curPoint) {
-        m_table.push_back(*curPoint);
-        m_table.back().t *= param;
-    }
+	// for each knot (except the last), add the help points of its segment
+	for (unsigned i = first; i < m_knots.size() - 1; ++i) {
+		m_segments.push_back(m_table.size() - 1);
+		appendSegment(i);
+	}
 
-    return (m_table.size() > 0) ? m_table.back().len : 0.0f;
+	m_tableKnots = m_knots;
+	return m_table.back().len;
 }
 
-CRSpline::HelpList::iterator CRSpline::divideSegment(HelpList &helpPoints, HelpList::iterator cur, unsigned knot)
+void CRSpline::appendSegment(unsigned knot)
 {
-    HelpList::iterator next = cur; ++next;
+	// construct the help point at the end of the segment
+	HelpPoint next;
+	next.t = (float)(knot + 1);
+	next.pos = interpolate(at(knot - 1), at(knot), at(knot + 1), at(knot + 2), 1.0f);
+	next.tangent = derive(at(knot - 1), at(knot), at(knot + 1), at(knot + 2), 1.0f);
+
+	// recursively subdivide the segment
+	divideSegment(m_table.back(), next, knot);
 
+	next.len = m_table.back().len + (next.pos - m_table.back().pos).len();
+	m_table.push_back(next);
+}
+
+void CRSpline::divideSegment(HelpPoint cur, HelpPoint next, unsigned knot)
+{
     // construct a new help point between the current and the next point
     HelpPoint middle;
-    middle.t = (cur->t + next->t) * 0.5f;
+    middle.t = (cur.t + next.t) * 0.5f;
     middle.pos = interpolate(at(knot - 1), at(knot), at(knot + 1), at(knot + 2), middle.t - (float)knot);
     middle.tangent = derive(at(knot - 1), at(knot), at(knot + 1), at(knot + 2), middle.t - (float)knot);
 
@@ -200,49 +298,44 @@ CRSpline::HelpList::iterator CRSpline::divideSegment(HelpList &helpPoints, HelpL
      * C ------- N
      *      m
      */
-    float n = (middle.pos - cur->pos).len();
-    float c = (next->pos - middle.pos).len();
-    float m = (next->pos - cur->pos).len();
+    float n = (middle.pos - cur.pos).len();
+    float c = (next.pos - middle.pos).len();
+    float m = (next.pos - cur.pos).len();
 
     // The deviation is a measure of the height of the triangle,
     // or the difference in the edge lengths
     float deviation = n + c - m;
 
-    // subdivide the segments if the deviation exceeds the allowed error
+    // subdivide the segments if the deviation exceeds the allowed error,
+    // the help points are appended in the order of the curve
     if (deviation > m_error) {
-
-    	// add the increase in length to the subsequent help points
-        HelpList::iterator itr = next;
-        while (itr != helpPoints.end())
-        	(itr++)->len += deviation;
-
-        // insert middle before next
-        middle.len = cur->len + n;
-        helpPoints.insert(next, middle);
-
-        // divide the newly generated segments
-        next = divideSegment(helpPoints, cur, knot);
-        next = divideSegment(helpPoints, next, knot);
+        divideSegment(cur, middle, knot);
+        middle.len = m_table.back().len + (middle.pos - m_table.back().pos).len();
+        m_table.push_back(middle);
+        divideSegment(middle, next, knot);
     }
-
-    return next;
 }
 
 void CRSpline::renderKnots(bool link, const Vec3f& color)
+{
+	renderKnots(m_knots, link, color);
+}
+
+void CRSpline::renderKnots(const std::vector<Vec2f>& knots, bool link, const Vec3f& color)
 {
 	Vec3f p;
 	glColor3fv(&color.x);
 	glBegin(GL_POINTS);
-	for (unsigned i = 0; i < m_knots.size(); ++i) {
-		p = m_knots[i].xz3(newton::getVerticalPosition(m_knots[i].x, m_knots[i].y));
+	for (unsigned i = 0; i < knots.size(); ++i) {
+		p = knots[i].xz3(newton::getVerticalPosition(knots[i].x, knots[i].y));
 		glVertex3fv(&p.x);
 	}
 	glEnd();
 
 	if (link) {
 		glBegin(GL_LINE_STRIP);
-		for (unsigned i = 0; i < m_knots.size(); ++i) {
-			p = m_knots[i].xz3(newton::getVerticalPosition(m_knots[i].x, m_knots[i].y));
+		for (unsigned i = 0; i < knots.size(); ++i) {
+			p = knots[i].xz3(newton::getVerticalPosition(knots[i].x, knots[i].y));
 			glVertex3fv(&p.x);
 		}
 		glEnd();
@@ -252,23 +345,24 @@ void CRSpline::renderKnots(bool link, const Vec3f& color)
 void CRSpline::renderSpline(float accuracy, const Vec3f& color)
 {
 	if (m_knots.size() >= 3)  {
+		std::vector<Vec2f> points;
+		points.reserve(m_knots.size() * 100);
+		for (unsigned i = 0; i < m_knots.size() - 1; ++i)
+			for (float t = 0.0f; t < 1.0f; t += 0.01f)
+				points.push_back(interpolate(at(i-1), at(i+0), at(i+1), at(i+2), t));
+		points.push_back(m_knots.back());
+
+		// the height cache answers without casting rays every frame
+		std::vector<float> heights;
+		newton::getVerticalPositions(points, heights, newton::HEIGHT_STATIC);
+
 		glColor3fv(&color.x);
-	    glBegin(GL_LINES);
-	    Vec2f p;
-	    Vec3f q;
-	    unsigned int size = m_knots.size();
-
-	    for (unsigned i = 0; i < size; ++i) {
-			for (float t = 0.0f; t < 1.0f; t += 0.01f) {
-				p = interpolate(at(i-1), at(i+0), at(i+1), at(i+2), t);
-				q = p.xz3(newton::getVerticalPosition(p.x, p.y));
-				glVertex3fv(&q.x);
-				p = interpolate(at(i-1), at(i+0), at(i+1), at(i+2), t + 0.01f);
-				q = p.xz3(newton::getVerticalPosition(p.x, p.y));
-				glVertex3fv(&q.x);
-			}
-	    }
-	    glEnd();
+		glBegin(GL_LINE_STRIP);
+		for (unsigned i = 0; i < points.size(); ++i) {
+			Vec3f q = points[i].xz3(heights[i]);
+			glVertex3fv(&q.x);
+		}
+		glEnd();
 	}
 }
 
@@ -276,9 +370,17 @@ void CRSpline::renderSpline(float accuracy, const Vec3f& color)
 void CRSpline::renderPoints(float gap, const Vec3f& color, bool tangent, const Vec3f& tangentColor, float tangentLength)
 {
 	if (m_table.size()) {
-		for (float t = 0.0f; t < m_table.back().len; t += gap) {
-			Vec3f p = getPos(t);
-			Vec3f q = p + getTangent(t).normalized() * tangentLength;
+		std::vector<float> lengths;
+		for (float t = 0.0f; t < m_table.back().len; t += gap)
+			lengths.push_back(t);
+
+		std::vector<Vec3f> points;
+		getPositions(lengths, points, newton::HEIGHT_STATIC);
+
+		Sweep sweep(*this);
+		for (unsigned i = 0; i < points.size(); ++i) {
+			const Vec3f& p = points[i];
+			Vec3f q = p + sweep.getTangent(lengths[i]).normalized() * tangentLength;
 
 			glColor3fv(&color.x);
 			glBegin(GL_POINTS);
@@ -133,36 +133,68 @@ void __Domino::genDominoBuffers(ogl::VertexBuffer& vbo)
 }
 #endif
 
+/** The distance between the ground and the bottom of a placed domino */
+static const float VERTICAL_DELTA = 0.01f;
+
+/**
+ * Returns the corners of the domino in the plane, where the height
+ * of the ground is sampled for the placement.
+ *
+ * @param size    The size of the domino
+ * @param matrix  The matrix of the domino
+ * @param corners The x and z positions of the four corners
+ */
+static void getCorners(const Vec3f& size, const Mat4f& matrix, Vec2f* corners)
+{
+	const Vec3f sz = size * 0.5f;
+	const Vec3f p0 = matrix.getW();
+	Mat4f mat(matrix);
+	mat.setW(Vec3f());
+
+	const Vec3f offsets[4] = {
+		Vec3f(sz.x, 0.0f, sz.z), Vec3f(-sz.x, 0.0f, sz.z),
+		Vec3f(-sz.x, 0.0f, -sz.z), Vec3f(sz.x, 0.0f, -sz.z)
+	};
+	for (int i = 0; i < 4; ++i) {
+		const Vec3f p = p0 + offsets[i] * mat;
+		corners[i] = Vec2f(p.x, p.z);
+	}
+}
+
+/**
+ * Places the domino on the highest of the ground samples below its
+ * corners.
+ *
+ * @param size    The size of the domino
+ * @param matrix  The matrix of the domino
+ * @param heights The heights of the ground below the four corners
+ */
+static Mat4f getPlacement(const Vec3f& size, const Mat4f& matrix, const float* heights)
+{
+	Mat4f result(matrix);
+	Vec3f pos = result.getW();
+	pos.y = std::max(std::max(heights[0], heights[1]), std::max(heights[2], heights[3]))
+			+ VERTICAL_DELTA + size.y * 0.5f;
+	result.setW(pos);
+	return result;
+}
+
 Domino __Domino::createDomino(Type type, const Mat4f& matrix, float mass, const std::string& material, bool doPlacement)
 {
-	const float VERTICAL_DELTA = 0.01f;
 	const int materialID = MaterialMgr::instance().getID(material);
 
 	type = std::min(type, DOMINO_LARGE);
 	Vec3f size = s_domino_size[type];
-	Vec3f sz = size * 0.5f;
 
 	Mat4f mat(matrix);
 
 	if (doPlacement) {
-		Vec3f p0 = mat.getW();
-		mat.setW(Vec3f());
-
-		// generate points
-		Vec3f p[4][2];
-		p[0][0] = p[0][1] = p0 + Vec3f(sz.x, 0.0f, sz.z) * mat;
-		p[0][0].y = newton::getVerticalPosition(p[0][0].x, p[0][0].z) + VERTICAL_DELTA;
-		p[1][0] = p[1][1] = p0 + Vec3f(-sz.x, 0.0f, sz.z) * mat;
-		p[1][0].y = newton::getVerticalPosition(p[1][0].x, p[1][0].z) + VERTICAL_DELTA;
-		p[2][0] = p[2][1] = p0 + Vec3f(-sz.x, 0.0f, -sz.z) * mat;
-		p[2][0].y = newton::getVerticalPosition(p[2][0].x, p[2][0].z) + VERTICAL_DELTA;
-		p[3][0] = p[3][1] = p0 + Vec3f(sz.x, 0.0f, -sz.z) * mat;
-		p[3][0].y = newton::getVerticalPosition(p[3][0].x, p[3][0].z) + VERTICAL_DELTA;
-
-		mat = matrix;
-		Vec3f pos = mat.getW();
-		pos.y = std::max(std::max(std::max(p[0][0].y, p[1][0].y), p[2][0].y), p[3][0].y) + size.y * 0.5f;
-		mat.setW(pos);
+		Vec2f corners[4];
+		float heights[4];
+		getCorners(size, matrix, corners);
+		for (int i = 0; i < 4; ++i)
+			heights[i] = newton::getVerticalPosition(corners[i].x, corners[i].y);
+		mat = getPlacement(size, matrix, heights);
 	}
 
 	Mat4f identity = Mat4f::identity();
@@ -177,4 +209,35 @@ Domino __Domino::createDomino(Type type, const Mat4f& matrix, float mass, const
 	return result;
 }
 
+void __Domino::createDominoes(Type type, const std::vector<Mat4f>& matrices, float mass, const std::string& material,
+		std::vector<Domino>& result, newton::HeightFilter filter)
+{
+	std::vector<Mat4f> placed;
+	placeDominoes(type, matrices, placed, filter);
+
+	result.reserve(result.size() + placed.size());
+	for (unsigned i = 0; i < placed.size(); ++i)
+		result.push_back(createDomino(type, placed[i], mass, material, false));
+}
+
+void __Domino::placeDominoes(Type type, const std::vector<Mat4f>& matrices, std::vector<Mat4f>& result,
+		newton::HeightFilter filter)
+{
+	type = std::min(type, DOMINO_LARGE);
+	const Vec3f size = s_domino_size[type];
+
+	// sample the ground below all corners at once, before any of the
+	// new dominoes can be hit by the rays
+	std::vector<Vec2f> corners(matrices.size() * 4);
+	for (unsigned i = 0; i < matrices.size(); ++i)
+		getCorners(size, matrices[i], &corners[i * 4]);
+
+	std::vector<float> heights;
+	newton::getVerticalPositions(corners, heights, filter);
+
+	result.reserve(result.size() + matrices.size());
+	for (unsigned i = 0; i < matrices.size(); ++i)
+		result.push_back(getPlacement(size, matrices[i], &heights[i * 4]));
+}
+
 }
@@ -0,0 +1,289 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/dominopath.cpp
+ */
+
+#include <simulation/dominopath.hpp>
+#include <simulation/simulation.hpp>
+#include <simulation/chaincheck.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace sim {
+
+/** Dominoes that moved less than this keep their matrix */
+static const float MOVE_EPSILON = 1e-4f;
+
+/** @return True, if the matrices have the same position and front */
+static bool isEqual(const Mat4f& a, const Mat4f& b)
+{
+	return (a.getW() - b.getW()).len() < MOVE_EPSILON && (a.getZ() - b.getZ()).len() < MOVE_EPSILON;
+}
+
+__DominoPath::__DominoPath(const std::vector<Vec2f>& knots, __Object::Type type, const std::string& material, float gap)
+	: m_knots(knots),
+	  m_type(std::min(type, __Object::DOMINO_LARGE)),
+	  m_material(material),
+	  m_gap(gap)
+{
+}
+
+std::vector<Vec2f> __DominoPath::getSplineKnots() const
+{
+	// a spline through three knots on a line is a line
+	std::vector<Vec2f> result(m_knots);
+	if (result.size() == 2)
+		result.insert(result.begin() + 1, (result[0] + result[1]) * 0.5f);
+	return result;
+}
+
+void __DominoPath::getLengths(float begin, float end, newton::HeightFilter filter, std::vector<float>& result)
+{
+	result.clear();
+	const float start = begin < 0.0f ? 0.0f : begin;
+	const float stop = end < 0.0f ? m_spline.getKnotLength(m_spline.knots().size()) : end;
+	if (stop - start < m_gap * 0.5f && end >= 0.0f)
+		return;
+
+	// the gaps depend on the turns and the slope of the ground
+	std::vector<float> samples;
+	for (float t = start; t < stop + m_gap; t += m_gap)
+		samples.push_back(t);
+	std::vector<Vec3f> points;
+	m_spline.getPositions(samples, points, filter);
+	std::vector<float> spacing;
+	Simulation::instance().getChainChecker().getSpacing(m_type, m_material, m_gap, points, spacing);
+
+	// fit the gaps between two kept dominoes
+	unsigned count = spacing.size();
+	float scale = 1.0f;
+	if (end >= 0.0f) {
+		count = 1;
+		for (unsigned i = 2; i < spacing.size(); ++i)
+			if (fabs(spacing[i] - (stop - start)) < fabs(spacing[count] - (stop - start)))
+				count = i;
+		scale = (stop - start) / spacing[count];
+	}
+
+	for (unsigned i = begin < 0.0f ? 0 : 1; i < count; ++i) {
+		const float length = start + spacing[i] * scale;
+		if (length > stop)
+			break;
+		result.push_back(length);
+	}
+}
+
+unsigned __DominoPath::update(newton::HeightFilter filter)
+{
+	const std::vector<Vec2f> knots = getSplineKnots();
+	if (knots.size() < 3)
+		return 0;
+
+	// the dominoes in [head, tail) are on the span that depends on changed knots
+	const std::vector<Vec2f>& old = m_spline.knots();
+	unsigned head = 0, tail = m_dominoes.size();
+	float shift = 0.0f;
+	if (old.size() == knots.size() && !m_dominoes.empty()) {
+		unsigned first = 0, last = knots.size() - 1;
+		while (first < knots.size() && knots[first] == old[first])
+			first++;
+		if (first == knots.size())
+			return 0;
+		while (knots[last] == old[last])
+			last--;
+
+		// the segment i depends on the knots i - 1 to i + 2
+		const unsigned firstSegment = first < 2 ? 0 : first - 2;
+		const unsigned lastSegment = std::min(last + 1, (unsigned)knots.size() - 2);
+		const float oldBegin = m_spline.getKnotLength(firstSegment);
+		const float oldEnd = m_spline.getKnotLength(lastSegment + 1);
+		if (first > 0)
+			head = std::lower_bound(m_lengths.begin(), m_lengths.end(), oldBegin) - m_lengths.begin();
+		if (lastSegment + 2 < knots.size())
+			tail = std::lower_bound(m_lengths.begin(), m_lengths.end(), oldEnd) - m_lengths.begin();
+
+		m_spline.knots() = knots;
+		m_spline.update();
+		shift = m_spline.getKnotLength(lastSegment + 1) - oldEnd;
+	} else {
+		m_spline.knots() = knots;
+		m_spline.update();
+	}
+
+	// the dominoes after the span move along with its end
+	for (unsigned i = tail; i < m_lengths.size(); ++i)
+		m_lengths[i] += shift;
+
+	std::vector<float> lengths;
+	getLengths(head > 0 ? m_lengths[head - 1] : -1.0f, tail < m_lengths.size() ? m_lengths[tail] : -1.0f,
+			filter, lengths);
+
+	std::vector<Mat4f> matrices, placed;
+	CRSpline::Sweep sweep(m_spline);
+	for (std::vector<float>::const_iterator itr = lengths.begin(); itr != lengths.end(); ++itr)
+		matrices.push_back(Mat4f(Vec3f::yAxis(), sweep.getTangent(*itr).normalized(), sweep.getPlanarPos(*itr).xz3(0.0f)));
+	__Domino::placeDominoes(m_type, matrices, placed, filter);
+
+	// reuse the dominoes of the span in order, and only move the changed ones
+	std::vector<Domino> dominoes(m_dominoes.begin(), m_dominoes.begin() + head);
+	std::vector<Object> added, removed;
+	unsigned changed = 0;
+	for (unsigned i = 0; i < placed.size(); ++i) {
+		if (head + i < tail) {
+			const Domino& domino = m_dominoes[head + i];
+			if (!isEqual(domino->getMatrix(), placed[i])) {
+				domino->setMatrix(placed[i]);
+				changed++;
+			}
+			dominoes.push_back(domino);
+		} else {
+			dominoes.push_back(__Domino::createDomino(m_type, placed[i], -1.0f, m_material, false));
+			added.push_back(dominoes.back());
+		}
+	}
+	for (unsigned i = head + placed.size(); i < tail; ++i)
+		removed.push_back(m_dominoes[i]);
+	dominoes.insert(dominoes.end(), m_dominoes.begin() + tail, m_dominoes.end());
+
+	lengths.insert(lengths.begin(), m_lengths.begin(), m_lengths.begin() + head);
+	lengths.insert(lengths.end(), m_lengths.begin() + tail, m_lengths.end());
+	m_dominoes.swap(dominoes);
+	m_lengths.swap(lengths);
+
+	Simulation::instance().add(added);
+	Simulation::instance().remove(removed, false);
+	return changed + added.size() + removed.size();
+}
+
+bool __DominoPath::remove(const __Object* object)
+{
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		if (m_dominoes[i].get() == object) {
+			m_dominoes.erase(m_dominoes.begin() + i);
+			m_lengths.erase(m_lengths.begin() + i);
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned __DominoPath::remove(const std::set<const __Object*>& objects)
+{
+	unsigned kept = 0;
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		if (objects.count(m_dominoes[i].get()))
+			continue;
+		if (kept != i) {
+			m_dominoes[kept] = m_dominoes[i];
+			m_lengths[kept] = m_lengths[i];
+		}
+		kept++;
+	}
+
+	const unsigned result = m_dominoes.size() - kept;
+	m_dominoes.resize(kept);
+	m_lengths.resize(kept);
+	return result;
+}
+
+int __DominoPath::getKnot(const Vec2f& pos, float radius) const
+{
+	int result = -1;
+	for (unsigned i = 0; i < m_knots.size(); ++i) {
+		const float distance = (m_knots[i] - pos).len();
+		if (distance < radius) {
+			radius = distance;
+			result = i;
+		}
+	}
+	return result;
+}
+
+void __DominoPath::render()
+{
+	// the knots follow the mouse, the curve is the one the dominoes were placed on
+	CRSpline::renderKnots(m_knots, true, Vec3f(1.0f, 0.8f, 0.0f));
+	m_spline.renderSpline(0.25f, Vec3f(1.0f, 0.8f, 0.0f));
+}
+
+void __DominoPath::save(const __DominoPath& path, rapidxml::xml_node<>* parent, rapidxml::xml_document<>* doc)
+{
+	using namespace rapidxml;
+
+	xml_node<>* node = doc->allocate_node(node_element, "path");
+	parent->append_node(node);
+
+	node->append_attribute(doc->allocate_attribute("type", __Object::TypeStr[path.m_type]));
+	node->append_attribute(doc->allocate_attribute("material", doc->allocate_string(path.m_material.c_str())));
+
+	std::ostringstream gap, dominoes, lengths;
+	gap << path.m_gap;
+	lengths.precision(9);
+	for (unsigned i = 0; i < path.m_dominoes.size(); ++i) {
+		dominoes << (i ? " " : "") << path.m_dominoes[i]->getID();
+		lengths << (i ? " " : "") << path.m_lengths[i];
+	}
+	node->append_attribute(doc->allocate_attribute("gap", doc->allocate_string(gap.str().c_str())));
+	node->append_attribute(doc->allocate_attribute("dominoes", doc->allocate_string(dominoes.str().c_str())));
+	node->append_attribute(doc->allocate_attribute("lengths", doc->allocate_string(lengths.str().c_str())));
+
+	for (std::vector<Vec2f>::const_iterator itr = path.m_knots.begin(); itr != path.m_knots.end(); ++itr) {
+		std::ostringstream x, z;
+		x << itr->x;
+		z << itr->y;
+		xml_node<>* knot = doc->allocate_node(node_element, "knot");
+		knot->append_attribute(doc->allocate_attribute("x", doc->allocate_string(x.str().c_str())));
+		knot->append_attribute(doc->allocate_attribute("z", doc->allocate_string(z.str().c_str())));
+		node->append_node(knot);
+	}
+}
+
+DominoPath __DominoPath::load(rapidxml::xml_node<>* node, const std::map<int, Domino>& dominoes)
+{
+	using namespace rapidxml;
+
+	int type = __Object::DOMINO_SMALL;
+	xml_attribute<>* attr = node->first_attribute("type");
+	if (!attr)
+		throw parse_error("No \"type\" attribute in path tag found", node->name());
+	while (type <= __Object::DOMINO_LARGE && std::string(attr->value()) != __Object::TypeStr[type])
+		type++;
+	if (type > __Object::DOMINO_LARGE)
+		throw parse_error("Unknown domino type in path tag", attr->value());
+
+	attr = node->first_attribute("material");
+	const std::string material = attr ? attr->value() : "";
+	attr = node->first_attribute("gap");
+	const float gap = attr ? atof(attr->value()) : __Domino::s_domino_gap[type];
+
+	std::vector<Vec2f> knots;
+	for (xml_node<>* knot = node->first_node("knot"); knot; knot = knot->next_sibling("knot")) {
+		xml_attribute<>* x = knot->first_attribute("x");
+		xml_attribute<>* z = knot->first_attribute("z");
+		if (!x || !z)
+			throw parse_error("No \"x\" or \"z\" attribute in knot tag found", knot->name());
+		knots.push_back(Vec2f(atof(x->value()), atof(z->value())));
+	}
+
+	DominoPath result(new __DominoPath(knots, (__Object::Type)type, material, gap));
+	result->m_spline.knots() = result->getSplineKnots();
+	result->m_spline.update();
+
+	// the dominoes that are missing in the level are left out
+	std::istringstream ids(node->first_attribute("dominoes") ? node->first_attribute("dominoes")->value() : "");
+	std::istringstream lengths(node->first_attribute("lengths") ? node->first_attribute("lengths")->value() : "");
+	int id;
+	float length;
+	while (ids >> id && lengths >> length) {
+		std::map<int, Domino>::const_iterator domino = dominoes.find(id);
+		if (domino != dominoes.end()) {
+			result->m_dominoes.push_back(domino->second);
+			result->m_lengths.push_back(length);
+		}
+	}
+	return result;
+}
+
+}
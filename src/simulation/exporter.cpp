@@ -0,0 +1,116 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/exporter.cpp
+ */
+
+#include <simulation/exporter.hpp>
+#include <simulation/object.hpp>
+#include <simulation/body.hpp>
+#include <simulation/material.hpp>
+#include <sstream>
+
+namespace sim {
+
+/** @return The object of the body, or NULL */
+static __Object* getObject(const NewtonBody* body)
+{
+	Body* userData = (Body*)NewtonBodyGetUserData(body);
+	return userData ? dynamic_cast<__Object*>(userData) : NULL;
+}
+
+/** @return The name of the material, or the id if it is unknown */
+static std::string getMaterialName(int id)
+{
+	Material* material = MaterialMgr::instance().fromID(id);
+	if (material)
+		return material->name;
+	std::stringstream result;
+	result << id;
+	return result.str();
+}
+
+Exporter::Exporter(const std::string& baseName, unsigned interval, float minImpactSpeed)
+	: m_bodies((baseName + "_bodies.csv").c_str()),
+	  m_events((baseName + "_events.csv").c_str()),
+	  m_interval(interval ? interval : 1),
+	  m_minImpactSpeed(minImpactSpeed),
+	  m_step(0),
+	  m_time(0.0f)
+{
+	m_bodies << "step,time,body,id,type,px,py,pz,qw,qx,qy,qz,vx,vy,vz,wx,wy,wz,sleeping" << std::endl;
+	m_events << "step,time,event,body0,body1,material0,material1,speed,x,y,z" << std::endl;
+}
+
+Exporter::~Exporter()
+{
+}
+
+unsigned Exporter::getIndex(const NewtonBody* body)
+{
+	std::map<const NewtonBody*, unsigned>::iterator itr = m_indices.find(body);
+	if (itr != m_indices.end())
+		return itr->second;
+	unsigned index = m_indices.size();
+	m_indices[body] = index;
+	return index;
+}
+
+void Exporter::addContact(const NewtonBody* body0, const NewtonBody* body1,
+		int material0, int material1, float speed, const Vec3f& position)
+{
+	Contact contact;
+	contact.body0 = body0;
+	contact.body1 = body1;
+	contact.material0 = material0;
+	contact.material1 = material1;
+	contact.speed = speed;
+	contact.position = position;
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_contacts.push_back(contact);
+}
+
+void Exporter::step(const NewtonWorld* world, float timestep)
+{
+	m_time += timestep;
+
+	std::vector<Contact> contacts;
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		contacts.swap(m_contacts);
+	}
+
+	for (std::vector<Contact>::const_iterator itr = contacts.begin(); itr != contacts.end(); ++itr) {
+		m_events << m_step << "," << m_time << ",contact,"
+				 << getIndex(itr->body0) << "," << getIndex(itr->body1) << ","
+				 << getMaterialName(itr->material0) << "," << getMaterialName(itr->material1) << ","
+				 << itr->speed << ","
+				 << itr->position.x << "," << itr->position.y << "," << itr->position.z << "\n";
+	}
+
+	if (m_step % m_interval == 0) {
+		for (NewtonBody* body = NewtonWorldGetFirstBody(world); body; body = NewtonWorldGetNextBody(world, body)) {
+			__Object* object = getObject(body);
+
+			Mat4f matrix;
+			Vec3f velocity, omega;
+			NewtonBodyGetMatrix(body, matrix[0]);
+			NewtonBodyGetVelocity(body, &velocity[0]);
+			NewtonBodyGetOmega(body, &omega[0]);
+			const Quatf rotation = matrix.quat();
+
+			m_bodies << m_step << "," << m_time << "," << getIndex(body) << ","
+					 << (object ? object->getID() : -1) << ","
+					 << (object ? (int)object->getType() : -1) << ","
+					 << matrix._41 << "," << matrix._42 << "," << matrix._43 << ","
+					 << rotation.a << "," << rotation.b << "," << rotation.c << "," << rotation.d << ","
+					 << velocity.x << "," << velocity.y << "," << velocity.z << ","
+					 << omega.x << "," << omega.y << "," << omega.z << ","
+					 << NewtonBodyGetSleepState(body) << "\n";
+		}
+	}
+
+	m_step++;
+}
+
+}
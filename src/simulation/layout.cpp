@@ -0,0 +1,736 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/layout.cpp
+ */
+
+#include <simulation/layout.hpp>
+#include <simulation/domino.hpp>
+#include <simulation/simulation.hpp>
+#include <util/erroradapters.hpp>
+#include "../opengl/stb_image.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace sim {
+
+/** The angle of the first domino in a line, so that it falls over */
+static const float TILT = 0.35f;
+
+/** The factor of the length of a branch of the tree from one level to the next */
+static const float BRANCH_FACTOR = 0.8f;
+
+/** The rows of the glyphs of the font, the leftmost pixel is bit 4 */
+static const unsigned char FONT[][7] = {
+	{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+	{ 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 }, // Y
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }  // space and unknown characters
+};
+
+/** @return The glyph of the character */
+static const unsigned char* getGlyph(char c)
+{
+	static const char* punctuation = ".,!?-";
+	c = toupper(c);
+	if (c >= 'A' && c <= 'Z')
+		return FONT[c - 'A'];
+	if (c >= '0' && c <= '9')
+		return FONT[26 + c - '0'];
+	const char* p = strchr(punctuation, c);
+	if (c && p)
+		return FONT[36 + (p - punctuation)];
+	return FONT[41];
+}
+
+/** @return The vector rotated counterclockwise by the angle */
+static Vec2f rotate(const Vec2f& v, float angle)
+{
+	const float c = cos(angle), s = sin(angle);
+	return Vec2f(v.x * c - v.y * s, v.x * s + v.y * c);
+}
+
+/** @return The vector rotated counterclockwise by 90 degrees */
+static Vec2f left(const Vec2f& v)
+{
+	return Vec2f(-v.y, v.x);
+}
+
+/**
+ * Builds the lines of dominoes of a layout on the xz-plane and rejects
+ * dominoes that overlap others. A line is closed at its first rejected
+ * domino, and all further dominoes of this line are dropped.
+ */
+class LayoutBuilder {
+public:
+	/** A line of dominoes that is being built */
+	struct Line {
+		/** The position and the direction of the last domino */
+		Vec2f pos;
+		Vec2f dir;
+
+		unsigned id;
+
+		/** The number of dominoes of the line */
+		unsigned length;
+
+		/** False, if the line has been closed */
+		bool open;
+	};
+protected:
+	struct Entry {
+		Vec2f pos;
+		Vec2f dir;
+		unsigned line;
+		unsigned index;
+		bool tilt;
+	};
+
+	typedef std::pair<int, int> CellKey;
+	typedef boost::unordered_map<CellKey, std::vector<unsigned> > Grid;
+
+	const LayoutParams& m_params;
+	std::vector<Entry> m_entries;
+	Grid m_grid;
+
+	float m_gap;
+
+	/** Dominoes with centers closer than this may overlap */
+	float m_distance;
+
+	/** The number of previous dominoes of the same line that are not tested */
+	unsigned m_window;
+
+	unsigned m_lines;
+	boost::uint32_t m_random;
+
+	CellKey getCell(const Vec2f& pos) const;
+	bool add(Line& line, const Vec2f& pos, const Vec2f& dir, bool tilt);
+public:
+	LayoutBuilder(const LayoutParams& params);
+
+	/** Starts a new line with a single domino */
+	Line begin(const Vec2f& pos, const Vec2f& dir, bool tilt = false);
+
+	/** @return A line that is already closed */
+	Line closed();
+
+	/** Adds a domino to the line, @return False, if the line is closed */
+	bool place(Line& line, const Vec2f& pos, const Vec2f& dir);
+
+	/** Continues the line straight ahead */
+	bool forward(Line& line, float length);
+
+	/** Continues the line straight to the target */
+	bool lineTo(Line& line, const Vec2f& target);
+
+	/** Continues the line on a circular arc, positive angles turn left */
+	bool turn(Line& line, float radius, float angle);
+
+	/**
+	 * Starts two lines side by side in front of the line, which ends.
+	 * The left line is on the left side of the direction of the line.
+	 */
+	void split(Line& line, Line& left, Line& right);
+
+	/** Ends the two lines, which run side by side, in a new line */
+	Line merge(Line& a, Line& b);
+
+	/** @return A random number from 0 to 1 */
+	float random();
+
+	/** @return A random factor from 1 - jitter / 2 to 1 + jitter / 2 */
+	float jitter();
+
+	/** @return The distance of two dominoes in a line */
+	float getGap() const;
+
+	/** @return The distance of two lines side by side */
+	float getSide() const;
+
+	/** @return True, if the count of the layout is reached */
+	bool full() const;
+
+	/** Appends the matrices of all dominoes in world coordinates */
+	unsigned getMatrices(std::vector<Mat4f>& result) const;
+};
+
+LayoutBuilder::LayoutBuilder(const LayoutParams& params)
+	: m_params(params), m_lines(0)
+{
+	const Vec3f size = __Domino::s_domino_size[std::min(params.type, __Object::DOMINO_LARGE)];
+	m_gap = params.getGap();
+	m_distance = sqrt(size.x * size.x + size.z * size.z);
+	m_window = (unsigned)ceil(m_distance / m_gap) + 1;
+	m_random = params.seed ? params.seed : 2463534242u;
+	m_entries.reserve(std::min(params.count, 1u << 20));
+}
+
+LayoutBuilder::CellKey LayoutBuilder::getCell(const Vec2f& pos) const
+{
+	return std::make_pair((int)floor(pos.x / m_distance), (int)floor(pos.y / m_distance));
+}
+
+bool LayoutBuilder::add(Line& line, const Vec2f& pos, const Vec2f& dir, bool tilt)
+{
+	if (!line.open || full()) {
+		line.open = false;
+		return false;
+	}
+
+	// the cells are as large as the distance, so the neighbors suffice
+	const CellKey cell = getCell(pos);
+	for (int x = cell.first - 1; x <= cell.first + 1; ++x) {
+		for (int z = cell.second - 1; z <= cell.second + 1; ++z) {
+			Grid::const_iterator itr = m_grid.find(std::make_pair(x, z));
+			if (itr == m_grid.end())
+				continue;
+			for (std::vector<unsigned>::const_iterator i = itr->second.begin(); i != itr->second.end(); ++i) {
+				const Entry& entry = m_entries[*i];
+				if (entry.line == line.id && entry.index + m_window >= line.length)
+					continue;
+				if ((entry.pos - pos).lenlen() < m_distance * m_distance) {
+					line.open = false;
+					return false;
+				}
+			}
+		}
+	}
+
+	Entry entry;
+	entry.pos = pos;
+	entry.dir = dir;
+	entry.line = line.id;
+	entry.index = line.length++;
+	entry.tilt = tilt;
+	m_grid[cell].push_back(m_entries.size());
+	m_entries.push_back(entry);
+
+	line.pos = pos;
+	line.dir = dir;
+	return true;
+}
+
+LayoutBuilder::Line LayoutBuilder::begin(const Vec2f& pos, const Vec2f& dir, bool tilt)
+{
+	Line line;
+	line.pos = pos;
+	line.dir = dir;
+	line.id = m_lines++;
+	line.length = 0;
+	line.open = true;
+	add(line, pos, dir, tilt);
+	return line;
+}
+
+LayoutBuilder::Line LayoutBuilder::closed()
+{
+	Line line;
+	line.pos = Vec2f();
+	line.dir = Vec2f(1.0f, 0.0f);
+	line.id = m_lines++;
+	line.length = 0;
+	line.open = false;
+	return line;
+}
+
+bool LayoutBuilder::place(Line& line, const Vec2f& pos, const Vec2f& dir)
+{
+	return add(line, pos, dir, false);
+}
+
+bool LayoutBuilder::forward(Line& line, float length)
+{
+	const unsigned n = (unsigned)floor(length / m_gap + 0.5f);
+	for (unsigned i = 0; i < n; ++i)
+		if (!place(line, line.pos + line.dir * m_gap, line.dir))
+			return false;
+	return line.open;
+}
+
+bool LayoutBuilder::lineTo(Line& line, const Vec2f& target)
+{
+	const Vec2f start = line.pos;
+	const float length = (target - start).len();
+	if (length < 1e-4f)
+		return line.open;
+
+	const Vec2f dir = (target - start) * (1.0f / length);
+	const unsigned n = std::max(1u, (unsigned)floor(length / m_gap + 0.5f));
+	for (unsigned i = 1; i <= n; ++i)
+		if (!place(line, start + dir * (length * i / n), dir))
+			return false;
+	return line.open;
+}
+
+bool LayoutBuilder::turn(Line& line, float radius, float angle)
+{
+	const Vec2f center = line.pos + left(line.dir) * (angle < 0.0f ? -radius : radius);
+	const Vec2f offset = line.pos - center;
+	const Vec2f dir = line.dir;
+	const unsigned n = std::max(1u, (unsigned)floor(fabs(angle) * radius / m_gap + 0.5f));
+	for (unsigned i = 1; i <= n; ++i) {
+		const float a = angle * i / n;
+		if (!place(line, center + rotate(offset, a), rotate(dir, a)))
+			return false;
+	}
+	return line.open;
+}
+
+void LayoutBuilder::split(Line& line, Line& left, Line& right)
+{
+	if (!line.open) {
+		left = closed();
+		right = closed();
+		return;
+	}
+	line.open = false;
+
+	const Vec2f pos = line.pos + line.dir * m_gap;
+	const Vec2f side = sim::left(line.dir) * (getSide() * 0.5f);
+	left = begin(pos + side, line.dir);
+	right = begin(pos - side, line.dir);
+}
+
+LayoutBuilder::Line LayoutBuilder::merge(Line& a, Line& b)
+{
+	if (!a.open && !b.open)
+		return closed();
+
+	// a closed line may have ended anywhere before
+	Vec2f pos, dir;
+	if (a.open && b.open) {
+		pos = (a.pos + b.pos) * 0.5f;
+		dir = (a.dir + b.dir).normalized();
+	} else {
+		pos = a.open ? a.pos : b.pos;
+		dir = a.open ? a.dir : b.dir;
+	}
+	a.open = false;
+	b.open = false;
+	return begin(pos + dir * m_gap, dir);
+}
+
+float LayoutBuilder::random()
+{
+	// xorshift, so that the layouts are the same on all platforms
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return (m_random & 0xffffff) / 16777216.0f;
+}
+
+float LayoutBuilder::jitter()
+{
+	return 1.0f + m_params.jitter * (random() - 0.5f);
+}
+
+float LayoutBuilder::getGap() const
+{
+	return m_gap;
+}
+
+float LayoutBuilder::getSide() const
+{
+	return m_distance * 1.1f;
+}
+
+bool LayoutBuilder::full() const
+{
+	return m_entries.size() >= m_params.count;
+}
+
+unsigned LayoutBuilder::getMatrices(std::vector<Mat4f>& result) const
+{
+	const Vec3f size = __Domino::s_domino_size[std::min(m_params.type, __Object::DOMINO_LARGE)];
+	const Mat4f transform = Mat4f::rotY(m_params.rotation * (float)PI / 180.0f) * Mat4f::translate(m_params.origin);
+
+	result.reserve(result.size() + m_entries.size());
+	for (std::vector<Entry>::const_iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr) {
+		Mat4f matrix(Vec3f::yAxis(), Vec3f(itr->dir.x, 0.0f, itr->dir.y), Vec3f(itr->pos.x, size.y * 0.5f, itr->pos.y));
+		if (itr->tilt)
+			matrix = Mat4f::rotX(TILT) * matrix;
+		result.push_back(matrix * transform);
+	}
+	return m_entries.size();
+}
+
+LayoutParams::LayoutParams()
+	: generator("spiral"), type(__Object::DOMINO_MIDDLE), material("domino"), gap(0.0f),
+	  count(1000), seed(1), rotation(0.0f), spacing(0.0f), rows(0), jitter(0.3f), scale(1),
+	  threshold(0.5f), depth(10), angle(60.0f), lanes(8), tilt(true), place(true)
+{
+}
+
+void LayoutParams::load(rapidxml::xml_node<>* node)
+{
+	using namespace rapidxml;
+
+	for (xml_attribute<>* attr = node->first_attribute(); attr; attr = attr->next_attribute()) {
+		const std::string name(attr->name());
+		const char* value = attr->value();
+		if (name == "generator") generator = value;
+		else if (name == "type") {
+			int t = __Object::DOMINO_SMALL;
+			while (t <= __Object::DOMINO_LARGE && std::string(value) != __Object::TypeStr[t])
+				t++;
+			if (t > __Object::DOMINO_LARGE)
+				throw parse_error("Unknown domino type in layout tag", attr->value());
+			type = (__Object::Type)t;
+		}
+		else if (name == "material") material = value;
+		else if (name == "gap") gap = atof(value);
+		else if (name == "count") count = strtoul(value, NULL, 10);
+		else if (name == "seed") seed = strtoul(value, NULL, 10);
+		else if (name == "origin") origin.assign(value);
+		else if (name == "rotation") rotation = atof(value);
+		else if (name == "spacing") spacing = atof(value);
+		else if (name == "rows") rows = strtoul(value, NULL, 10);
+		else if (name == "jitter") jitter = atof(value);
+		else if (name == "text") text = value;
+		else if (name == "scale") scale = std::max(1ul, strtoul(value, NULL, 10));
+		else if (name == "image") image = value;
+		else if (name == "threshold") threshold = atof(value);
+		else if (name == "depth") depth = strtoul(value, NULL, 10);
+		else if (name == "angle") angle = atof(value);
+		else if (name == "lanes") lanes = strtoul(value, NULL, 10);
+		else if (name == "tilt") tilt = std::string(value) == "true";
+		else if (name == "place") place = std::string(value) == "true";
+		else throw parse_error("Unknown attribute in layout tag", attr->name());
+	}
+}
+
+float LayoutParams::getGap() const
+{
+	return gap > 0.0f ? gap : __Domino::s_domino_gap[std::min(type, __Object::DOMINO_LARGE)];
+}
+
+void LayoutGenerator::spiral(const LayoutParams& params, LayoutBuilder& builder)
+{
+	const float gap = builder.getGap();
+
+	// r = b * angle, the distance of two windings is the spacing
+	const float spacing = params.spacing > 0.0f ? params.spacing : gap * 3.0f;
+	const float b = spacing / (2.0f * PI);
+	float angle = 2.0f * PI;
+	float r = b * angle;
+	LayoutBuilder::Line line = builder.begin(Vec2f(r, 0.0f), Vec2f(0.0f, 1.0f), params.tilt);
+	while (line.open) {
+		// advance by one gap along the arc
+		angle += gap / r;
+		r = b * angle;
+		builder.place(line, Vec2f(r * cos(angle), r * sin(angle)), Vec2f(-sin(angle), cos(angle)));
+	}
+}
+
+void LayoutGenerator::field(const LayoutParams& params, LayoutBuilder& builder)
+{
+	const float gap = builder.getGap();
+	const float spacing = std::max(params.spacing, gap * 2.0f);
+
+	// the rows turn with the largest radius that keeps them apart
+	const float radius = std::max(spacing - builder.getSide(), gap);
+
+	// without a number of rows, the field is about square
+	const float length = params.rows ? params.count * gap / params.rows : sqrt(params.count * gap * spacing);
+
+	// the trunk runs along x, the rows branch off to the right
+	LayoutBuilder::Line trunk = builder.begin(Vec2f(), Vec2f(1.0f, 0.0f), params.tilt);
+	for (unsigned i = 0; (!params.rows || i < params.rows) && trunk.open; ++i) {
+		LayoutBuilder::Line next, row;
+		builder.split(trunk, next, row);
+		builder.turn(row, radius, -0.5f * PI);
+		builder.forward(row, length * (1.0f - params.jitter * builder.random()) - radius);
+
+		// back to the middle, the next rows split straight along x
+		trunk = next;
+		builder.lineTo(trunk, Vec2f((i + 1) * spacing, 0.0f));
+		trunk.dir = Vec2f(1.0f, 0.0f);
+	}
+}
+
+void LayoutGenerator::bitmap(const LayoutParams& params, const std::vector<bool>& pixels,
+		unsigned width, unsigned height, LayoutBuilder& builder)
+{
+	const float gap = builder.getGap();
+	const float spacing = params.spacing > 0.0f ? params.spacing : gap;
+	const Vec2f dir(1.0f, 0.0f);
+
+	// each run of lit pixels in a row is a line
+	for (unsigned y = 0; y < height && !builder.full(); ++y) {
+		LayoutBuilder::Line line = builder.closed();
+		bool run = false;
+		for (unsigned x = 0; x < width; ++x) {
+			if (!pixels[y * width + x]) {
+				run = false;
+				continue;
+			}
+			const Vec2f pos(x * gap, y * spacing);
+			if (run)
+				builder.place(line, pos, dir);
+			else
+				line = builder.begin(pos, dir, params.tilt);
+			run = true;
+		}
+	}
+}
+
+void LayoutGenerator::text(const LayoutParams& params, LayoutBuilder& builder)
+{
+	// one column between two characters
+	const unsigned scale = std::max(1u, params.scale);
+	const unsigned width = params.text.size() * 6 * scale;
+	const unsigned height = 7 * scale;
+	std::vector<bool> pixels(width * height, false);
+	for (unsigned i = 0; i < params.text.size(); ++i) {
+		const unsigned char* glyph = getGlyph(params.text[i]);
+		for (unsigned y = 0; y < height; ++y)
+			for (unsigned x = 0; x < 5 * scale; ++x)
+				pixels[y * width + i * 6 * scale + x] = (glyph[y / scale] >> (4 - x / scale)) & 1;
+	}
+	bitmap(params, pixels, width, height, builder);
+}
+
+void LayoutGenerator::image(const LayoutParams& params, LayoutBuilder& builder)
+{
+	/* information for error messages */
+	std::string function = "LayoutGenerator::image";
+	std::vector<std::string> args;
+	args.push_back(params.image);
+	/* END information for error messages */
+
+	int width, height, components;
+	unsigned char* data = stbi_load(params.image.c_str(), &width, &height, &components, 1);
+	if (!data) {
+		std::runtime_error e("cannot load image " + params.image);
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+		return;
+	}
+
+	const float threshold = params.threshold * 255.0f;
+	std::vector<bool> pixels(width * height);
+	for (int i = 0; i < width * height; ++i)
+		pixels[i] = data[i] < threshold;
+	stbi_image_free(data);
+
+	bitmap(params, pixels, width, height, builder);
+}
+
+void LayoutGenerator::tree(const LayoutParams& params, LayoutBuilder& builder)
+{
+	const float gap = builder.getGap();
+	const float radius = params.spacing > 0.0f ? params.spacing : gap * 2.0f;
+	const float angle = params.angle * (float)PI / 180.0f;
+
+	// the lengths of all levels add up to the count
+	float sum = 0.0f, factor = 1.0f;
+	for (unsigned d = 0; d <= params.depth; ++d, factor *= 2.0f * BRANCH_FACTOR)
+		sum += factor;
+	float length = std::max(params.count * gap / sum, gap * 2.0f);
+
+	// grow level by level, so that the count cuts the outermost branches
+	std::vector<LayoutBuilder::Line> level(1, builder.begin(Vec2f(), Vec2f(1.0f, 0.0f), params.tilt));
+	for (unsigned d = 0; d <= params.depth && !level.empty(); ++d, length *= BRANCH_FACTOR) {
+		std::vector<LayoutBuilder::Line> next;
+		for (std::vector<LayoutBuilder::Line>::iterator itr = level.begin(); itr != level.end(); ++itr) {
+			if (!builder.forward(*itr, length * builder.jitter()) || d == params.depth)
+				continue;
+
+			LayoutBuilder::Line left, right;
+			builder.split(*itr, left, right);
+			const float a = angle * 0.5f * builder.jitter();
+			if (builder.turn(left, radius, a))
+				next.push_back(left);
+			if (builder.turn(right, radius, -a))
+				next.push_back(right);
+		}
+		level.swap(next);
+	}
+}
+
+void LayoutGenerator::lanes(const LayoutParams& params, LayoutBuilder& builder)
+{
+	const float gap = builder.getGap();
+	const float side = builder.getSide();
+	const float spacing = std::max(params.spacing > 0.0f ? params.spacing : gap, side);
+
+	unsigned lanes = 1, levels = 0;
+	while (lanes * 2 <= std::max(1u, params.lanes)) {
+		lanes *= 2;
+		levels++;
+	}
+	const float run = lanes * spacing * 4.0f;
+
+	// the lanes are sorted from right to left, their lateral position is y
+	LayoutBuilder::Line line = builder.begin(Vec2f(), Vec2f(1.0f, 0.0f), params.tilt);
+	while (line.open) {
+		builder.forward(line, gap * 2.0f);
+
+		std::vector<LayoutBuilder::Line> current(1, line);
+		for (unsigned k = 1; k <= levels; ++k) {
+			const float offset = spacing * lanes / (2 << k);
+			const float length = std::max(2.0f * (offset - side * 0.5f), gap * 2.0f);
+			std::vector<LayoutBuilder::Line> next;
+			for (std::vector<LayoutBuilder::Line>::iterator itr = current.begin(); itr != current.end(); ++itr) {
+				const Vec2f pos = itr->pos;
+				LayoutBuilder::Line left, right;
+				builder.split(*itr, left, right);
+				const float x = pos.x + gap + length;
+				builder.lineTo(right, Vec2f(x, pos.y - offset));
+				builder.lineTo(right, Vec2f(x + gap, pos.y - offset));
+				builder.lineTo(left, Vec2f(x, pos.y + offset));
+				builder.lineTo(left, Vec2f(x + gap, pos.y + offset));
+				next.push_back(right);
+				next.push_back(left);
+			}
+			current.swap(next);
+		}
+
+		float start = 0.0f;
+		for (std::vector<LayoutBuilder::Line>::iterator itr = current.begin(); itr != current.end(); ++itr)
+			start = std::max(start, itr->pos.x);
+		for (std::vector<LayoutBuilder::Line>::iterator itr = current.begin(); itr != current.end(); ++itr)
+			builder.lineTo(*itr, Vec2f(start + run, itr->pos.y));
+
+		// merge the neighbors pairwise in the reverse order of the splits
+		for (unsigned k = levels; k >= 1; --k) {
+			const float offset = spacing * lanes / (2 << k);
+			const float length = std::max(2.0f * (offset - side * 0.5f), gap * 2.0f);
+			std::vector<LayoutBuilder::Line> next;
+			for (unsigned i = 0; i + 1 < current.size(); i += 2) {
+				LayoutBuilder::Line& right = current[i];
+				LayoutBuilder::Line& left = current[i + 1];
+				const float x = std::max(right.pos.x, left.pos.x) + length;
+				const float y = (right.pos.y + left.pos.y) * 0.5f;
+				builder.lineTo(right, Vec2f(x, y - side * 0.5f));
+				builder.lineTo(right, Vec2f(x + gap, y - side * 0.5f));
+				builder.lineTo(left, Vec2f(x, y + side * 0.5f));
+				builder.lineTo(left, Vec2f(x + gap, y + side * 0.5f));
+				next.push_back(builder.merge(right, left));
+			}
+			current.swap(next);
+		}
+		line = current.front();
+	}
+}
+
+unsigned LayoutGenerator::generate(const LayoutParams& params, std::vector<Mat4f>& matrices)
+{
+	LayoutBuilder builder(params);
+	if (params.generator == "spiral") spiral(params, builder);
+	else if (params.generator == "field") field(params, builder);
+	else if (params.generator == "text") text(params, builder);
+	else if (params.generator == "image") image(params, builder);
+	else if (params.generator == "tree") tree(params, builder);
+	else if (params.generator == "lanes") lanes(params, builder);
+	else return 0;
+	return builder.getMatrices(matrices);
+}
+
+unsigned LayoutGenerator::create(const LayoutParams& params)
+{
+	std::vector<Mat4f> matrices;
+	if (!generate(params, matrices))
+		return 0;
+
+	std::vector<Domino> dominoes;
+	if (params.place) {
+		__Domino::createDominoes(params.type, matrices, -1.0f, params.material, dominoes,
+				Simulation::instance().getPlacementFilter());
+	} else {
+		dominoes.reserve(matrices.size());
+		for (std::vector<Mat4f>::const_iterator itr = matrices.begin(); itr != matrices.end(); ++itr)
+			dominoes.push_back(__Domino::createDomino(params.type, *itr, -1.0f, params.material, false));
+	}
+
+	std::vector<Object> objects(dominoes.begin(), dominoes.end());
+	Simulation::instance().add(objects);
+	return objects.size();
+}
+
+unsigned LayoutGenerator::load(const std::string& fileName, unsigned scale)
+{
+	/* information for error messages */
+	std::string function = "LayoutGenerator::load";
+	std::vector<std::string> args;
+	args.push_back(fileName);
+	/* END information for error messages */
+
+	using namespace rapidxml;
+
+	unsigned count = 0;
+	try {
+		std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+		if (!file)
+			throw std::runtime_error("cannot open file " + fileName);
+
+		std::vector<char> text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		text.push_back(0);
+
+		xml_document<> doc;
+		doc.parse<0>(&text[0]);
+
+		xml_node<>* root = doc.first_node("layouts");
+		if (!root)
+			throw parse_error("No layouts tag found", &text[0]);
+
+		for (xml_node<>* node = root->first_node("layout"); node; node = node->next_sibling("layout")) {
+			LayoutParams params;
+			params.load(node);
+			params.count *= std::max(1u, scale);
+			count += create(params);
+		}
+	} catch (parse_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+	} catch (std::runtime_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+	}
+	return count;
+}
+
+}
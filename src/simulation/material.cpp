@@ -17,9 +17,12 @@
 #include <string.h>
 #include <util/tostring.hpp>
 #include <util/erroradapters.hpp>
+#include <util/profiler.hpp>
 #include <clocale>
+#include <algorithm>
 #include <sound/soundmgr.hpp>
 #include <simulation/simulation.hpp>
+#include <newton/stats.hpp>
 
 namespace sim {
 
@@ -616,12 +619,19 @@ void MaterialMgr::processContact(const NewtonJoint* contactJoint, float timestep
 
 	int mat0, mat1;
 
+	// the fastest contact of the joint, for the export
+	Exporter* exporter = Simulation::instance().getExporter();
+	float exportSpeed = exporter ? exporter->getMinImpactSpeed() : 0.0f;
+	int exportMat0 = -1, exportMat1 = -1;
+	Vec3f exportPos, exportNormal;
+
 	// get the contact material
 	NewtonMaterial* material;
 	NewtonBody *body0, *body1;
 
 	body0 = NewtonJointGetBody0(contactJoint);
 	body1 = NewtonJointGetBody1(contactJoint);
+	bool counted = false;
 	for (void* contact = NewtonContactJointGetFirstContact(contactJoint);
 				contact; contact = NewtonContactJointGetNextContact(contactJoint, contact)) {
 
@@ -642,6 +652,12 @@ void MaterialMgr::processContact(const NewtonJoint* contactJoint, float timestep
 		// get the pair for the materials, or the default pair
 		MaterialPair& pair = getPair(mat0, mat1);
 
+		// count the callback for the pair of its first contact
+		if (!counted) {
+			newton::Stats::instance().countContact(threadIndex, std::min(mat0, mat1), std::max(mat0, mat1));
+			counted = true;
+		}
+
 		//std::cout << "pair " << mat0 << ", " << mat1 << std::endl;
 		//std::cout <<pair.elasticity << std::endl;
 
@@ -658,6 +674,13 @@ void MaterialMgr::processContact(const NewtonJoint* contactJoint, float timestep
 			bestSound = pair.impactSound;
 		}
 
+		if (exporter && normalSpeed >= exportSpeed) {
+			exportSpeed = normalSpeed;
+			exportMat0 = mat0;
+			exportMat1 = mat1;
+			NewtonMaterialGetContactPositionAndNormal(material, body0, &exportPos[0], &exportNormal[0]);
+		}
+
 		/*
 		bool conv = false;
 		Material* mat = fromID(mat0);
@@ -681,13 +704,24 @@ void MaterialMgr::processContact(const NewtonJoint* contactJoint, float timestep
 	*/
 	}
 
-	if (bestSound.size()) {
-		Vec3f distance(Simulation::instance().getCamera().m_position - contactPos);
-		float dist2 = distance * distance;
-		if (dist2 < (MAX_SOUND_DISTANCE * MAX_SOUND_DISTANCE)) {
-			Vec3f vel;
-			snd::SoundMgr::instance().PlaySound(bestSound, 1, &contactPos[0], &vel[0]);
-		}
+	if (exporter && exportMat0 != -1)
+		exporter->addContact(body0, body1, exportMat0, exportMat1, exportSpeed, exportPos);
+
+	if (bestSound.size())
+		playImpactSound(bestSound, contactPos);
+}
+
+void MaterialMgr::playImpactSound(const std::string& sound, const Vec3f& position)
+{
+	if (Recorder* recorder = Simulation::instance().getRecorder())
+		recorder->addSound(sound, position);
+
+	Vec3f distance(Simulation::instance().getCamera().m_position - position);
+	float dist2 = distance * distance;
+	if (dist2 < (MAX_SOUND_DISTANCE * MAX_SOUND_DISTANCE) && !Simulation::instance().isHeadless()) {
+		Vec3f vel;
+		Vec3f pos(position);
+		snd::SoundMgr::instance().PlaySound(sound, 1, &pos[0], &vel[0]);
 	}
 }
 
@@ -695,6 +729,7 @@ void MaterialMgr::GenericContactCallback(const NewtonJoint* contactJoint,
 		dFloat timestep,
 		int threadIndex)
 {
+	util::ProfileZone zone("contacts");
 	instance().processContact(contactJoint, timestep, threadIndex);
 }
 }
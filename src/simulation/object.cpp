@@ -72,6 +72,25 @@ __Object::~__Object()
 #endif
 }
 
+void __Object::convexCastPlacements(const std::vector<Object>& objects)
+{
+	// the environment is not placed
+	std::vector<std::vector<NewtonBody*> > groups(objects.size());
+	for (unsigned i = 0; i < objects.size(); ++i)
+		if (objects[i]->getType() != TREE_COLLISION)
+			objects[i]->getBodies(groups[i]);
+
+	std::vector<float> offsets;
+	newton::getConvexCastOffsets(groups, offsets);
+	for (unsigned i = 0; i < objects.size(); ++i) {
+		if (groups[i].empty())
+			continue;
+		Mat4f matrix = objects[i]->getMatrix();
+		matrix._42 += offsets[i] + 0.0001f;
+		objects[i]->setMatrix(matrix);
+	}
+}
+
 
 void __Object::save(__Object& object, rapidxml::xml_node<>* parent, rapidxml::xml_document<>* doc)
 {
@@ -318,7 +337,7 @@ __RigidBody::__RigidBody(Type type, NewtonBody* body, const Mat4f& matrix, const
 {
 }
 
-float __RigidBody::convexCastPlacement(bool apply, std::list<NewtonBody*>* noCollision)
+float __RigidBody::convexCastPlacement(bool apply, const newton::BodySet* noCollision)
 {
 	float vertical = newton::getConvexCastPlacement(m_body, noCollision);
 	Mat4f matrix = m_matrix;
@@ -773,6 +792,11 @@ void __RigidBody::genBuffers(ogl::VertexBuffer& vbo)
 	NewtonMeshDestroy(collisionMesh);
 }
 
+void __RigidBody::getBodies(std::vector<NewtonBody*>& bodies)
+{
+	bodies.push_back(m_body);
+}
+
 bool __RigidBody::contains(const NewtonBody* const body)
 {
 	return m_body == body;
@@ -804,23 +828,31 @@ __Convex::~__Convex()
 {
 }
 
+std::map<std::string, __Convex::Shape> __Convex::s_shapes;
+
 Convex __Convex::createHull(const Mat4f& matrix, float mass, const std::string& material,
 		const std::string& fileName, int freezeState, const Vec4f& damping)
 {
 	Convex result(new __Convex(CONVEX_HULL, matrix, mass, material, fileName, freezeState, damping));
 
-	// load the visual
-	ogl::Mesh visual = ogl::__Mesh::load3ds(fileName, result.get());
+	std::string key = std::string(TypeStr[CONVEX_HULL]) + ":" + material + ":" + fileName;
+	std::map<std::string, Shape>::iterator shape = s_shapes.find(key);
+	if (shape == s_shapes.end()) {
+		// load the visual, the sub-meshes get their userData in genBuffers
+		ogl::Mesh visual = ogl::__Mesh::load3ds(fileName, NULL);
 
-	int materialID = MaterialMgr::instance().getID(material);
+		int materialID = MaterialMgr::instance().getID(material);
 
-	// create a hull from the visual
-	NewtonCollision* collision = NewtonCreateConvexHull(newton::world, visual->vertexCount(),
-			visual->firstVertex(), visual->byteSize(), 0.002f, materialID, NULL);
-	result->create(collision, mass, freezeState, damping);
-	NewtonReleaseCollision(newton::world, collision);
+		// create a hull from the visual
+		Shape s;
+		s.collision = NewtonCreateConvexHull(newton::world, visual->vertexCount(),
+				visual->firstVertex(), visual->byteSize(), 0.002f, materialID, NULL);
+		s.visual = visual;
+		shape = s_shapes.insert(std::make_pair(key, s)).first;
+	}
 
-	result->m_visual = visual;
+	result->create(shape->second.collision, mass, freezeState, damping);
+	result->m_visual = shape->second.visual;
 
 	return result;
 }
@@ -830,37 +862,53 @@ Convex __Convex::createAssembly(const Mat4f& matrix, float mass, const std::stri
 {
 	Convex result(new __Convex(CONVEX_ASSEMBLY, matrix, mass, material, fileName, freezeState, damping));
 
-	// load the visual entity and preserve the original sub-meshes
-	ogl::SubBuffers buffers;
-	ogl::Mesh visual = ogl::__Mesh::load3ds(fileName, result.get(), &buffers);
+	std::string key = std::string(TypeStr[CONVEX_ASSEMBLY]) + ":" + material + ":" + fileName;
+	std::map<std::string, Shape>::iterator shape = s_shapes.find(key);
+	if (shape == s_shapes.end()) {
+		// load the visual entity and preserve the original sub-meshes
+		ogl::SubBuffers buffers;
+		ogl::Mesh visual = ogl::__Mesh::load3ds(fileName, NULL, &buffers);
+
+		int defaultMaterial = MaterialMgr::instance().getID(material);
+
+		// for each sub-mesh, create a convex hull
+		std::vector<NewtonCollision*> collisions;
+		BOOST_FOREACH(ogl::SubBuffer* buf, buffers) {
+			int meshMaterial = MaterialMgr::instance().getID(buf->material);
+			const float* data = visual->firstVertex() + buf->dataOffset * visual->floatSize();
+			collisions.push_back(NewtonCreateConvexHull(newton::world, buf->dataCount, data, visual->byteSize(), 0.002f, meshMaterial, NULL));
+			delete buf;
+		}
 
-	int defaultMaterial = MaterialMgr::instance().getID(material);
+		// create a compound from all hulls
+		Shape s;
+		s.collision = NewtonCreateCompoundCollision(newton::world, collisions.size(), &collisions[0], defaultMaterial);
+		s.visual = visual;
+		BOOST_FOREACH(NewtonCollision* hull, collisions)
+			NewtonReleaseCollision(newton::world, hull);
 
-	// for each sub-mesh, create a convex hull
-	std::vector<NewtonCollision*> collisions;
-	BOOST_FOREACH(ogl::SubBuffer* buf, buffers) {
-		int meshMaterial = MaterialMgr::instance().getID(buf->material);
-		const float* data = visual->firstVertex() + buf->dataOffset * visual->floatSize();
-		collisions.push_back(NewtonCreateConvexHull(newton::world, buf->dataCount, data, visual->byteSize(), 0.002f, meshMaterial, NULL));
-		delete buf;
+		shape = s_shapes.insert(std::make_pair(key, s)).first;
 	}
 
-	// create a compound from all hulls
-	NewtonCollision* collision = NewtonCreateCompoundCollision(newton::world, collisions.size(), &collisions[0], defaultMaterial);
-	result->create(collision, mass, freezeState, damping);
-
-	NewtonReleaseCollision(newton::world, collision);
-	BOOST_FOREACH(NewtonCollision* hull, collisions)
-		NewtonReleaseCollision(newton::world, hull);
-
-	result->m_visual = visual;
+	result->create(shape->second.collision, mass, freezeState, damping);
+	result->m_visual = shape->second.visual;
 
 	return result;
 }
 
+void __Convex::freeShapes()
+{
+	for (std::map<std::string, Shape>::iterator itr = s_shapes.begin(); itr != s_shapes.end(); ++itr) {
+		if (newton::world)
+			NewtonReleaseCollision(newton::world, itr->second.collision);
+	}
+	s_shapes.clear();
+}
+
 void __Convex::genBuffers(ogl::VertexBuffer& vbo)
 {
-	m_visual->genBuffers(vbo);
+	// the visual is shared, so the sub-buffers have to reference this object
+	m_visual->genBuffers(vbo, this);
 }
 
 
@@ -0,0 +1,132 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/physicslod.cpp
+ */
+
+#include <simulation/physicslod.hpp>
+#include <newton/util.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+
+namespace sim {
+
+/** The solver model of the world, see Simulation::init() */
+static const int ADAPTIVE_SOLVER = 1;
+
+PhysicsLod::PhysicsLod()
+	: m_started(false),
+	  m_enabled(false),
+	  m_near(0.0f),
+	  m_far(0.0f),
+	  m_speed(0.0f),
+	  m_passes(0),
+	  m_solver(ADAPTIVE_SOLVER)
+{
+	m_summary.full = m_summary.reduced = m_summary.frozen = m_summary.reducedSteps = 0;
+}
+
+void PhysicsLod::reset()
+{
+	typedef boost::unordered_map<NewtonBody*, PhysicsTier> FrozenMap;
+	for (FrozenMap::const_iterator itr = m_frozen.begin(); itr != m_frozen.end(); ++itr)
+		NewtonBodySetFreezeState(itr->first, 0);
+	if (m_enabled)
+		setSolver(ADAPTIVE_SOLVER);
+
+	m_started = m_enabled = false;
+	m_frozen.clear();
+	m_summary.full = m_summary.reduced = m_summary.frozen = m_summary.reducedSteps = 0;
+}
+
+bool PhysicsLod::isContacted(const NewtonBody* body)
+{
+	for (NewtonJoint* joint = NewtonBodyGetFirstContactJoint(body); joint;
+			joint = NewtonBodyGetNextContactJoint(body, joint)) {
+		const NewtonBody* other = NewtonJointGetBody0(joint) != body ? NewtonJointGetBody0(joint) : NewtonJointGetBody1(joint);
+		float mass, ix, iy, iz;
+		NewtonBodyGetMassMatrix(other, &mass, &ix, &iy, &iz);
+		if (mass > 0.0f && !NewtonBodyGetSleepState(other) && NewtonContactJointGetContactCount(joint))
+			return true;
+	}
+	return false;
+}
+
+void PhysicsLod::setSolver(int model)
+{
+	if (model != m_solver) {
+		NewtonSetSolverModel(newton::world, model);
+		m_solver = model;
+	}
+}
+
+void PhysicsLod::step(const Vec3f& camera, const ToppleLod& lod)
+{
+	if (!m_started) {
+		util::Config& config = util::Config::instance();
+		m_enabled = config.get("physicsLod", false);
+		m_near = config.get("physicsLodNear", 60.0f);
+		m_far = std::max(m_near, config.get("physicsLodFar", 200.0f));
+		m_speed = config.get("physicsLodSpeed", 0.5f);
+		m_passes = std::max(2, config.get("physicsLodPasses", 2));
+		m_started = true;
+	}
+	if (!m_enabled)
+		return;
+
+	const float speed = m_speed * m_speed;
+	bool fullAwake = false;
+	m_summary.full = m_summary.reduced = m_summary.frozen = 0;
+	for (NewtonBody* body = NewtonWorldGetFirstBody(newton::world); body; body = NewtonWorldGetNextBody(newton::world, body)) {
+		float mass, ix, iy, iz;
+		NewtonBodyGetMassMatrix(body, &mass, &ix, &iy, &iz);
+		if (mass <= 0.0f || NewtonBodyGetFirstJoint(body) || lod.contains(body))
+			continue;
+
+		Mat4f matrix;
+		NewtonBodyGetMatrix(body, matrix[0]);
+		const float distance = (matrix.getW() - camera).len();
+		const PhysicsTier tier = distance < m_near ? TIER_FULL : distance < m_far ? TIER_REDUCED : TIER_FROZEN;
+		switch (tier) {
+		case TIER_FULL: m_summary.full++; break;
+		case TIER_REDUCED: m_summary.reduced++; break;
+		case TIER_FROZEN: m_summary.frozen++; break;
+		}
+
+		if (NewtonBodyGetSleepState(body)) {
+			// the camera came closer than the body was frozen at
+			boost::unordered_map<NewtonBody*, PhysicsTier>::iterator itr = m_frozen.find(body);
+			if (itr != m_frozen.end() && tier < itr->second) {
+				NewtonBodySetFreezeState(body, 0);
+				m_frozen.erase(itr);
+				fullAwake |= tier == TIER_FULL;
+			}
+			continue;
+		}
+
+		// it was hit or woken otherwise
+		m_frozen.erase(body);
+		if (tier == TIER_FULL) {
+			fullAwake = true;
+			continue;
+		}
+
+		bool freeze = tier == TIER_FROZEN;
+		if (!freeze) {
+			Vec3f velocity, omega;
+			NewtonBodyGetVelocity(body, &velocity[0]);
+			NewtonBodyGetOmega(body, &omega[0]);
+			freeze = velocity.lenlen() < speed && omega.lenlen() < speed;
+		}
+		if (freeze && !isContacted(body)) {
+			NewtonBodySetFreezeState(body, 1);
+			m_frozen[body] = tier;
+		}
+	}
+
+	// the solver works on the whole world
+	setSolver(fullAwake ? ADAPTIVE_SOLVER : m_passes);
+	if (!fullAwake)
+		m_summary.reducedSteps++;
+}
+
+}
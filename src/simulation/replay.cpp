@@ -0,0 +1,485 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/replay.cpp
+ */
+
+#include <simulation/replay.hpp>
+#include <util/erroradapters.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <math.h>
+
+namespace sim {
+
+static void writeVarint(std::vector<char>& out, boost::uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+
+static bool readVarint(const char*& p, const char* end, boost::uint32_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35 && p < end; shift += 7) {
+		boost::uint32_t byte = (unsigned char)*p++;
+		value |= (byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static void writeSigned(std::vector<char>& out, boost::int32_t value)
+{
+	// zigzag encoding, small magnitudes result in small numbers
+	writeVarint(out, ((boost::uint32_t)value << 1) ^ (boost::uint32_t)(value >> 31));
+}
+
+static bool readSigned(const char*& p, const char* end, boost::int32_t& value)
+{
+	boost::uint32_t raw;
+	if (!readVarint(p, end, raw))
+		return false;
+	value = (boost::int32_t)((raw >> 1) ^ (~(raw & 1) + 1));
+	return true;
+}
+
+static boost::int32_t quantize(float value, float scale)
+{
+	return (boost::int32_t)floorf(value * scale + 0.5f);
+}
+
+static void writeVector(std::vector<char>& out, const Vec3f& v)
+{
+	for (int i = 0; i < 3; ++i)
+		writeSigned(out, quantize(v[i], REPLAY_POSITION_SCALE));
+}
+
+static bool readVector(const char*& p, const char* end, Vec3f& v)
+{
+	for (int i = 0; i < 3; ++i) {
+		boost::int32_t value;
+		if (!readSigned(p, end, value))
+			return false;
+		v[i] = value / REPLAY_POSITION_SCALE;
+	}
+	return true;
+}
+
+
+ReplayState::ReplayState()
+{
+	std::memset(pos, 0, sizeof(pos));
+	std::memset(rot, 0, sizeof(rot));
+}
+
+ReplayState::ReplayState(const Mat4f& m)
+{
+	Quatf q = m.quat();
+	for (int i = 0; i < 4; ++i)
+		rot[i] = quantize(q[i], REPLAY_ROTATION_SCALE);
+
+	pos[0] = quantize(m._41, REPLAY_POSITION_SCALE);
+	pos[1] = quantize(m._42, REPLAY_POSITION_SCALE);
+	pos[2] = quantize(m._43, REPLAY_POSITION_SCALE);
+}
+
+Mat4f ReplayState::matrix() const
+{
+	Quatf q(rot[0] / REPLAY_ROTATION_SCALE, rot[1] / REPLAY_ROTATION_SCALE,
+			rot[2] / REPLAY_ROTATION_SCALE, rot[3] / REPLAY_ROTATION_SCALE);
+	float len = sqrtf(q.a*q.a + q.b*q.b + q.c*q.c + q.d*q.d);
+	if (len > 0.0f)
+		q *= 1.0f / len;
+
+	Mat4f result = q.mat4();
+	result.setW(Vec3f(pos[0] / REPLAY_POSITION_SCALE,
+			pos[1] / REPLAY_POSITION_SCALE, pos[2] / REPLAY_POSITION_SCALE));
+	return result;
+}
+
+bool ReplayState::operator==(const ReplayState& other) const
+{
+	return std::memcmp(pos, other.pos, sizeof(pos)) == 0 &&
+			std::memcmp(rot, other.rot, sizeof(rot)) == 0;
+}
+
+
+void getReplayObjects(const ogl::SubBuffers& buffers, std::vector<const __Object*>& result)
+{
+	result.clear();
+	const __Object* last = NULL;
+	for (ogl::SubBuffers::const_iterator itr = buffers.begin(); itr != buffers.end(); ++itr) {
+		const __Object* obj = (const __Object*)(*itr)->userData;
+		// the sub-buffers of an object are consecutive
+		if (obj && obj != last)
+			result.push_back(obj);
+		last = obj;
+	}
+}
+
+
+Recorder::Recorder(const std::string& fileName, const std::string& levelFile,
+		const std::vector<const __Object*>& objects, float step)
+	: m_file(fileName.c_str(), std::ios::out | std::ios::binary),
+	  m_objects(objects),
+	  m_states(objects.size()),
+	  m_frames(0)
+{
+	if (!m_file)
+		return;
+
+	boost::uint32_t version = REPLAY_VERSION;
+	boost::uint32_t bodyCount = m_objects.size();
+	boost::uint32_t length = levelFile.size();
+
+	m_file.write(REPLAY_MAGIC, 4);
+	m_file.write((const char*)&version, sizeof(version));
+	m_file.write((const char*)&bodyCount, sizeof(bodyCount));
+	m_file.write((const char*)&step, sizeof(step));
+	m_file.write((const char*)&length, sizeof(length));
+	m_file.write(levelFile.c_str(), length);
+
+	// the live state, the level file may have been saved mid-run
+	for (unsigned i = 0; i < m_objects.size(); ++i) {
+		ReplayState state(m_objects[i]->getMatrix());
+		m_file.write((const char*)state.pos, sizeof(state.pos));
+		m_file.write((const char*)state.rot, sizeof(state.rot));
+	}
+}
+
+Recorder::~Recorder()
+{
+	if (m_file)
+		m_file.close();
+}
+
+void Recorder::addSound(const std::string& name, const Vec3f& position)
+{
+	ReplayEvent event;
+	event.type = ReplayEvent::SOUND;
+	event.sound = name;
+	event.p0 = position;
+	event.down = false;
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_events.push_back(event);
+}
+
+void Recorder::addPick(const Vec3f& p0, const Vec3f& p1, bool down)
+{
+	ReplayEvent event;
+	event.type = ReplayEvent::PICK;
+	event.p0 = p0;
+	event.p1 = p1;
+	event.down = down;
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_events.push_back(event);
+}
+
+void Recorder::record()
+{
+	if (!m_file)
+		return;
+
+	const bool keyframe = (m_frames % REPLAY_KEYFRAME_INTERVAL) == 0;
+
+	std::vector<unsigned> changed;
+	std::vector<ReplayState> states;
+	for (unsigned i = 0; i < m_objects.size(); ++i) {
+		ReplayState state(m_objects[i]->getMatrix());
+		if (keyframe || state != m_states[i]) {
+			changed.push_back(i);
+			states.push_back(state);
+		}
+	}
+
+	m_buffer.clear();
+	m_buffer.push_back(keyframe ? 1 : 0);
+	writeVarint(m_buffer, changed.size());
+
+	// keyframes are encoded relative to a zero state
+	const ReplayState zero;
+	unsigned next = 0;
+	for (unsigned i = 0; i < changed.size(); ++i) {
+		const ReplayState& base = keyframe ? zero : m_states[changed[i]];
+		writeVarint(m_buffer, changed[i] - next);
+		for (int j = 0; j < 3; ++j)
+			writeSigned(m_buffer, states[i].pos[j] - base.pos[j]);
+		for (int j = 0; j < 4; ++j)
+			writeSigned(m_buffer, states[i].rot[j] - base.rot[j]);
+		m_states[changed[i]] = states[i];
+		next = changed[i] + 1;
+	}
+
+	ReplayEvents events;
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		events.swap(m_events);
+	}
+
+	writeVarint(m_buffer, events.size());
+	for (ReplayEvents::const_iterator itr = events.begin(); itr != events.end(); ++itr) {
+		writeVarint(m_buffer, itr->type);
+		if (itr->type == ReplayEvent::SOUND) {
+			writeVarint(m_buffer, itr->sound.size());
+			m_buffer.insert(m_buffer.end(), itr->sound.begin(), itr->sound.end());
+			writeVector(m_buffer, itr->p0);
+		} else {
+			writeVarint(m_buffer, itr->down ? 1 : 0);
+			writeVector(m_buffer, itr->p0);
+			writeVector(m_buffer, itr->p1);
+		}
+	}
+
+	m_file.write(&m_buffer[0], m_buffer.size());
+	m_frames++;
+}
+
+
+/**
+ * Reads a single frame. If states is NULL, the frame is only
+ * validated and skipped.
+ *
+ * @return False, if the frame is truncated or corrupt
+ */
+static bool readFrame(const char*& p, const char* end, unsigned bodyCount,
+		std::vector<ReplayState>* states, std::vector<unsigned>* changed, ReplayEvents* events)
+{
+	if (p >= end)
+		return false;
+	const bool keyframe = *p++ != 0;
+
+	boost::uint32_t count;
+	if (!readVarint(p, end, count) || count > bodyCount)
+		return false;
+
+	const ReplayState zero;
+	unsigned next = 0;
+	for (unsigned i = 0; i < count; ++i) {
+		boost::uint32_t gap;
+		boost::int32_t delta[7];
+		if (!readVarint(p, end, gap))
+			return false;
+		for (int j = 0; j < 7; ++j)
+			if (!readSigned(p, end, delta[j]))
+				return false;
+
+		unsigned index = next + gap;
+		if (index >= bodyCount)
+			return false;
+		next = index + 1;
+
+		if (states) {
+			ReplayState& state = (*states)[index];
+			if (keyframe)
+				state = zero;
+			for (int j = 0; j < 3; ++j)
+				state.pos[j] += delta[j];
+			for (int j = 0; j < 4; ++j)
+				state.rot[j] += delta[3 + j];
+			if (changed)
+				changed->push_back(index);
+		}
+	}
+
+	boost::uint32_t eventCount;
+	if (!readVarint(p, end, eventCount))
+		return false;
+	for (unsigned i = 0; i < eventCount; ++i) {
+		ReplayEvent event;
+		boost::uint32_t type;
+		if (!readVarint(p, end, type))
+			return false;
+		event.type = (ReplayEvent::Type)type;
+		event.down = false;
+
+		if (event.type == ReplayEvent::SOUND) {
+			boost::uint32_t length;
+			if (!readVarint(p, end, length) || length > (boost::uint32_t)(end - p))
+				return false;
+			event.sound.assign(p, length);
+			p += length;
+			if (!readVector(p, end, event.p0))
+				return false;
+		} else if (event.type == ReplayEvent::PICK) {
+			boost::uint32_t down;
+			if (!readVarint(p, end, down) || !readVector(p, end, event.p0) || !readVector(p, end, event.p1))
+				return false;
+			event.down = down != 0;
+		} else {
+			return false;
+		}
+
+		if (events)
+			events->push_back(event);
+	}
+	return true;
+}
+
+Player::Player()
+	: m_bodyCount(0),
+	  m_step(1.0f),
+	  m_frame(-1),
+	  m_time(0.0f),
+	  m_speed(1.0f),
+	  m_paused(false)
+{
+}
+
+Player::~Player()
+{
+}
+
+bool Player::open(const std::string& fileName)
+{
+	/* information for error messages */
+	std::string function = "Player::open";
+	std::vector<std::string> args;
+	args.push_back(fileName);
+	/* END information for error messages */
+
+	try {
+		std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+		if (!file)
+			throw std::runtime_error("Could not open recording");
+		m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		const char* p = m_data.empty() ? NULL : &m_data[0];
+		const char* end = p + m_data.size();
+
+		boost::uint32_t version, length;
+		const size_t header = 4 + sizeof(version) + sizeof(m_bodyCount) + sizeof(m_step) + sizeof(length);
+		if (m_data.size() < header || std::memcmp(p, REPLAY_MAGIC, 4) != 0)
+			throw std::runtime_error("Not a recording");
+		p += 4;
+
+		std::memcpy(&version, p, sizeof(version)); p += sizeof(version);
+		std::memcpy(&m_bodyCount, p, sizeof(m_bodyCount)); p += sizeof(m_bodyCount);
+		std::memcpy(&m_step, p, sizeof(m_step)); p += sizeof(m_step);
+		std::memcpy(&length, p, sizeof(length)); p += sizeof(length);
+		if (version < 1 || version > REPLAY_VERSION)
+			throw std::runtime_error("Unsupported recording version");
+		if (length > (boost::uint32_t)(end - p) || m_step <= 0.0f)
+			throw std::runtime_error("Corrupt recording header");
+		m_levelFile.assign(p, length);
+		p += length;
+
+		m_initial.clear();
+		if (version >= 2) {
+			const ReplayState zero;
+			const size_t pos = sizeof(zero.pos), rot = sizeof(zero.rot);
+			if ((size_t)(end - p) / (pos + rot) < m_bodyCount)
+				throw std::runtime_error("Corrupt recording header");
+			m_initial.resize(m_bodyCount);
+			for (unsigned i = 0; i < m_bodyCount; ++i) {
+				std::memcpy(m_initial[i].pos, p, pos); p += pos;
+				std::memcpy(m_initial[i].rot, p, rot); p += rot;
+			}
+		}
+
+		// index the frames, a truncated last frame is ignored
+		m_offsets.clear();
+		m_keyframes.clear();
+		while (p < end) {
+			const size_t offset = p - &m_data[0];
+			const bool keyframe = *p != 0;
+			if (!readFrame(p, end, m_bodyCount, NULL, NULL, NULL))
+				break;
+			if (keyframe)
+				m_keyframes.push_back(m_offsets.size());
+			m_offsets.push_back(offset);
+		}
+		if (m_keyframes.empty() || m_keyframes.front() != 0)
+			throw std::runtime_error("Recording does not start with a keyframe");
+	} catch (std::runtime_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+		m_data.clear();
+		m_offsets.clear();
+		return false;
+	}
+
+	m_states.assign(m_bodyCount, ReplayState());
+	m_matrices.assign(m_bodyCount, Mat4f::identity());
+	m_frame = -1;
+	m_time = 0.0f;
+	return true;
+}
+
+bool Player::attach(const std::vector<const __Object*>& objects)
+{
+	m_indices.clear();
+	if (objects.size() != m_bodyCount)
+		return false;
+
+	// the level is saved with less precision than the states
+	for (unsigned i = 0; i < m_initial.size(); ++i)
+		if ((objects[i]->getMatrix().getW() - m_initial[i].matrix().getW()).len() > REPLAY_MATCH_DISTANCE)
+			return false;
+
+	for (unsigned i = 0; i < objects.size(); ++i)
+		m_indices[objects[i]] = i;
+	seek(0);
+	return true;
+}
+
+void Player::decode(unsigned frame, ReplayEvents* events)
+{
+	const char* p = &m_data[0] + m_offsets[frame];
+	const char* end = &m_data[0] + m_data.size();
+
+	std::vector<unsigned> changed;
+	readFrame(p, end, m_bodyCount, &m_states, &changed, events);
+	for (std::vector<unsigned>::const_iterator itr = changed.begin(); itr != changed.end(); ++itr)
+		m_matrices[*itr] = m_states[*itr].matrix();
+	m_frame = frame;
+}
+
+void Player::seek(int frame)
+{
+	if (m_offsets.empty())
+		return;
+	frame = std::max(0, std::min(frame, (int)m_offsets.size() - 1));
+	m_time = frame * m_step;
+
+	// continue from the current frame if there is no keyframe in between
+	std::vector<unsigned>::const_iterator key =
+			std::upper_bound(m_keyframes.begin(), m_keyframes.end(), (unsigned)frame) - 1;
+	int start = *key;
+	if (m_frame >= start && m_frame <= frame)
+		start = m_frame + 1;
+
+	for (int i = start; i <= frame; ++i)
+		decode(i, NULL);
+}
+
+void Player::update(float delta, ReplayEvents& events)
+{
+	if (m_offsets.empty())
+		return;
+
+	if (!m_paused)
+		m_time += delta * 1000.0f * m_speed;
+	m_time = std::max(0.0f, std::min(m_time, (m_offsets.size() - 1) * m_step));
+
+	const int frame = (int)(m_time / m_step);
+	if (frame == m_frame)
+		return;
+
+	// events are only played when moving forward at a reasonable speed
+	if (m_frame >= 0 && frame > m_frame && frame - m_frame <= REPLAY_KEYFRAME_INTERVAL) {
+		while (m_frame < frame)
+			decode(m_frame + 1, &events);
+	} else {
+		const float time = m_time;
+		seek(frame);
+		m_time = time;
+	}
+}
+
+}
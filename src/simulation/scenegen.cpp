@@ -0,0 +1,143 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/scenegen.cpp
+ */
+
+#include <simulation/scenegen.hpp>
+#include <simulation/simulation.hpp>
+#include <simulation/domino.hpp>
+#include <simulation/compound.hpp>
+#include <simulation/layout.hpp>
+#include <cmath>
+
+namespace sim {
+
+/** The angle of the first domino in a row, so that it falls over */
+static const float TILT = 0.35f;
+
+unsigned SceneGenerator::ground(float size)
+{
+	Simulation::instance().add(__RigidBody::createBox(Vec3f(0.0f, -0.5f, 0.0f), size, 1.0f, size, 0.0f, "stone"));
+	return 1;
+}
+
+unsigned SceneGenerator::dominoSpiral(unsigned count)
+{
+	const float gap = __Domino::s_domino_gap[__Object::DOMINO_MIDDLE];
+
+	// r = b * angle, the distance of two windings is 3 gaps
+	const float b = gap * 3.0f / (2.0f * PI);
+	float angle = 2.0f * PI;
+	for (unsigned i = 0; i < count; ++i) {
+		const float r = b * angle;
+		Vec3f pos(r * cos(angle), 0.0f, r * sin(angle));
+		Vec3f dir(-sin(angle), 0.0f, cos(angle));
+		Mat4f matrix(Vec3f::yAxis(), dir, pos);
+		if (i == 0)
+			matrix = Mat4f::rotX(TILT) * matrix;
+		Simulation::instance().add(__Domino::createDomino(__Object::DOMINO_MIDDLE, matrix, -1.0f, "domino"));
+
+		// advance by one gap along the arc
+		angle += gap / r;
+	}
+	return count;
+}
+
+unsigned SceneGenerator::dominoGrid(unsigned rows, unsigned cols)
+{
+	const float gap = __Domino::s_domino_gap[__Object::DOMINO_MIDDLE];
+	const float rowGap = 5.0f;
+	const Vec3f origin(-(rows * rowGap) * 0.5f, 0.0f, -(cols * gap) * 0.5f);
+	for (unsigned row = 0; row < rows; ++row) {
+		for (unsigned col = 0; col < cols; ++col) {
+			Mat4f matrix(Vec3f::yAxis(), Vec3f::zAxis(), origin + Vec3f(row * rowGap, 0.0f, col * gap));
+			if (col == 0)
+				matrix = Mat4f::rotX(TILT) * matrix;
+			Simulation::instance().add(__Domino::createDomino(__Object::DOMINO_MIDDLE, matrix, -1.0f, "domino"));
+		}
+	}
+	return rows * cols;
+}
+
+unsigned SceneGenerator::boxStacks(unsigned stacks, unsigned height)
+{
+	const float size = 1.0f;
+	const unsigned perRow = (unsigned)ceil(sqrt((float)stacks));
+	for (unsigned s = 0; s < stacks; ++s) {
+		const float x = (s % perRow) * size * 3.0f;
+		const float z = (s / perRow) * size * 3.0f;
+		for (unsigned h = 0; h < height; ++h) {
+			Vec3f pos(x, size * 0.5f + h * size * 1.001f, z);
+			Simulation::instance().add(__RigidBody::createBox(pos, size, size, size, 1.0f, "crate"));
+		}
+	}
+	return stacks * height;
+}
+
+unsigned SceneGenerator::tenpinPyramids(unsigned pyramids, unsigned rows)
+{
+	// the tenpin model is lying, see data/levels/bowling.xml
+	const Mat4f rot = Mat4f::rotX(-PI * 0.5f);
+	const float spacing = 1.5f;
+	const float height = 2.84f;
+	unsigned count = 0;
+	for (unsigned p = 0; p < pyramids; ++p) {
+		const float offset = p * (rows + 2) * spacing;
+		for (unsigned i = 1; i <= rows; ++i) {
+			for (unsigned j = 0; j < i; ++j) {
+				Mat4f matrix = rot * Mat4f::translate(offset + j * spacing - i * spacing * 0.5f, height, -(float)i * spacing);
+				Simulation::instance().add(__Convex::createHull(matrix, 2.0f, "tire", "data/models/tenpin.3ds"));
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+unsigned SceneGenerator::hingedChains(unsigned chains, unsigned links)
+{
+	const float length = 2.0f;
+	const float height = links * length + 2.0f;
+	for (unsigned c = 0; c < chains; ++c) {
+		Compound compound = __Compound::createCompound();
+		Object anchor = __RigidBody::createBox(Vec3f(0.0f, height, 0.0f), 0.5f, 0.5f, 0.5f, 0.0f, "metal");
+		compound->add(anchor);
+
+		Object parent = anchor;
+		for (unsigned l = 0; l < links; ++l) {
+			Vec3f pos((l + 0.5f) * length, height, 0.0f);
+			Object link = __RigidBody::createBox(pos, length * 0.9f, 0.3f, 0.3f, 1.0f, "rope");
+			compound->add(link);
+			compound->createHinge(Vec3f(l * length, height, 0.0f), Vec3f::zAxis(), link, parent);
+			parent = link;
+		}
+
+		Simulation::instance().add(compound);
+		compound->setMatrix(compound->getMatrix() * Mat4f::translate(0.0f, 0.0f, c * 2.0f));
+	}
+	return chains;
+}
+
+unsigned SceneGenerator::generate(const std::string& name, unsigned scale)
+{
+	if (scale < 1)
+		scale = 1;
+
+	if (name == "spiral") return dominoSpiral(500 * scale);
+	if (name == "grid") return dominoGrid(10 * scale, 50);
+	if (name == "stacks") return boxStacks(25 * scale, 10);
+	if (name == "tenpins") return tenpinPyramids(4 * scale, 4);
+	if (name == "chains") return hingedChains(10 * scale, 10);
+
+	if (name == "field" || name == "tree" || name == "lanes") {
+		LayoutParams params;
+		params.generator = name;
+		params.count = 10000 * scale;
+		return LayoutGenerator::create(params);
+	}
+	if (name.size() > 4 && name.compare(name.size() - 4, 4, ".xml") == 0)
+		return LayoutGenerator::load(name, scale);
+	return 0;
+}
+
+}
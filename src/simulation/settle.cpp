@@ -0,0 +1,162 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/settle.cpp
+ */
+
+#include <simulation/settle.hpp>
+#include <newton/util.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+
+namespace sim {
+
+SettleManager::SettleManager()
+	: m_started(false),
+	  m_enabled(false),
+	  m_speed(0.0f),
+	  m_steps(0),
+	  m_margin(0.0f),
+	  m_settled(0)
+{
+}
+
+void SettleManager::reset()
+{
+	restore();
+	m_started = m_enabled = false;
+	m_bodies.clear();
+}
+
+void SettleManager::settle(NewtonBody* body, BodyInfo& info)
+{
+	NewtonBodyGetMassMatrix(body, &info.mass, &info.inertia.x, &info.inertia.y, &info.inertia.z);
+	NewtonBodySetMassMatrix(body, 0.0f, 0.0f, 0.0f, 0.0f);
+
+	// it is no part of the ground, the height cache stays valid
+	newton::setDemoted(body, true);
+
+	const Vec3f zero;
+	NewtonBodySetVelocity(body, &zero[0]);
+	NewtonBodySetOmega(body, &zero[0]);
+	info.settled = true;
+	m_settled++;
+}
+
+void SettleManager::restore(NewtonBody* body, BodyInfo& info)
+{
+	NewtonBodySetMassMatrix(body, info.mass, info.inertia.x, info.inertia.y, info.inertia.z);
+	NewtonBodySetFreezeState(body, 0);
+	newton::setDemoted(body, false);
+	info.settled = false;
+	info.steps = 0;
+	m_settled--;
+}
+
+void SettleManager::collectBody(const NewtonBody* body, void* userData)
+{
+	((std::vector<NewtonBody*>*)userData)->push_back(const_cast<NewtonBody*>(body));
+}
+
+void SettleManager::step(const ToppleLod& lod, const PhysicsLod& physics)
+{
+	if (!m_started) {
+		util::Config& config = util::Config::instance();
+		m_enabled = config.get("settleBodies", false);
+		m_speed = config.get("settleSpeed", 0.1f);
+		m_steps = std::max(1, config.get("settleSteps", 50));
+		m_margin = config.get("settleMargin", 0.5f);
+		m_started = true;
+	}
+	if (!m_enabled)
+		return;
+
+	// count the steps of the slow bodies, and collect the fast ones
+	const float speed = m_speed * m_speed;
+	std::vector<NewtonBody*> moving, resting;
+	for (NewtonBody* body = NewtonWorldGetFirstBody(newton::world); body; body = NewtonWorldGetNextBody(newton::world, body)) {
+		float mass, ix, iy, iz;
+		NewtonBodyGetMassMatrix(body, &mass, &ix, &iy, &iz);
+		if (mass <= 0.0f || physics.isFrozen(body))
+			continue;
+
+		// a frozen body keeps its velocity, sleeping is no proof of rest
+		Vec3f velocity, omega;
+		NewtonBodyGetVelocity(body, &velocity[0]);
+		NewtonBodyGetOmega(body, &omega[0]);
+		const bool slow = velocity.lenlen() < speed && omega.lenlen() < speed;
+		if (!slow)
+			moving.push_back(body);
+
+		// joints would pull at a static body, the level of detail has its own dominoes
+		if (NewtonBodyGetFirstJoint(body) || lod.contains(body))
+			continue;
+
+		BodyMap::iterator itr = m_bodies.find(body);
+		if (itr == m_bodies.end()) {
+			BodyInfo info;
+			info.steps = 0;
+			info.settled = false;
+			info.mass = mass;
+			itr = m_bodies.insert(std::make_pair(body, info)).first;
+		}
+		itr->second.steps = slow ? itr->second.steps + 1 : 0;
+		if (itr->second.steps >= m_steps)
+			resting.push_back(body);
+	}
+
+	// the moving bodies wake the settled ones they come close to
+	const Vec3f margin(m_margin, m_margin, m_margin);
+	for (std::vector<NewtonBody*>::const_iterator itr = moving.begin(); itr != moving.end(); ++itr) {
+		Vec3f min, max;
+		NewtonBodyGetAABB(*itr, &min[0], &max[0]);
+		restore(min - margin, max + margin);
+	}
+
+	for (std::vector<NewtonBody*>::const_iterator itr = resting.begin(); itr != resting.end(); ++itr)
+		settle(*itr, m_bodies[*itr]);
+}
+
+void SettleManager::restore()
+{
+	for (BodyMap::iterator itr = m_bodies.begin(); itr != m_bodies.end(); ++itr)
+		if (itr->second.settled)
+			restore(itr->first, itr->second);
+}
+
+unsigned SettleManager::restore(const Vec3f& min, const Vec3f& max)
+{
+	if (!m_settled)
+		return 0;
+
+	std::vector<NewtonBody*> bodies;
+	NewtonWorldForEachBodyInAABBDo(newton::world, &min[0], &max[0], collectBody, &bodies);
+
+	unsigned result = 0;
+	for (std::vector<NewtonBody*>::const_iterator itr = bodies.begin(); itr != bodies.end(); ++itr) {
+		BodyMap::iterator body = m_bodies.find(*itr);
+		if (body != m_bodies.end() && body->second.settled) {
+			restore(body->first, body->second);
+			result++;
+		}
+	}
+	return result;
+}
+
+bool SettleManager::restoreRay(const Vec3f& p0, const Vec3f& p1)
+{
+	NewtonBody* body = newton::getRayCastBody(p0, p1 - p0);
+	BodyMap::iterator itr = m_bodies.find(body);
+	if (!body || itr == m_bodies.end() || !itr->second.settled)
+		return false;
+
+	restore(body, itr->second);
+	return true;
+}
+
+bool SettleManager::isSettled(const NewtonBody* body) const
+{
+	BodyMap::const_iterator itr = m_bodies.find(const_cast<NewtonBody*>(body));
+	return itr != m_bodies.end() && itr->second.settled;
+}
+
+}
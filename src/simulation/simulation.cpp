@@ -16,13 +16,21 @@
 #include <opengl/shader.hpp>
 #include <iostream>
 #include <newton/util.hpp>
+#include <newton/stats.hpp>
+#include <newton/heightcache.hpp>
 #include <simulation/domino.hpp>
 #include <simulation/crspline.hpp>
+#include <simulation/template.hpp>
 #include <opengl/oglutil.hpp>
+#include <opengl/gpuprofiler.hpp>
 #include <util/config.hpp>
+#include <util/profiler.hpp>
+#include <util/memory.hpp>
 #include <util/threadcounter.hpp>
 #include <util/tostring.hpp>
+#include <util/hash.hpp>
 #include <stdlib.h>
+#include <algorithm>
 #include <sound/soundmgr.hpp>
 
 
@@ -77,30 +85,8 @@ Object ObjectInfo::create(const Mat4f& matrix) const
 	case __Object::COMPOUND:
 	case __Object::CONVEX_ASSEMBLY:
 	case __Object::CONVEX_HULL:
-		{
-			using namespace rapidxml;
-
-			file<char> f(fileName.c_str());
-
-			char* m = f.data();
-
-			/// @todo add exception handling
-			xml_document<> doc;
-			doc.parse<0>(m);
-
-			// this is important so we don't parse the template tag but the object or compound tag
-			xml_node<>* nodes = doc.first_node();
-
-			// only the first tag is loaded the rest will be ignored
-			xml_node<>* node = nodes->first_node();
-			std::string type(node->name());
-
-			if (type == "object" || type == "compound") {
-				result = __Object::load(node);
-				if (result) result->setMatrix(matrix);
-				return result;
-			}
-		}
+		// templates are parsed only once, see TemplateMgr
+		result = TemplateMgr::instance().create(fileName, matrix);
 		break;
 	default:
 		break;
@@ -109,10 +95,11 @@ Object ObjectInfo::create(const Mat4f& matrix) const
 }
 
 void Simulation::createInstance(util::KeyAdapter& keyAdapter,
-								util::MouseAdapter& mouseAdapter)
+								util::MouseAdapter& mouseAdapter,
+								bool headless)
 {
 	destroyInstance();
-	s_instance = new Simulation(keyAdapter, mouseAdapter);
+	s_instance = new Simulation(keyAdapter, mouseAdapter, headless);
 	s_instance->m_newObjectType = __Object::NONE;
 	s_instance->m_newObjectMaterial = "yellow";
 	s_instance->m_newObjectFilename = "";
@@ -128,21 +115,35 @@ void Simulation::destroyInstance()
 }
 
 Simulation::Simulation(util::KeyAdapter& keyAdapter,
-						util::MouseAdapter& mouseAdapter)
+						util::MouseAdapter& mouseAdapter,
+						bool headless)
 	: m_keyAdapter(keyAdapter),
 	  m_mouseAdapter(mouseAdapter),
-	  m_nextID(0)
+	  m_nextID(0),
+	  m_objectBytes(0),
+	  m_recorder(NULL),
+	  m_player(NULL),
+	  m_exporter(NULL),
+	  m_toppleColors(false),
+	  m_chainColors(false),
+	  m_editKnot(-1)
 {
 	m_interactionTypes[util::LEFT] = INT_NONE;
 	m_interactionTypes[util::RIGHT] = INT_CREATE_OBJECT;
 	m_interactionTypes[util::MIDDLE] = INT_DOMINO_CURVE;
 	newton::world = NULL;
+	newton::installMemorySystem();
 	m_enabled = true;
+	m_headless = headless;
+	m_deterministic = util::Config::instance().get("deterministic", false);
+	m_deterministicSteps = std::max(1, util::Config::instance().get("deterministicSteps", 1));
+	m_placementFilter = util::Config::instance().get("placeOnDynamicBodies", false) ?
+			newton::HEIGHT_ALL : newton::HEIGHT_STATIC;
 	newton::gravity = -9.81f * 4.0f;
 	m_mouseAdapter.addListener(this);
 	m_environment = Object();
 	m_lightPos = Vec4f(100.0f, 500.0f, 700.0f, 0.0f);
-	m_useShadows = util::Config::instance().get("enableShadows", false);
+	m_useShadows = util::Config::instance().get("enableShadows", false) && !m_headless;
 	if (m_useShadows)
 		m_shadow = ogl::createShadowFBO(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
 }
@@ -198,6 +199,10 @@ void Simulation::save(const std::string& fileName)
 		__Object::save(*itr->get(), level, &doc);
 	}
 
+	// the paths reference their dominoes by id
+	for (std::list<DominoPath>::iterator path = m_paths.begin(); path != m_paths.end(); ++path)
+		__DominoPath::save(**path, level, &doc);
+
 	// save attribute "environment" __treecollision.save(m_environment)
 	if (m_environment)
 		__TreeCollision::save((__TreeCollision&)*m_environment.get(), level, &doc);
@@ -216,6 +221,21 @@ void Simulation::save(const std::string& fileName)
 
 }
 
+/**
+ * Collects the materials of the given level node and all its children.
+ *
+ * @param node      The XML node
+ * @param materials The set in which the material names are stored
+ */
+static void collectMaterials(rapidxml::xml_node<>* node, std::set<std::string>& materials)
+{
+	rapidxml::xml_attribute<>* attr = node->first_attribute("material");
+	if (attr)
+		materials.insert(attr->value());
+	for (rapidxml::xml_node<>* child = node->first_node(); child; child = child->next_sibling())
+		collectMaterials(child, materials);
+}
+
 void Simulation::load(const std::string& fileName)
 {
 	/* information for error messages */
@@ -280,16 +300,42 @@ void Simulation::load(const std::string& fileName)
 				m_camera.update();
 			}
 
-			// iterate over all nodes
+			// load the textures of all materials used in the level at once
+			std::set<std::string> materials, textures;
+			collectMaterials(nodes, materials);
+			for (std::set<std::string>::iterator itr = materials.begin(); itr != materials.end(); ++itr) {
+				const Material* mat = MaterialMgr::instance().get(*itr);
+				if (mat) {
+					textures.insert(mat->texture);
+					textures.insert(mat->texture1);
+				}
+			}
+			if (!m_headless)
+				ogl::TextureMgr::instance().prefetch(textures);
+
+			// iterate over all nodes, the objects keep their ids and are uploaded at once
+			ObjectList::iterator begin = m_objects.end();
 			for (xml_node<>* node = nodes->first_node(); node; node = node->next_sibling()) {
 				std::string type(node->name());
 				if (type == "object" || type == "compound") {
 					Object object = __Object::load(node);
 					// load m_id from "id"
 					object->setID(atoi(node->first_attribute("id")->value()));
-					add(object, object->getID());
+					ObjectList::iterator inserted = m_objects.insert(m_objects.end(), object);
+					if (begin == m_objects.end())
+						begin = inserted;
+					m_nextID = std::max(m_nextID, object->getID() + 1);
 				}
 			}
+			upload(begin, m_objects.end());
+
+			// load the paths after all of their dominoes
+			std::map<int, Domino> dominoes;
+			for (ObjectList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr)
+				if ((*itr)->getType() <= __Object::DOMINO_LARGE)
+					dominoes[(*itr)->getID()] = std::tr1::static_pointer_cast<__Domino>(*itr);
+			for (xml_node<>* node = nodes->first_node("path"); node; node = node->next_sibling("path"))
+				m_paths.push_back(__DominoPath::load(node, dominoes));
 
 			// load "environment" and create tree collision from it
 			xml_node<>* node = nodes->first_node("environment");
@@ -313,6 +359,102 @@ void Simulation::load(const std::string& fileName)
 	delete f;
 }
 
+bool Simulation::startRecording(const std::string& fileName)
+{
+	stopReplay();
+	stopRecording();
+
+	// the playback loads the level, the bodies are rendered in the order
+	// they are saved, so the live state is recorded without a round trip
+	const std::string levelFile = fileName + ".xml";
+	save(levelFile);
+
+	std::vector<const __Object*> objects;
+	getReplayObjects(m_vbo.m_buffers, objects);
+	m_recorder = new Recorder(fileName, levelFile, objects, SIMULATION_STEP);
+	if (!m_recorder->isOpen()) {
+		std::vector<std::string> args;
+		args.push_back(fileName);
+		util::ErrorAdapter::instance().displayErrorMessage("Simulation::startRecording", args);
+		stopRecording();
+		return false;
+	}
+	return true;
+}
+
+void Simulation::stopRecording()
+{
+	if (m_recorder) {
+		std::cout << "Recorded " << m_recorder->getFrameCount() << " frames" << std::endl;
+		delete m_recorder;
+	}
+	m_recorder = NULL;
+}
+
+bool Simulation::startExport(const std::string& baseName, unsigned interval)
+{
+	stopExport();
+
+	if (!interval)
+		interval = util::Config::instance().get("exportInterval", 1);
+	float minImpactSpeed = util::Config::instance().get("exportImpactSpeed", 1.0f);
+
+	m_exporter = new Exporter(baseName, interval, minImpactSpeed);
+	if (!m_exporter->isOpen()) {
+		std::vector<std::string> args;
+		args.push_back(baseName);
+		util::ErrorAdapter::instance().displayErrorMessage("Simulation::startExport", args);
+		stopExport();
+		return false;
+	}
+	return true;
+}
+
+void Simulation::stopExport()
+{
+	if (m_exporter)
+		delete m_exporter;
+	m_exporter = NULL;
+}
+
+bool Simulation::startReplay(const std::string& fileName)
+{
+	stopRecording();
+	stopReplay();
+
+	Player* player = new Player();
+	if (!player->open(fileName)) {
+		delete player;
+		return false;
+	}
+
+	const ogl::Camera camera = m_camera;
+	load(player->getLevelFile());
+	m_camera = camera;
+
+	std::vector<const __Object*> objects;
+	getReplayObjects(m_vbo.m_buffers, objects);
+	if (!player->attach(objects)) {
+		std::vector<std::string> args;
+		args.push_back(fileName);
+		args.push_back(player->getLevelFile());
+		util::ErrorAdapter::instance().displayErrorMessage("Simulation::startReplay", args);
+		delete player;
+		return false;
+	}
+
+	m_enabled = false;
+	m_player = player;
+	return true;
+}
+
+void Simulation::stopReplay()
+{
+	if (m_player)
+		delete m_player;
+	m_player = NULL;
+}
+
 void Simulation::init()
 {
 	clear();
@@ -321,7 +463,9 @@ void Simulation::init()
 	newton::world = NewtonCreate();
 	NewtonWorldSetUserData(newton::world, this);
 
-	NewtonSetPlatformArchitecture(newton::world, 3);
+	// the generic code path and a single thread produce the same results
+	// on every machine, the optimized paths differ between CPUs
+	NewtonSetPlatformArchitecture(newton::world, m_deterministic ? 0 : 3);
 
 	// set a fixed world size
 	Vec3f minSize(-2000.0f, -2000.0f, -2000.0f);
@@ -330,14 +474,16 @@ void Simulation::init()
 
 	NewtonSetSolverModel(newton::world, 1);
 	NewtonSetFrictionModel(newton::world, 1);
-	NewtonSetThreadsCount(newton::world, util::getThreadCount());
+	NewtonSetThreadsCount(newton::world, m_deterministic ? 1 : util::getThreadCount());
 	NewtonSetMultiThreadSolverOnSingleIsland(newton::world, 0);
+	newton::Stats::instance().install(newton::world);
 
 	int id = NewtonMaterialGetDefaultGroupID(newton::world);
 	NewtonMaterialSetCollisionCallback(newton::world, id, id, NULL, NULL, MaterialMgr::GenericContactCallback);
 
 	__Domino::genDominoBuffers(m_vbo);
-	m_skydome.load(2000.0f, "clouds", "skydome", "data/models/skydome.3ds", "flares");
+	if (!m_headless)
+		m_skydome.load(2000.0f, "clouds", "skydome", "data/models/skydome.3ds", "flares");
 
 	//m_environment = Object(new __TreeCollision(Mat4f::translate(0.0f, 0.0f, 0.0f), "data/models/spielplatz.3ds"));
 
@@ -679,19 +825,80 @@ void Simulation::init()
 
 void Simulation::clear()
 {
+	stopRecording();
+	stopReplay();
+	stopExport();
+	resetAnalysis();
 	m_selectedObject = Object();
+	m_paths.clear();
+	m_editPath = DominoPath();
+	m_editKnot = -1;
 	m_sortedBuffers.clear();
 	m_vbo.flush();
 	m_objects.clear();
+	m_objectBytes = 0;
+	m_nextID = 0;
 	m_environment = Object();
+	newton::HeightCache::instance().clear();
+	newton::clearDemoted();
 	__Domino::freeCollisions();
-	m_skydome.clear();
+	__Convex::freeShapes();
+	TemplateMgr::instance().freePrototypes();
+	if (!m_headless)
+		m_skydome.clear();
 	if (newton::world) {
 		std::cout << "Remaining bodies: " << NewtonWorldGetBodyCount(newton::world) << std::endl;
 		NewtonDestroy(newton::world);
 		std::cout << "Remaining memory: " << NewtonGetMemoryUsed() << std::endl;
+		util::MemoryStats::instance().report(std::cout);
 	}
 	newton::world = NULL;
+	util::MemoryStats::instance().set(util::MemoryStats::OBJECTS, 0);
+}
+
+/** @return The size of an object of the given type, without its shared data */
+static size_t getObjectSize(__Object::Type type)
+{
+	switch (type) {
+	case __Object::DOMINO_SMALL:
+	case __Object::DOMINO_MIDDLE:
+	case __Object::DOMINO_LARGE:
+		return sizeof(__Domino);
+	case __Object::COMPOUND:
+		return sizeof(__Compound);
+	case __Object::CONVEX_HULL:
+	case __Object::CONVEX_ASSEMBLY:
+		return sizeof(__Convex);
+	case __Object::TREE_COLLISION:
+		return sizeof(__TreeCollision);
+	default:
+		return sizeof(__RigidBody);
+	}
+}
+
+/**
+ * @return The size of an object, of its sub-buffers between begin and end
+ *         and of the children it renders, e.g. the nodes of a compound
+ */
+static size_t getObjectBytes(__Object& object, const ogl::SubBuffers::iterator& begin,
+		const ogl::SubBuffers::iterator& end)
+{
+	size_t bytes = sizeof(Object);
+	if (object.getType() == __Object::COMPOUND)
+		bytes += getObjectSize(__Object::COMPOUND);
+
+	// the sub-buffers of a rendered object are consecutive
+	const __Object* last = NULL;
+	for (ogl::SubBuffers::iterator itr = begin; itr != end; ++itr) {
+		__Object* rendered = (__Object*)(*itr)->userData;
+		if (!rendered || !object.contains(rendered))
+			continue;
+		bytes += sizeof(ogl::SubBuffer);
+		if (rendered != last)
+			bytes += getObjectSize(rendered->getType());
+		last = rendered;
+	}
+	return bytes;
 }
 
 int Simulation::add(const Object& object)
@@ -713,6 +920,28 @@ int Simulation::add(const Object& object, int id)
 	return id;
 }
 
+int Simulation::add(const std::vector<Object>& objects)
+{
+	if (objects.empty())
+		return -1;
+
+	const int first = m_nextID;
+	ObjectList::iterator begin = m_objects.end();
+	for (std::vector<Object>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		if (!itr->get())
+			continue;
+		(*itr)->setID(m_nextID++);
+		ObjectList::iterator inserted = m_objects.insert(m_objects.end(), *itr);
+		if (begin == m_objects.end())
+			begin = inserted;
+	}
+
+	if (begin == m_objects.end())
+		return -1;
+	upload(begin, m_objects.end());
+	return first;
+}
+
 int Simulation::add(const ObjectInfo& info)
 {
 	Mat4f matrix(Vec3f::yAxis(), m_camera.viewVector(), m_pointer);
@@ -724,6 +953,13 @@ int Simulation::add(const ObjectInfo& info)
 
 void Simulation::remove(const Object& object)
 {
+	// the recorder references the bodies in the order of the buffers
+	stopRecording();
+	resetAnalysis();
+	invalidateHeights(object);
+	if (object != m_environment)
+		m_objectBytes -= getObjectBytes(*object, m_vbo.m_buffers.begin(), m_vbo.m_buffers.end());
+
 	// check if it is a compound, if so we have to check whether
 	// one of its children is in a sub-mesh
 
@@ -821,6 +1057,11 @@ void Simulation::remove(const Object& object)
 	} /* end check if object is domino */
 
 	m_objects.remove(object);
+	if (object->getType() <= __Object::DOMINO_LARGE) {
+		for (std::list<DominoPath>::iterator path = m_paths.begin(); path != m_paths.end(); ++path)
+			if ((*path)->remove(object.get()))
+				break;
+	}
 
 	if (m_environment == object)
 		m_environment = Object();
@@ -832,6 +1073,68 @@ void Simulation::remove(const Object& object)
 	upload(m_objects.end(), m_objects.end());
 }
 
+void Simulation::remove(const std::vector<Object>& objects, bool unlink)
+{
+	if (objects.empty())
+		return;
+
+	// only dominoes are removed in one pass, their vertex data is shared
+	std::set<const __Object*> dominoes;
+	for (std::vector<Object>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		if ((*itr)->getType() <= __Object::DOMINO_LARGE)
+			dominoes.insert(itr->get());
+		else
+			remove(*itr);
+	}
+	if (dominoes.empty())
+		return;
+
+	stopRecording();
+	resetAnalysis();
+	for (ogl::SubBuffers::iterator it = m_vbo.m_buffers.begin(); it != m_vbo.m_buffers.end(); ) {
+		if (dominoes.count((const __Object*)(*it)->userData)) {
+			m_objectBytes -= sizeof(ogl::SubBuffer);
+			delete (*it);
+			it = m_vbo.m_buffers.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for (ObjectList::iterator itr = m_objects.begin(); itr != m_objects.end(); ) {
+		if (dominoes.count(itr->get())) {
+			invalidateHeights(*itr);
+			m_objectBytes -= sizeof(Object) + getObjectSize((*itr)->getType());
+			if (m_selectedObject == *itr)
+				m_selectedObject = Object();
+			itr = m_objects.erase(itr);
+		} else {
+			++itr;
+		}
+	}
+
+	// one pass over the dominoes of each path
+	if (unlink)
+		for (std::list<DominoPath>::iterator path = m_paths.begin(); path != m_paths.end(); ++path)
+			(*path)->remove(dominoes);
+
+	upload(m_objects.end(), m_objects.end());
+}
+
+DominoPath Simulation::addPath(const std::vector<Vec2f>& knots, __Object::Type type, const std::string& material, float gap)
+{
+	DominoPath path(new __DominoPath(knots, type, material, gap));
+	m_paths.push_back(path);
+	updatePath(path);
+	return path;
+}
+
+void Simulation::updatePath(const DominoPath& path)
+{
+	path->update(m_placementFilter);
+	resetAnalysis();
+}
+
 static bool isSharedBuffer(const ogl::SubBuffer* const buffer)
 {
 	return buffer->userData == NULL;
@@ -839,13 +1142,52 @@ static bool isSharedBuffer(const ogl::SubBuffer* const buffer)
 
 void Simulation::upload(const ObjectList::iterator& begin, const ObjectList::iterator& end)
 {
-	for (ObjectList::iterator itr = begin; itr != end; ++itr)
+	for (ObjectList::iterator itr = begin; itr != end; ++itr) {
+		// the objects append their sub-buffers
+		ogl::SubBuffers::iterator first = m_vbo.m_buffers.end();
+		if (!m_vbo.m_buffers.empty())
+			--first;
 		(*itr)->genBuffers(m_vbo);
+		first = first == m_vbo.m_buffers.end() ? m_vbo.m_buffers.begin() : ++first;
+		m_objectBytes += getObjectBytes(**itr, first, m_vbo.m_buffers.end());
+		invalidateHeights(*itr);
+	}
 
-	m_vbo.upload();
+	if (!m_headless)
+		m_vbo.upload();
+	else
+		m_vbo.account();
 	m_sortedBuffers.assign(m_vbo.m_buffers.begin(), m_vbo.m_buffers.end());
 	m_sortedBuffers.remove_if(isSharedBuffer);
 	m_sortedBuffers.sort();
+	resetAnalysis();
+
+	// the rendered objects include the children of compounds, the vertex
+	// data and the bodies are accounted separately. add() and remove()
+	// keep the tally, so it does not depend on the number of objects
+	util::MemoryStats::instance().set(util::MemoryStats::OBJECTS, m_objectBytes);
+}
+
+void Simulation::resetAnalysis()
+{
+	m_physicsLod.reset();
+	m_settle.reset();
+	m_toppleLod.reset();
+	m_topple.reset();
+	m_chainCheck.reset();
+}
+
+void Simulation::invalidateHeights(const Object& object)
+{
+	m_chainCheck.reset();
+
+	// the cache only holds static bodies, compounds may have static nodes
+	if (object->getType() != __Object::COMPOUND && object->getMass() > 0.0f)
+		return;
+
+	Vec3f min, max;
+	object->getAABB(min, max);
+	newton::HeightCache::instance().invalidate(min, max);
 }
 
 void Simulation::updateObject(const Object& object)
@@ -895,6 +1237,11 @@ void Simulation::mouseMove(int x, int y)
 		m_camera.rotate(angleY, m_camera.m_strafe);
 	} else if (m_mouseAdapter.isDown(util::RIGHT) && m_enabled) {
 		newton::mousePick(m_camera, Vec2f(x, y), m_mouseAdapter.isDown(util::RIGHT));
+		if (m_recorder) {
+			Vec3f p0, p1;
+			ogl::getScreenRay(Vec2d(x, y), p0, p1, m_camera);
+			m_recorder->addPick(p0, p1, true);
+		}
 	}
 
 	util::Button button = util::LEFT;
@@ -918,6 +1265,9 @@ void Simulation::mouseMove(int x, int y)
 		Vec3f pos1 = m_camera.pointer(m_mouseAdapter.getX(), m_mouseAdapter.getY());
 		Vec3f pos2 = m_camera.pointer(x, y);
 
+		// the ground below the old and the new position
+		invalidateHeights(m_selectedObject);
+
 		if (m_interactionTypes[button] == INT_ROTATE) {
 			//rot_drag_cur = pos2;
 			rot_drag_cur = rot_mat_start.getW() + (pos2-rot_mat_start.getW()).normalized() * (rot_drag_start-rot_mat_start.getW()).len();
@@ -969,8 +1319,15 @@ void Simulation::mouseMove(int x, int y)
 				m_selectedObject->convexCastPlacement();
 			}
 		} /* end MOVE_GROUND, MOVE_BILLBOARD */
+
+		invalidateHeights(m_selectedObject);
 	} /* end selectedObject && !enabled */
 
+	if (m_interactionTypes[button] == INT_EDIT_PATH && m_editPath && !m_enabled) {
+		const Vec3f pos = m_camera.pointer(x, y);
+		m_editPath->knots()[m_editKnot] = Vec2f(pos.x, pos.z);
+	}
+
 	m_pointer = m_camera.pointer(x, y);
 }
 
@@ -994,8 +1351,42 @@ void Simulation::mouseButton(util::Button button, bool down, int x, int y)
 		curve_spline.knots().push_back(Vec2f(m_pointer.x, m_pointer.z));
 	}
 
+	// pick the knot of a path, its dominoes follow when it is released
+	if (m_interactionTypes[button] == INT_EDIT_PATH && !m_enabled) {
+		if (down) {
+			const Vec2f pos(m_pointer.x, m_pointer.z);
+			float radius = 1.5f;
+			for (std::list<DominoPath>::iterator path = m_paths.begin(); path != m_paths.end(); ++path) {
+				const int knot = (*path)->getKnot(pos, radius);
+				if (knot >= 0) {
+					radius = ((*path)->knots()[knot] - pos).len();
+					m_editPath = *path;
+					m_editKnot = knot;
+				}
+			}
+		} else if (m_editPath) {
+			updatePath(m_editPath);
+			m_editPath = DominoPath();
+			m_editKnot = -1;
+		}
+	}
+
 	if (button == util::RIGHT && m_enabled) {
+		// static dominoes and settled bodies cannot be picked
+		if (down && (m_toppleLod.isEnabled() || m_settle.isEnabled())) {
+			Vec3f p0, p1;
+			ogl::getScreenRay(Vec2d(x, y), p0, p1, m_camera);
+			if (m_toppleLod.isEnabled())
+				m_toppleLod.promote(p0, p1);
+			if (m_settle.isEnabled())
+				m_settle.restoreRay(p0, p1);
+		}
 		newton::mousePick(m_camera, Vec2f(x, y), down);
+		if (m_recorder) {
+			Vec3f p0, p1;
+			ogl::getScreenRay(Vec2d(x, y), p0, p1, m_camera);
+			m_recorder->addPick(p0, p1, down);
+		}
 		//newton::applyExplosion(m_world, m_pointer, 30.0f, 20.0f);
 	}
 }
@@ -1031,37 +1422,10 @@ void Simulation::mouseDoubleClick(util::Button button, int x, int y)
 				}
 			}
 		}
-		curve_spline.update();
-		// spline
-		if (curve_spline.knots().size() > 2) {
-			curve_spline.update();
-			Domino domino;
-			for (float t = 0.0f; t < curve_spline.table().back().len; t += gap) {
-				Vec3f p = curve_spline.getPos(t);
-				Vec3f q = curve_spline.getTangent(t).normalized();
-				if (domino && (t + gap) < curve_spline.table().back().len)
-					q = (curve_spline.getPos(t-gap) - curve_spline.getPos(t+gap)).normalized();
-				Mat4f matrix(Vec3f::yAxis(), q, p);
-				//Mat4f matrix = Mat4f::gramSchmidt(q, p);
-				domino = __Domino::createDomino(type, matrix, -1.0f, m_newObjectMaterial);
-				add(domino);
-			}
-		// line
-		} else if (curve_spline.knots().size() == 2) {
-			Vec3f start = curve_spline.knots()[0].xz3(0.0f);
-			start.y = newton::getVerticalPosition(start.x, start.z);
-			Vec3f end = curve_spline.knots()[1].xz3(0.0f);
-			end.y = newton::getVerticalPosition(end.x, end.z);
-			Vec3f dir = (end - start);
-			float len = dir.normalize();
-			Mat4f matrix(Vec3f::yAxis(), dir, start);
-			//Mat4f matrix = Mat4f::gramSchmidt(dir, start);
-			for (float d = 0.0f; d <= len; d += gap) {
-				matrix.setW(start + dir * d);
-				Domino domino = __Domino::createDomino(type, matrix, -1.0f, m_newObjectMaterial);
-				add(domino);
-			}
-		}
+		// the path places its dominoes and keeps the knots for editing
+		if (curve_spline.knots().size() >= 2)
+			addPath(curve_spline.knots(), type, m_newObjectMaterial, gap);
+
 		curve_spline.knots().clear();
 		curve_spline.update();
 	}
@@ -1083,8 +1447,41 @@ void Simulation::mouseWheel(int delta) {
 	}
 }
 
+void Simulation::step()
+{
+	const float timestep = (SIMULATION_STEP / 1000.0f) * 20.0f;
+	newton::Stats::instance().update(newton::world, timestep);
+	if (m_recorder)
+		m_recorder->record();
+	if (m_exporter)
+		m_exporter->step(newton::world, timestep);
+
+	if (!m_topple.isStarted()) {
+		std::vector<const __Object*> objects;
+		getReplayObjects(m_vbo.m_buffers, objects);
+		m_topple.start(objects);
+	}
+	m_topple.step(SIMULATION_STEP / 1000.0f);
+	m_toppleLod.step(m_topple, timestep);
+	m_settle.step(m_toppleLod, m_physicsLod);
+	if (!m_deterministic)
+		m_physicsLod.step(m_camera.m_position, m_toppleLod);
+}
+
+boost::uint64_t Simulation::hashBodies()
+{
+	std::vector<const __Object*> objects;
+	getReplayObjects(m_vbo.m_buffers, objects);
+
+	boost::uint64_t hash = util::HASH_SEED;
+	for (std::vector<const __Object*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr)
+		hash = util::hash((*itr)->getMatrix()[0], sizeof(Mat4f), hash);
+	return hash;
+}
+
 void Simulation::update()
 {
+	util::ProfileZone zone("update");
 	float delta = m_clock.get();
 	m_clock.reset();
 
@@ -1093,15 +1490,33 @@ void Simulation::update()
 	Vec3f dir = m_camera.viewVector();
 	Vec3f vel;
 	snd::SoundMgr::instance().SetListenerPos(&m_camera.m_position[0], &dir[0], &m_camera.m_up[0], &vel[0]);
-	if (m_enabled) {
+	if (m_player) {
+		ReplayEvents events;
+		m_player->update(delta, events);
+		for (ReplayEvents::iterator itr = events.begin(); itr != events.end(); ++itr) {
+			Vec3f distance(m_camera.m_position - itr->p0);
+			if (itr->type == ReplayEvent::SOUND && distance * distance < (MAX_SOUND_DISTANCE * MAX_SOUND_DISTANCE))
+				snd::SoundMgr::instance().PlaySound(itr->sound, 1, &itr->p0[0], &vel[0]);
+		}
+	} else if (m_enabled && m_deterministic) {
+		// the number of steps must not depend on the frame time
+		util::ProfileZone newtonZone("newton");
+		for (int i = 0; i < m_deterministicSteps; ++i)
+			step();
+		timeSlice = 0.0f;
+	} else if (m_enabled) {
 		timeSlice += delta * 1000.0f;
 
-		while (timeSlice > 12.0f) {
-			NewtonUpdate(newton::world, (12.0f / 1000.0f) * 20.0f);
-			timeSlice = timeSlice - 12.0f;
+		util::ProfileZone newtonZone("newton");
+		while (timeSlice > SIMULATION_STEP) {
+			step();
+			timeSlice = timeSlice - SIMULATION_STEP;
 		}
 	}
-	snd::SoundMgr::instance().SoundUpdate();
+	{
+		util::ProfileZone soundZone("sound");
+		snd::SoundMgr::instance().SoundUpdate();
+	}
 	m_skydome.update(delta);
 	float step = delta * (m_keyAdapter.shift() ? 25.f : 10.0f);
 
@@ -1121,8 +1536,12 @@ void Simulation::render()
 	const Mat4f lightProjection = Mat4f::perspective(45.0f, 1.0f, 10.0f, 2048.0f);
 	const Mat4f lightModelview = Mat4f::lookAt(m_lightPos.xyz(), Vec3f(), Vec3f::yAxis());
 
+	util::ProfileZone zone("render");
+
 	// Render scene from light into FBO and store depth buffer
 	if (m_useShadows) {
+		util::ProfileZone shadowZone("shadow pass");
+		ogl::GpuZone shadowGpuZone("shadow pass");
 		m_vbo.bind();
 		m_shadow.first->bind();
 		ogl::__Shader::unbind();
@@ -1146,7 +1565,7 @@ void Simulation::render()
 			const ogl::SubBuffer* const buf = (*itr);
 			const __Object* const obj = (const __Object* const)buf->userData;
 			glPushMatrix();
-			glMultMatrixf(obj->getMatrix()[0]);
+			glMultMatrixf(getRenderMatrix(obj)[0]);
 			glDrawElements(GL_TRIANGLES, buf->indexCount, GL_UNSIGNED_INT, (void*)(buf->indexOffset * 4));
 			glPopMatrix();
 		}
@@ -1211,27 +1630,59 @@ void Simulation::render()
 	}
 	MaterialMgr& mmgr = MaterialMgr::instance();
 	mmgr.applyMaterial(material, m_useShadows);
-	for ( ; itr != m_sortedBuffers.end(); ++itr) {
-		const ogl::SubBuffer* const buf = (*itr);
-		const __Object* const obj = (const __Object* const)buf->userData;
-		if (material != buf->material) {
-			material = buf->material;
-			mmgr.applyMaterial(material, m_useShadows);
-		}
 
-		glPushMatrix();
-		glMultMatrixf(obj->getMatrix()[0]);
-		glDrawElements(GL_TRIANGLES, buf->indexCount, GL_UNSIGNED_INT, (void*)(buf->indexOffset * 4));
-		glPopMatrix();
+	// the links are predicted again after each change of the dominoes
+	const bool chainColors = m_chainColors && !m_enabled;
+	if (chainColors && !m_chainCheck.isChecked()) {
+		std::vector<const __Object*> objects;
+		getReplayObjects(m_vbo.m_buffers, objects);
+		m_chainCheck.check(objects);
+	}
+	{
+		util::ProfileZone objectsZone("objects");
+		ogl::GpuZone objectsGpuZone("objects");
+		for ( ; itr != m_sortedBuffers.end(); ++itr) {
+			const ogl::SubBuffer* const buf = (*itr);
+			const __Object* const obj = (const __Object* const)buf->userData;
+			if (material != buf->material) {
+				material = buf->material;
+				mmgr.applyMaterial(material, m_useShadows);
+			}
+
+			// replace the diffuse colour of the material for this domino
+			Vec4f color;
+			const bool colored = (m_toppleColors && m_topple.getColor(obj, color))
+					|| (chainColors && m_chainCheck.getColor(obj, color));
+			if (colored)
+				glMaterialfv(GL_FRONT, GL_DIFFUSE, &color[0]);
+
+			glPushMatrix();
+			glMultMatrixf(getRenderMatrix(obj)[0]);
+			glDrawElements(GL_TRIANGLES, buf->indexCount, GL_UNSIGNED_INT, (void*)(buf->indexOffset * 4));
+			glPopMatrix();
+
+			if (colored) {
+				const Material* mat = mmgr.get(material);
+				if (mat)
+					glMaterialfv(GL_FRONT, GL_DIFFUSE, &mat->diffuse[0]);
+			}
+		}
 	}
 
 	ogl::VertexBuffer::unbind();
 
-	if (m_environment)
+	if (m_environment) {
+		util::ProfileZone environmentZone("environment");
+		ogl::GpuZone environmentGpuZone("environment");
 		m_environment->render();
+	}
 
 	glDisable(GL_LIGHTING);
-	m_skydome.render(m_camera, m_lightPos.xyz(), newton::getRayCastBody(m_camera.m_position, m_lightPos.xyz() - m_camera.m_position));
+	{
+		util::ProfileZone skydomeZone("skydome");
+		ogl::GpuZone skydomeGpuZone("skydome");
+		m_skydome.render(m_camera, m_lightPos.xyz(), newton::getRayCastBody(m_camera.m_position, m_lightPos.xyz() - m_camera.m_position));
+	}
 
 	glUseProgram(0);
 	glDisable(GL_TEXTURE_2D);
@@ -1271,7 +1722,9 @@ void Simulation::render()
 			Mat4f mat = Mat4f::rotAxis(axis, -angle);
 			mat = rot_mat_start * mat;
 			mat.setW(rot_mat_start.getW());
+			invalidateHeights(m_selectedObject);
 			m_selectedObject->setMatrix(mat);
+			invalidateHeights(m_selectedObject);
 		}
 		axis = axis.normalized() * 50.0f + origin;
 		glBegin(GL_POINTS);
@@ -1287,6 +1740,9 @@ void Simulation::render()
 		curve_spline.renderKnots();
 		curve_spline.renderSpline(0.25f);
 		curve_spline.renderPoints(5.0f);
+	} else if (isActivated(INT_EDIT_PATH) && !m_enabled) {
+		for (std::list<DominoPath>::iterator path = m_paths.begin(); path != m_paths.end(); ++path)
+			(*path)->render();
 	}
 
 	glPointSize(5.0f);
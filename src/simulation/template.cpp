@@ -0,0 +1,349 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/template.cpp
+ */
+
+#define BOOST_FILESYSTEM_VERSION 2
+
+#include <simulation/template.hpp>
+#include <simulation/compound.hpp>
+#include <simulation/domino.hpp>
+#include <newton/util.hpp>
+#include <util/erroradapters.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace sim {
+
+TemplateMgr* TemplateMgr::s_instance = NULL;
+
+TemplateMgr::TemplateMgr()
+{
+}
+
+TemplateMgr::TemplateMgr(const TemplateMgr& other)
+{
+}
+
+TemplateMgr::~TemplateMgr()
+{
+	clear();
+}
+
+TemplateMgr& TemplateMgr::instance()
+{
+	if (!s_instance)
+		s_instance = new TemplateMgr();
+	return *s_instance;
+}
+
+void TemplateMgr::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+Template TemplateMgr::parse(const std::string& fileName)
+{
+	/* information for error messages */
+	std::string function = "TemplateMgr::parse";
+	std::vector<std::string> args;
+	args.push_back(fileName);
+	/* END information for error messages */
+
+	using namespace rapidxml;
+
+	Template result(new __Template());
+
+	try {
+		std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+		if (!file)
+			throw std::runtime_error("cannot open file " + fileName);
+
+		file.seekg(0, std::ios::end);
+		std::streamoff size = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		result->text.resize((size_t)size + 1);
+		if (size > 0)
+			file.read(&result->text[0], size);
+		result->text[size] = 0;
+
+		result->doc.parse<0>(&result->text[0]);
+
+		// this is important so we don't parse the template tag but the object or compound tag
+		xml_node<>* nodes = result->doc.first_node();
+		if (!nodes)
+			throw parse_error("No valid root node found", &result->text[0]);
+
+		// only the first tag is loaded the rest will be ignored
+		xml_node<>* node = nodes->first_node();
+		if (node) {
+			std::string type(node->name());
+			if (type == "object" || type == "compound")
+				result->node = node;
+		}
+
+		if (!result->node)
+			throw parse_error("No object or compound tag found", nodes->name());
+
+	} catch (parse_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+		return Template();
+	} catch (std::runtime_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+		return Template();
+	}
+
+	return result;
+}
+
+unsigned TemplateMgr::load(const std::string& folder)
+{
+	using namespace boost::filesystem;
+
+	unsigned count = 0;
+	if (!exists(folder))
+		return count;
+
+	directory_iterator end;
+	for (directory_iterator itr(folder); itr != end; ++itr) {
+		if (is_regular_file(itr->status()) && extension(*itr) == ".xml") {
+			if (get(itr->string()))
+				count++;
+		}
+	}
+
+	std::cout << "parsed " << count << " templates in " << folder << std::endl;
+	return count;
+}
+
+Template TemplateMgr::get(const std::string& fileName)
+{
+	const std::string key = boost::filesystem::complete(fileName).string();
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		std::map<std::string, Template>::iterator itr = m_templates.find(key);
+		if (itr != m_templates.end())
+			return itr->second;
+	}
+
+	// parse outside of the lock, the result is only added once
+	Template result = parse(fileName);
+	if (result) {
+		boost::mutex::scoped_lock lock(m_mutex);
+		result = m_templates.insert(std::make_pair(key, result)).first->second;
+	}
+	return result;
+}
+
+bool TemplateMgr::capture(__Template& prototype, const Object& object)
+{
+	std::list<Object> objects;
+	prototype.compound = object->getType() == __Object::COMPOUND;
+	if (prototype.compound) {
+		const __Compound* compound = (const __Compound*)object.get();
+		prototype.matrix = compound->m_matrix;
+		objects = compound->m_nodes;
+	} else {
+		objects.push_back(object);
+	}
+
+	for (std::list<Object>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		TemplateNode node;
+		node.type = (*itr)->getType();
+		node.matrix = (*itr)->getMatrix();
+		node.material = (*itr)->getMaterial();
+		node.mass = (*itr)->getMass();
+		node.freezeState = (*itr)->getFreezeState();
+		node.collision = NULL;
+
+		switch (node.type) {
+		case __Object::DOMINO_SMALL:
+		case __Object::DOMINO_MIDDLE:
+		case __Object::DOMINO_LARGE:
+			break;
+		case __Object::CONVEX_HULL:
+		case __Object::CONVEX_ASSEMBLY:
+			node.fileName = ((const __Convex*)itr->get())->m_fileName;
+			node.damping = ((const __Convex*)itr->get())->m_damping;
+			break;
+		case __Object::BOX:
+		case __Object::SPHERE:
+		case __Object::CYLINDER:
+		case __Object::CAPSULE:
+		case __Object::CONE:
+		case __Object::CHAMFER_CYLINDER:
+			node.damping = ((const __RigidBody*)itr->get())->m_damping;
+			node.collision = ((const __RigidBody*)itr->get())->getCollision();
+			NewtonAddCollisionReference(node.collision);
+			break;
+		default:
+			release(prototype);
+			return false;
+		}
+		prototype.nodes.push_back(node);
+	}
+
+	if (prototype.compound) {
+		const __Compound* compound = (const __Compound*)object.get();
+		for (std::list<Joint>::const_iterator itr = compound->m_joints.begin(); itr != compound->m_joints.end(); ++itr) {
+			TemplateJoint joint;
+			joint.type = (*itr)->type;
+			joint.pivot = (*itr)->pivot;
+			joint.pinDir = (*itr)->pinDir;
+			joint.child = joint.parent = -1;
+			int index = 0;
+			for (std::list<Object>::const_iterator node = objects.begin(); node != objects.end(); ++node, ++index) {
+				if (*node == (*itr)->child)
+					joint.child = index;
+				if (*node == (*itr)->parent)
+					joint.parent = index;
+			}
+
+			switch (joint.type) {
+			case __Joint::HINGE: {
+				const __Hinge* hinge = (const __Hinge*)itr->get();
+				joint.limited = hinge->limited;
+				joint.limits[0] = hinge->minAngle;
+				joint.limits[1] = hinge->maxAngle;
+				joint.limits[2] = 0.0f;
+				break;
+			}
+			case __Joint::SLIDER: {
+				const __Slider* slider = (const __Slider*)itr->get();
+				joint.limited = slider->limited;
+				joint.limits[0] = slider->minDist;
+				joint.limits[1] = slider->maxDist;
+				joint.limits[2] = 0.0f;
+				break;
+			}
+			case __Joint::BALL_AND_SOCKET: {
+				const __BallAndSocket* ball = (const __BallAndSocket*)itr->get();
+				joint.limited = ball->limited;
+				joint.limits[0] = ball->coneAngle;
+				joint.limits[1] = ball->minTwist;
+				joint.limits[2] = ball->maxTwist;
+				break;
+			}
+			}
+			prototype.joints.push_back(joint);
+		}
+	}
+	return true;
+}
+
+void TemplateMgr::release(__Template& prototype)
+{
+	for (std::vector<TemplateNode>::const_iterator itr = prototype.nodes.begin(); itr != prototype.nodes.end(); ++itr)
+		if (itr->collision)
+			NewtonReleaseCollision(newton::world, itr->collision);
+	prototype.nodes.clear();
+	prototype.joints.clear();
+	prototype.captured = false;
+}
+
+Object TemplateMgr::clone(const TemplateNode& node, const Mat4f& matrix)
+{
+	switch (node.type) {
+	case __Object::DOMINO_SMALL:
+	case __Object::DOMINO_MIDDLE:
+	case __Object::DOMINO_LARGE: {
+		Domino result = __Domino::createDomino(node.type, matrix, node.mass, node.material, false);
+		result->setFreezeState(node.freezeState);
+		return result;
+	}
+	case __Object::CONVEX_HULL:
+		return __Convex::createHull(matrix, node.mass, node.material, node.fileName, node.freezeState, node.damping);
+	case __Object::CONVEX_ASSEMBLY:
+		return __Convex::createAssembly(matrix, node.mass, node.material, node.fileName, node.freezeState, node.damping);
+	default: {
+		RigidBody result(new __RigidBody(node.type, matrix, node.material, node.freezeState, node.damping));
+		result->create(node.collision, node.mass, node.freezeState, node.damping);
+		return result;
+	}
+	}
+}
+
+Object TemplateMgr::clone(const __Template& prototype, const Mat4f& matrix)
+{
+	if (!prototype.compound)
+		return clone(prototype.nodes.front(), matrix);
+
+	// build the compound like __Compound::load(), then move it
+	Compound result = __Compound::createCompound();
+	std::vector<Object> nodes;
+	for (std::vector<TemplateNode>::const_iterator itr = prototype.nodes.begin(); itr != prototype.nodes.end(); ++itr) {
+		nodes.push_back(clone(*itr, itr->matrix));
+		result->add(nodes.back());
+	}
+
+	for (std::vector<TemplateJoint>::const_iterator itr = prototype.joints.begin(); itr != prototype.joints.end(); ++itr) {
+		const Object child = itr->child >= 0 ? nodes[itr->child] : Object();
+		const Object parent = itr->parent >= 0 ? nodes[itr->parent] : Object();
+		switch (itr->type) {
+		case __Joint::HINGE:
+			result->m_joints.push_back(__Hinge::create(itr->pivot, itr->pinDir, child, parent,
+					itr->limited, itr->limits[0], itr->limits[1]));
+			break;
+		case __Joint::SLIDER:
+			result->m_joints.push_back(__Slider::create(itr->pivot, itr->pinDir, child, parent,
+					itr->limited, itr->limits[0], itr->limits[1]));
+			break;
+		case __Joint::BALL_AND_SOCKET:
+			result->m_joints.push_back(__BallAndSocket::create(itr->pivot, itr->pinDir, child, parent,
+					itr->limited, itr->limits[0], itr->limits[1], itr->limits[2]));
+			break;
+		}
+	}
+
+	result->m_matrix = prototype.matrix;
+	result->setMatrix(matrix);
+	return result;
+}
+
+Object TemplateMgr::create(const std::string& fileName, const Mat4f& matrix)
+{
+	/* information for error messages */
+	std::string function = "TemplateMgr::create";
+	std::vector<std::string> args;
+	args.push_back(fileName);
+	/* END information for error messages */
+
+	Template prototype = get(fileName);
+	if (!prototype)
+		return Object();
+	if (prototype->captured)
+		return clone(*prototype, matrix);
+
+	Object result;
+	try {
+		result = __Object::load(prototype->node);
+		if (result) {
+			prototype->captured = capture(*prototype, result);
+			result->setMatrix(matrix);
+		}
+	} catch (rapidxml::parse_error& e) {
+		util::ErrorAdapter::instance().displayErrorMessage(function, args, e);
+		return Object();
+	}
+	return result;
+}
+
+void TemplateMgr::freePrototypes()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	for (std::map<std::string, Template>::iterator itr = m_templates.begin(); itr != m_templates.end(); ++itr)
+		release(*itr->second);
+}
+
+void TemplateMgr::clear()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_templates.clear();
+}
+
+}
@@ -0,0 +1,238 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/topple.cpp
+ */
+
+#include <simulation/topple.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+/** A domino that moved further than this has been hit */
+static const float HIT_DISTANCE = 0.05f;
+
+/** A fallen domino with a lower linear and angular speed is at rest */
+static const float REST_SPEED = 0.1f;
+
+ToppleTracker::ToppleTracker()
+{
+	reset();
+}
+
+void ToppleTracker::reset()
+{
+	m_started = false;
+	m_time = 0.0f;
+	m_dominoes.clear();
+	m_indices.clear();
+	m_hitTimes.clear();
+	m_restTimes.clear();
+	m_stalls.clear();
+	m_grid.clear();
+	m_lastHit = 0;
+}
+
+void ToppleTracker::start(const std::vector<const __Object*>& objects)
+{
+	reset();
+
+	util::Config& config = util::Config::instance();
+	m_hitCos = cos(config.get("toppleHitAngle", 2.0f) * PI / 180.0f);
+	m_fallenCos = cos(config.get("toppleFallenAngle", 45.0f) * PI / 180.0f);
+	m_stallTime = config.get("toppleStallTime", 1.0f);
+
+	// the wave does not jump further than two gaps of the largest domino
+	m_cellSize = __Domino::s_domino_gap[__Object::DOMINO_LARGE] * 2.0f;
+
+	for (std::vector<const __Object*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr) {
+		const __Domino* domino = dynamic_cast<const __Domino*>(*itr);
+		if (!domino)
+			continue;
+
+		ToppleInfo info;
+		info.domino = domino;
+		info.position = domino->getMatrix().getW();
+		info.up = domino->getMatrix().getY();
+		info.hitTime = info.restTime = -1.0f;
+		info.source = -1;
+		info.speed = 0.0f;
+		m_indices[domino] = m_dominoes.size();
+		m_dominoes.push_back(info);
+	}
+	m_started = true;
+}
+
+std::pair<int, int> ToppleTracker::getCell(const Vec3f& position) const
+{
+	return std::make_pair((int)floor(position.x / m_cellSize), (int)floor(position.z / m_cellSize));
+}
+
+void ToppleTracker::hit(unsigned index)
+{
+	ToppleInfo& info = m_dominoes[index];
+	info.hitTime = m_time;
+	m_hitTimes.push_back(m_time);
+	m_lastHit = index;
+
+	// the wave resumed
+	if (!m_stalls.empty() && m_stalls.back().duration < 0.0f)
+		m_stalls.back().duration = m_time - m_stalls.back().time;
+
+	// the nearest domino that was hit in an earlier step
+	const std::pair<int, int> cell = getCell(info.position);
+	float best = m_cellSize * m_cellSize;
+	for (int x = cell.first - 1; x <= cell.first + 1; ++x) {
+		for (int z = cell.second - 1; z <= cell.second + 1; ++z) {
+			std::map<std::pair<int, int>, std::vector<unsigned> >::const_iterator itr = m_grid.find(std::make_pair(x, z));
+			if (itr == m_grid.end())
+				continue;
+			for (std::vector<unsigned>::const_iterator j = itr->second.begin(); j != itr->second.end(); ++j) {
+				const ToppleInfo& other = m_dominoes[*j];
+				if (other.hitTime >= m_time)
+					continue;
+				const Vec3f distance = other.position - info.position;
+				const float dist2 = distance * distance;
+				if (dist2 < best) {
+					best = dist2;
+					info.source = *j;
+				}
+			}
+		}
+	}
+
+	if (info.source >= 0)
+		info.speed = sqrt(best) / (m_time - m_dominoes[info.source].hitTime);
+
+	m_grid[cell].push_back(index);
+}
+
+void ToppleTracker::step(float timestep)
+{
+	if (!m_started)
+		return;
+
+	m_time += timestep;
+
+	bool standing = false;
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		ToppleInfo& info = m_dominoes[i];
+		if (info.restTime >= 0.0f)
+			continue;
+
+		const Mat4f& matrix = info.domino->getMatrix();
+		const float tilt = matrix.getY() * info.up;
+		if (info.hitTime < 0.0f) {
+			const Vec3f distance = matrix.getW() - info.position;
+			if (tilt < m_hitCos || distance * distance > HIT_DISTANCE * HIT_DISTANCE) {
+				hit(i);
+			} else {
+				standing = true;
+				continue;
+			}
+		}
+
+		if (tilt < m_fallenCos) {
+			Vec3f velocity, omega;
+			NewtonBodyGetVelocity(info.domino->m_body, &velocity[0]);
+			NewtonBodyGetOmega(info.domino->m_body, &omega[0]);
+			if (NewtonBodyGetSleepState(info.domino->m_body) ||
+					(velocity * velocity < REST_SPEED * REST_SPEED && omega * omega < REST_SPEED * REST_SPEED)) {
+				info.restTime = m_time;
+				m_restTimes.push_back(m_time);
+			}
+		}
+	}
+
+	// no domino was hit for a while, but some are still standing
+	if (standing && !m_hitTimes.empty() && m_time - m_hitTimes.back() >= m_stallTime) {
+		if (m_stalls.empty() || m_stalls.back().duration >= 0.0f) {
+			ToppleStall stall;
+			stall.domino = m_lastHit;
+			stall.time = m_hitTimes.back();
+			stall.duration = -1.0f;
+			m_stalls.push_back(stall);
+		}
+	}
+}
+
+const ToppleInfo* ToppleTracker::getInfo(const __Object* object) const
+{
+	std::map<const __Object*, unsigned>::const_iterator itr = m_indices.find(object);
+	return itr != m_indices.end() ? &m_dominoes[itr->second] : NULL;
+}
+
+bool ToppleTracker::getColor(const __Object* object, Vec4f& color) const
+{
+	const ToppleInfo* info = getInfo(object);
+	if (!info || info->hitTime < 0.0f)
+		return false;
+
+	const float first = m_hitTimes.front();
+	const float last = m_hitTimes.back();
+	const float t = last > first ? (info->hitTime - first) / (last - first) : 0.0f;
+
+	// blue, green, red
+	if (t < 0.5f)
+		color = Vec4f(0.0f, t * 2.0f, 1.0f - t * 2.0f, 1.0f);
+	else
+		color = Vec4f(t * 2.0f - 1.0f, 2.0f - t * 2.0f, 0.0f, 1.0f);
+	return true;
+}
+
+ToppleSummary ToppleTracker::getSummary() const
+{
+	ToppleSummary summary;
+	summary.dominoes = m_dominoes.size();
+	summary.hit = m_hitTimes.size();
+	summary.fallen = m_restTimes.size();
+	summary.firstHit = m_hitTimes.empty() ? -1.0f : m_hitTimes.front();
+	summary.lastHit = m_hitTimes.empty() ? -1.0f : m_hitTimes.back();
+	summary.duration = 0.0f;
+	if (!m_hitTimes.empty()) {
+		const float end = m_restTimes.empty() ? summary.lastHit : std::max(summary.lastHit, m_restTimes.back());
+		summary.duration = end - summary.firstHit;
+	}
+	summary.stalls = m_stalls.size();
+
+	summary.length = 0.0f;
+	std::vector<float> speeds;
+	for (std::vector<ToppleInfo>::const_iterator itr = m_dominoes.begin(); itr != m_dominoes.end(); ++itr) {
+		if (itr->source < 0)
+			continue;
+		summary.length += (itr->position - m_dominoes[itr->source].position).len();
+		speeds.push_back(itr->speed);
+	}
+
+	summary.waveSpeed = 0.0f;
+	if (!speeds.empty()) {
+		std::vector<float>::iterator median = speeds.begin() + speeds.size() / 2;
+		std::nth_element(speeds.begin(), median, speeds.end());
+		summary.waveSpeed = *median;
+	}
+	return summary;
+}
+
+void ToppleTracker::writeSummary(std::ostream& out) const
+{
+	const ToppleSummary summary = getSummary();
+	out << "dominoes,hit,fallen,first_hit_s,last_hit_s,duration_s,length,wave_speed,stalls" << std::endl;
+	out << summary.dominoes << "," << summary.hit << "," << summary.fallen << ","
+		<< summary.firstHit << "," << summary.lastHit << "," << summary.duration << ","
+		<< summary.length << "," << summary.waveSpeed << "," << summary.stalls << std::endl;
+}
+
+void ToppleTracker::writeDominoes(std::ostream& out) const
+{
+	out << "domino,id,x,y,z,hit_s,rest_s,source,speed" << std::endl;
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		const ToppleInfo& info = m_dominoes[i];
+		out << i << "," << info.domino->getID() << ","
+			<< info.position.x << "," << info.position.y << "," << info.position.z << ","
+			<< info.hitTime << "," << info.restTime << ","
+			<< info.source << "," << info.speed << std::endl;
+	}
+}
+
+}
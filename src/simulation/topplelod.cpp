@@ -0,0 +1,343 @@
+/**
+ * @date Oct 19, 2026
+ * @file simulation/topplelod.cpp
+ */
+
+#include <simulation/topplelod.hpp>
+#include <simulation/material.hpp>
+#include <newton/util.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+/** The fall curves are integrated with this number of sub-steps per step */
+static const int FALL_SUBSTEPS = 8;
+
+/** The fall curves end after this number of steps */
+static const unsigned MAX_FALL_STEPS = 1000;
+
+/**
+ * The angular velocity at the start of the fall curves, relative to
+ * the velocity that barely reaches the tipping point
+ */
+static const float FALL_SPEED_FACTOR = 1.5f;
+
+ToppleLod::ToppleLod()
+	: m_started(false),
+	  m_active(false),
+	  m_enabled(false),
+	  m_window(0.0f),
+	  m_peakDynamic(0)
+{
+}
+
+void ToppleLod::reset()
+{
+	for (unsigned i = 0; i < m_dominoes.size(); ++i)
+		if (m_dominoes[i] && m_infos[i].state != LOD_DYNAMIC)
+			promote(i);
+
+	m_started = m_active = false;
+	m_dominoes.clear();
+	m_infos.clear();
+	m_indices.clear();
+	m_bodies.clear();
+	m_grid.clear();
+	m_peakDynamic = 0;
+}
+
+void ToppleLod::initCurves(float timestep)
+{
+	const float gravity = -newton::gravity;
+	const float dt = timestep / FALL_SUBSTEPS;
+	for (int type = __Object::DOMINO_SMALL; type <= __Object::DOMINO_LARGE; ++type) {
+		// a box turning around its front edge, the centre of mass is
+		// behind the edge by the angle beta
+		const Vec3f size = __Domino::s_domino_size[type];
+		const float diagonal = sqrt(size.y * size.y + size.z * size.z);
+		const float k = 3.0f * gravity / (2.0f * diagonal);
+		const float beta = atan2(size.z, size.y);
+
+		std::vector<float>& curve = m_curves[type];
+		float angle = 0.0f;
+		float omega = FALL_SPEED_FACTOR * sqrt(std::max(0.0f, 2.0f * k * (1.0f - cos(beta))));
+		curve.assign(1, 0.0f);
+		while (angle < PI * 0.5f && curve.size() < MAX_FALL_STEPS) {
+			for (int i = 0; i < FALL_SUBSTEPS; ++i) {
+				omega += k * sin(angle - beta) * dt;
+				angle += omega * dt;
+			}
+			curve.push_back(std::min(angle, (float)PI * 0.5f));
+		}
+	}
+}
+
+void ToppleLod::findMovingBodies(const std::vector<ToppleInfo>& infos)
+{
+	m_grid.clear();
+	for (NewtonBody* body = NewtonWorldGetFirstBody(newton::world); body; body = NewtonWorldGetNextBody(newton::world, body)) {
+		float mass, ix, iy, iz;
+		NewtonBodyGetMassMatrix(body, &mass, &ix, &iy, &iz);
+		if (mass <= 0.0f || NewtonBodyGetSleepState(body))
+			continue;
+
+		// the dominoes behind the front are still moving, but do not push the wave
+		boost::unordered_map<const NewtonBody*, unsigned>::const_iterator itr = m_bodies.find(body);
+		if (itr != m_bodies.end() && infos[itr->second].hitTime >= 0.0f && m_infos[itr->second].next >= 0)
+			continue;
+
+		Mat4f matrix;
+		NewtonBodyGetMatrix(body, matrix[0]);
+		const Vec3f pos = matrix.getW();
+		m_grid[std::make_pair((int)floor(pos.x / m_window), (int)floor(pos.z / m_window))].push_back(pos);
+	}
+}
+
+float ToppleLod::getDistance(const Vec3f& position) const
+{
+	typedef boost::unordered_map<std::pair<int, int>, std::vector<Vec3f> > Grid;
+
+	float best = m_window * 2.0f;
+	const int cx = (int)floor(position.x / m_window), cz = (int)floor(position.z / m_window);
+	for (int x = cx - 2; x <= cx + 2; ++x) {
+		for (int z = cz - 2; z <= cz + 2; ++z) {
+			Grid::const_iterator cell = m_grid.find(std::make_pair(x, z));
+			if (cell == m_grid.end())
+				continue;
+			for (std::vector<Vec3f>::const_iterator itr = cell->second.begin(); itr != cell->second.end(); ++itr)
+				best = std::min(best, (*itr - position).len());
+		}
+	}
+	return best;
+}
+
+void ToppleLod::demote(unsigned index, LodState state)
+{
+	LodInfo& lod = m_infos[index];
+	NewtonBody* body = m_dominoes[index]->m_body;
+	NewtonBodyGetMassMatrix(body, &lod.mass, &lod.inertia.x, &lod.inertia.y, &lod.inertia.z);
+	NewtonBodySetMassMatrix(body, 0.0f, 0.0f, 0.0f, 0.0f);
+	newton::setDemoted(body, true);
+
+	const Vec3f zero;
+	NewtonBodySetVelocity(body, &zero[0]);
+	NewtonBodySetOmega(body, &zero[0]);
+	lod.state = state;
+}
+
+void ToppleLod::promote(unsigned index)
+{
+	LodInfo& lod = m_infos[index];
+	NewtonBody* body = m_dominoes[index]->m_body;
+	NewtonBodySetMassMatrix(body, lod.mass, lod.inertia.x, lod.inertia.y, lod.inertia.z);
+	newton::setDemoted(body, false);
+
+	// it sleeps until it is hit
+	NewtonBodySetFreezeState(body, 1);
+	lod.state = LOD_DYNAMIC;
+}
+
+void ToppleLod::startFall(unsigned index, const ToppleInfo& info, const std::vector<ToppleInfo>& infos)
+{
+	LodInfo& lod = m_infos[index];
+	__Domino* domino = m_dominoes[index];
+	const __Object::Type type = std::min(domino->getType(), __Object::DOMINO_LARGE);
+	const Mat4f& matrix = domino->getMatrix();
+	const Vec3f y = matrix.getY();
+	const Vec3f z = matrix.getZ();
+
+	// the direction of the fall on the ground
+	Vec3f front = y - info.up * (y * info.up);
+	if (front.len() < 1e-3f) {
+		front = z - info.up * (z * info.up);
+		if (lod.next >= 0 && front * (infos[lod.next].position - info.position) < 0.0f)
+			front = -front;
+	}
+	front.normalize();
+
+	const float tilt = atan2(y * front, y * info.up);
+	const Vec3f up = info.up * cos(tilt) + front * sin(tilt);
+	const Vec3f back = front * cos(tilt) - info.up * sin(tilt);
+
+	lod.size = domino->getSize();
+	lod.pivot = matrix.getW() - up * (lod.size.y * 0.5f) + back * (lod.size.z * 0.5f);
+	lod.up = info.up;
+	lod.front = front;
+	lod.sign = z * back < 0.0f ? -1.0f : 1.0f;
+
+	// parallel dominoes lean on each other, if the distance of their
+	// faces is the thickness, otherwise it lies on the ground
+	lod.restAngle = PI * 0.5f;
+	if (lod.next >= 0) {
+		Vec3f delta = infos[lod.next].position - info.position;
+		delta -= info.up * (delta * info.up);
+		if (delta.len() > lod.size.z)
+			lod.restAngle = acos(lod.size.z / delta.len());
+	}
+	lod.restAngle = std::max(lod.restAngle, tilt);
+
+	const std::vector<float>& curve = m_curves[type];
+	lod.sample = std::lower_bound(curve.begin(), curve.end(), tilt) - curve.begin();
+	demote(index, LOD_FALLING);
+}
+
+void ToppleLod::stepFall(unsigned index)
+{
+	LodInfo& lod = m_infos[index];
+	__Domino* domino = m_dominoes[index];
+	const std::vector<float>& curve = m_curves[std::min(domino->getType(), __Object::DOMINO_LARGE)];
+
+	lod.sample++;
+	float angle = lod.sample < curve.size() ? curve[lod.sample] : PI * 0.5f;
+	const bool rest = angle >= lod.restAngle;
+	angle = std::min(angle, lod.restAngle);
+
+	const Vec3f up = lod.up * cos(angle) + lod.front * sin(angle);
+	const Vec3f back = lod.front * cos(angle) - lod.up * sin(angle);
+	const Vec3f pos = lod.pivot + up * (lod.size.y * 0.5f) - back * (lod.size.z * 0.5f);
+	domino->setMatrix(Mat4f(up, back * lod.sign, pos));
+
+	if (rest) {
+		lod.state = LOD_RESTING;
+		MaterialMgr& mmgr = MaterialMgr::instance();
+		const int material = mmgr.getID(domino->getMaterial());
+		const std::string& sound = mmgr.getPair(material, material).impactSound;
+		if (!sound.empty())
+			mmgr.playImpactSound(sound, lod.pivot + up * lod.size.y);
+	}
+}
+
+void ToppleLod::step(const ToppleTracker& topple, float timestep)
+{
+	if (!topple.isStarted())
+		return;
+
+	const std::vector<ToppleInfo>& infos = topple.getDominoes();
+	if (!m_started) {
+		util::Config& config = util::Config::instance();
+		m_enabled = config.get("toppleLod", false);
+		m_window = std::max(1.0f, config.get("toppleLodWindow", 20.0f));
+		m_started = true;
+		if (!m_enabled)
+			return;
+
+		initCurves(timestep);
+		m_dominoes.resize(infos.size(), NULL);
+		m_infos.resize(infos.size());
+		for (unsigned i = 0; i < infos.size(); ++i) {
+			LodInfo& lod = m_infos[i];
+			lod.state = LOD_DYNAMIC;
+			lod.next = -1;
+			lod.linked = false;
+
+			// static dominoes are left alone
+			__Domino* domino = const_cast<__Domino*>(infos[i].domino);
+			if (domino->getMass() <= 0.0f)
+				continue;
+			m_dominoes[i] = domino;
+			m_indices[domino] = i;
+			m_bodies[domino->m_body] = i;
+		}
+	}
+	if (!m_enabled)
+		return;
+
+	// each domino of the wave hits the next one
+	for (unsigned i = 0; i < infos.size(); ++i) {
+		LodInfo& lod = m_infos[i];
+		if (lod.linked || infos[i].hitTime < 0.0f)
+			continue;
+		lod.linked = true;
+		if (infos[i].source >= 0 && m_infos[infos[i].source].next < 0)
+			m_infos[infos[i].source].next = i;
+	}
+
+	if (!m_active) {
+		if (topple.getHitTimes().empty())
+			return;
+		m_active = true;
+	}
+
+	findMovingBodies(infos);
+	unsigned dynamic = 0;
+	for (unsigned i = 0; i < infos.size(); ++i) {
+		if (!m_dominoes[i])
+			continue;
+
+		const ToppleInfo& info = infos[i];
+		LodInfo& lod = m_infos[i];
+		switch (lod.state) {
+		case LOD_DYNAMIC: {
+			const float distance = getDistance(m_dominoes[i]->getMatrix().getW());
+			if (info.hitTime < 0.0f) {
+				if (distance >= m_window * 2.0f)
+					demote(i, LOD_STANDING);
+			} else if (distance >= m_window) {
+				if (info.restTime >= 0.0f)
+					demote(i, LOD_RESTING);
+				else
+					startFall(i, info, infos);
+			}
+			break;
+		}
+		case LOD_STANDING:
+			if (getDistance(info.position) < m_window)
+				promote(i);
+			break;
+		case LOD_FALLING:
+			stepFall(i);
+			break;
+		case LOD_RESTING:
+			if (getDistance(m_dominoes[i]->getMatrix().getW()) < m_window * 0.5f)
+				promote(i);
+			break;
+		}
+		if (lod.state == LOD_DYNAMIC)
+			dynamic++;
+	}
+	m_peakDynamic = std::max(m_peakDynamic, dynamic);
+}
+
+void ToppleLod::promote(const Vec3f& p0, const Vec3f& p1)
+{
+	const Vec3f dir = (p1 - p0).normalized();
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		if (!m_dominoes[i] || m_infos[i].state == LOD_DYNAMIC || m_infos[i].state == LOD_FALLING)
+			continue;
+		const Vec3f delta = m_dominoes[i]->getMatrix().getW() - p0;
+		if ((delta - dir * (delta * dir)).len() < m_window) {
+			promote(i);
+
+			// awake, so that the neighbors stay dynamic while it is picked
+			NewtonBodySetFreezeState(m_dominoes[i]->m_body, 0);
+		}
+	}
+}
+
+LodState ToppleLod::getState(const __Object* object) const
+{
+	boost::unordered_map<const __Object*, unsigned>::const_iterator itr = m_indices.find(object);
+	return itr != m_indices.end() ? m_infos[itr->second].state : LOD_DYNAMIC;
+}
+
+ToppleLodSummary ToppleLod::getSummary() const
+{
+	ToppleLodSummary summary;
+	summary.dynamic = summary.standing = summary.falling = summary.resting = 0;
+	for (unsigned i = 0; i < m_dominoes.size(); ++i) {
+		if (!m_dominoes[i])
+			continue;
+		switch (m_infos[i].state) {
+		case LOD_DYNAMIC: summary.dynamic++; break;
+		case LOD_STANDING: summary.standing++; break;
+		case LOD_FALLING: summary.falling++; break;
+		case LOD_RESTING: summary.resting++; break;
+		}
+	}
+	summary.peakDynamic = m_peakDynamic;
+	return summary;
+}
+
+}
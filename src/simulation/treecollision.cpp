@@ -5,6 +5,7 @@
  */
 
 #include <util/config.hpp>
+#include <util/memory.hpp>
 #include <simulation/treecollision.hpp>
 #include <simulation/object.hpp>
 #include <simulation/compound.hpp>
@@ -169,7 +170,7 @@ int __TreeCollision::Node::draw(bool test) {
 }
 
 __TreeCollision::__TreeCollision(const Mat4f& matrix, const std::string& fileName)
-	: __Object(TREE_COLLISION), Body(matrix), m_fileName(fileName), m_nodeCount(0), m_node(NULL)
+	: __Object(TREE_COLLISION), Body(matrix), m_fileName(fileName), m_nodeCount(0), m_node(NULL), m_memory(0)
 {
 	m_list = 0;
 
@@ -217,29 +218,36 @@ __TreeCollision::__TreeCollision(const Mat4f& matrix, const std::string& fileNam
 
 	//TODO sort the meshes and then only appy and begin() if it is another material
 
-	m_list = glGenLists(1);
-	glNewList(m_list, GL_COMPILE);
+	// there is no context to compile the display list in a headless simulation
+	const bool headless = Simulation::instance().isHeadless();
+	if (!headless) {
+		m_list = glGenLists(1);
+		glNewList(m_list, GL_COMPILE);
+	}
 	for(Lib3dsMesh* mesh = file->meshes; mesh != NULL; mesh = mesh->next) {
 		//data.reserve(data.size() + (mesh->points * (3 + 3 + 2)));
 		//data.resize(data.size() + (mesh->points * (3 + 3 + 2)));
 		int faceMaterial = defaultMaterial;
 		lib3ds_mesh_calculate_normals(mesh, &m_normals[finishedFaces*3]);
-		if (mesh->faces) {
+		if (mesh->faces && !headless) {
 			faceMaterial = mesh->faceL[0].material && mesh->faceL[0].material[0] ? MaterialMgr::instance().getID(mesh->faceL[0].material) : defaultMaterial;
 			Material* mat = MaterialMgr::instance().fromID(faceMaterial);
 			MaterialMgr::instance().applyMaterial(mat ? mat->name : "yellow", util::Config::instance().get("enableShadows", false));
 		}
-		glBegin(GL_TRIANGLES);
+		if (!headless)
+			glBegin(GL_TRIANGLES);
 		for(unsigned cur_face = 0; cur_face < mesh->faces; cur_face++) {
 			Lib3dsFace* face = &mesh->faceL[cur_face];
 			for(unsigned int i = 0;i < 3; i++) {
 				memcpy(&m_vertices[finishedFaces*3 + i], mesh->pointL[face->points[i]].pos, sizeof(Lib3dsVector));
-				if (mesh->texelL) {
+				if (mesh->texelL)
 					memcpy(&m_uvs[finishedFaces*3 + i], mesh->texelL[face->points[i]], sizeof(Lib3dsTexel));
-					glTexCoord2fv(m_uvs[finishedFaces*3 + i]);
+				if (!headless) {
+					if (mesh->texelL)
+						glTexCoord2fv(m_uvs[finishedFaces*3 + i]);
+					glNormal3fv(m_normals[finishedFaces*3 + i]);
+					glVertex3fv(m_vertices[finishedFaces*3 + i]);
 				}
-				glNormal3fv(m_normals[finishedFaces*3 + i]);
-				glVertex3fv(m_vertices[finishedFaces*3 + i]);
 
 				m_data.push_back(mesh->pointL[face->points[i]].pos[0]);
 				m_data.push_back(mesh->pointL[face->points[i]].pos[1]);
@@ -252,9 +260,11 @@ __TreeCollision::__TreeCollision(const Mat4f& matrix, const std::string& fileNam
 			NewtonTreeCollisionAddFace(collision, 3, m_vertices[finishedFaces*3], sizeof(Lib3dsVector), faceMaterial);
 			finishedFaces++;
 		}
-		glEnd();
+		if (!headless)
+			glEnd();
 	}
-	glEndList();
+	if (!headless)
+		glEndList();
 	lib3ds_file_free(file);
 	NewtonTreeCollisionEndBuild(collision, 1);
 
@@ -268,10 +278,18 @@ __TreeCollision::__TreeCollision(const Mat4f& matrix, const std::string& fileNam
 	this->create(collision, 0.0f);
 	//NewtonBodySetContinuousCollisionMode(m_body, 1);
 	NewtonReleaseCollision(newton::world, collision);
+
+	delete [] faceIndexCount;
+	delete [] faceMaterials;
+
+	m_memory = m_data.capacity() * sizeof(float) + m_indices.capacity() * sizeof(uint32_t) +
+			m_vertexCount * (2 * sizeof(Lib3dsVector) + sizeof(Lib3dsTexel));
+	util::MemoryStats::instance().add(util::MemoryStats::ENVIRONMENT, m_memory);
 }
 
 __TreeCollision::~__TreeCollision()
 {
+	util::MemoryStats::instance().add(util::MemoryStats::ENVIRONMENT, -(long)m_memory);
 	if (m_node) delete m_node;
 	if (m_vertices) delete m_vertices;
 	if (m_normals) delete m_normals;
@@ -352,6 +370,11 @@ void __TreeCollision::createOctree()
 
 	std::vector<uint32_t> indices(m_indices);
 	m_node = new Node(this, pos, size, indices);
+
+	// the indices are distributed among the nodes
+	size_t octree = m_nodeCount * sizeof(Node) + m_indices.size() * sizeof(uint32_t);
+	util::MemoryStats::instance().add(util::MemoryStats::ENVIRONMENT, octree);
+	m_memory += octree;
 }
 
 void __TreeCollision::genBuffers(ogl::VertexBuffer& vbo)
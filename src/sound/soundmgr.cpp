@@ -5,6 +5,7 @@
  */
 
 #include <sound/soundmgr.hpp>
+#include <util/memory.hpp>
 #define BOOST_FILESYSTEM_VERSION 2
 #include <boost/filesystem.hpp>
 
@@ -173,6 +174,11 @@ unsigned SoundMgr::LoadSound(const std::string& folder)
 				result = sound->setMode(FMOD_LOOP_OFF);
 				ERRCHECK(result);
 
+				// samples are decoded completely, streamed music is not accounted
+				unsigned length = 0;
+				if (sound->getLength(&length, FMOD_TIMEUNIT_PCMBYTES) == FMOD_OK)
+					util::MemoryStats::instance().add(util::MemoryStats::SOUND, length);
+
 				m_sounds[basename(*itr)] = sound;
 			}
 		}
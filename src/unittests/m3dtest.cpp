@@ -123,6 +123,31 @@ void m3dTest::quaternionTest()
 	}
 }
 
+void m3dTest::matrixQuaternionTest()
+{
+	using namespace m3d;
+
+	Vec3f axis(frand(-1.0f, 1.0f), frand(-1.0f, 1.0f), frand(-1.0f, 1.0f));
+	float angle = frand(0, 2.0f*PI);
+	Mat4f input = Mat4f::rotAxis(axis.normalized(), angle);
+
+	Quatf quat = input.quat();
+	Mat4f output = quat.mat4();
+
+	CPPUNIT_ASSERT(quat.a >= 0.0f);
+	CPPUNIT_ASSERT(fabs(quat.a*quat.a + quat.b*quat.b + quat.c*quat.c + quat.d*quat.d - 1.0f) < EPSILON);
+
+	for (int x = 0; x < 4; ++x) {
+		for (int y = 0; y < 4; ++y) {
+			// check if equal, allow a reasonable deviation
+			CPPUNIT_ASSERT(fabs(input[x][y] - output[x][y]) < EPSILON);
+
+			// check for NaN
+			CPPUNIT_ASSERT(output[x][y] == output[x][y]);
+		}
+	}
+}
+
 void m3dTest::orthonormalInverseTest()
 {
 	using namespace m3d;
@@ -0,0 +1,388 @@
+/**
+ * @date Oct 19, 2026
+ * @file unittests/simulationtest.cpp
+ */
+
+#include <unittests/simulationtest.hpp>
+#include <simulation/simulation.hpp>
+#include <simulation/material.hpp>
+#include <simulation/scenegen.hpp>
+#include <simulation/layout.hpp>
+#include <simulation/chaincheck.hpp>
+#include <simulation/crspline.hpp>
+#include <simulation/domino.hpp>
+#include <simulation/dominopath.hpp>
+#include <simulation/topplelod.hpp>
+#include <simulation/settle.hpp>
+#include <simulation/physicslod.hpp>
+#include <simulation/template.hpp>
+#include <newton/util.hpp>
+#include <newton/heightcache.hpp>
+#include <util/config.hpp>
+#include <cmath>
+
+namespace test {
+
+CPPUNIT_TEST_SUITE_REGISTRATION(simulationTest);
+
+void simulationTest::setUp()
+{
+	m_config = util::Config::instance();
+	sim::MaterialMgr::instance().load("data/materials.xml");
+	sim::Simulation::createInstance(m_keyAdapter, m_mouseAdapter, true);
+	sim::Simulation::instance().setDeterministic(true);
+}
+
+void simulationTest::tearDown()
+{
+	sim::Simulation::destroyInstance();
+
+	// the tests may change options, the next test starts with the saved ones
+	std::map<std::string, std::string>& config = util::Config::instance();
+	config = m_config;
+}
+
+boost::uint64_t simulationTest::run(const std::string& level, int steps)
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	simulation.load(level);
+	for (int i = 0; i < steps; ++i)
+		simulation.step();
+	return simulation.hashBodies();
+}
+
+void simulationTest::determinismTest()
+{
+	const char* levels[] = { "data/levels/bowling.xml", "data/levels/stress.xml", "data/levels/rope_and_swing.xml" };
+
+	for (unsigned i = 0; i < sizeof(levels) / sizeof(levels[0]); ++i) {
+		boost::uint64_t first = run(levels[i], 500);
+		boost::uint64_t second = run(levels[i], 500);
+		CPPUNIT_ASSERT_EQUAL(first, second);
+	}
+}
+
+void simulationTest::toppleTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	const unsigned count = 30;
+
+	simulation.init();
+	sim::SceneGenerator::ground();
+	sim::SceneGenerator::dominoGrid(1, count);
+	for (int i = 0; i < 1000; ++i)
+		simulation.step();
+
+	const sim::ToppleTracker& topple = simulation.getToppleTracker();
+	const sim::ToppleSummary summary = topple.getSummary();
+	CPPUNIT_ASSERT_EQUAL(count, summary.dominoes);
+	CPPUNIT_ASSERT_EQUAL(count, summary.hit);
+	CPPUNIT_ASSERT_EQUAL(0u, summary.stalls);
+	CPPUNIT_ASSERT(summary.waveSpeed > 0.0f);
+	CPPUNIT_ASSERT(summary.duration > 0.0f);
+
+	// the row is generated along the z-axis, starting with the tilted domino
+	const std::vector<sim::ToppleInfo>& dominoes = topple.getDominoes();
+	for (unsigned i = 1; i < dominoes.size(); ++i) {
+		CPPUNIT_ASSERT(dominoes[i].position.z > dominoes[i - 1].position.z);
+		CPPUNIT_ASSERT(dominoes[i].hitTime >= dominoes[i - 1].hitTime);
+	}
+}
+
+void simulationTest::heightCacheTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+
+	simulation.init();
+	sim::SceneGenerator::ground();
+	sim::SceneGenerator::boxStacks(1, 3);
+	simulation.add(sim::__RigidBody::createBox(m3d::Vec3f(5.0f, 0.5f, 5.0f), 2.0f, 1.0f, 2.0f, 0.0f, "stone"));
+
+	std::vector<m3d::Vec2f> points;
+	for (float x = -10.0f; x <= 10.0f; x += 0.13f)
+		for (float z = -10.0f; z <= 10.0f; z += 0.29f)
+			points.push_back(m3d::Vec2f(x, z));
+
+	std::vector<float> cached, exact;
+	newton::getVerticalPositions(points, cached, newton::HEIGHT_STATIC);
+	newton::getVerticalPositions(points, exact, newton::HEIGHT_STATIC_EXACT);
+	for (unsigned i = 0; i < points.size(); ++i)
+		CPPUNIT_ASSERT(fabs(cached[i] - exact[i]) < 1e-3f);
+
+	// the stack is dynamic, the box is static
+	CPPUNIT_ASSERT(fabs(newton::getVerticalPosition(0.0f, 0.0f, newton::HEIGHT_STATIC)) < 1e-3f);
+	CPPUNIT_ASSERT(newton::getVerticalPosition(0.0f, 0.0f, newton::HEIGHT_ALL) > 2.0f);
+	CPPUNIT_ASSERT(fabs(newton::getVerticalPosition(5.0f, 5.0f, newton::HEIGHT_STATIC) - 1.0f) < 1e-3f);
+	CPPUNIT_ASSERT(newton::HeightCache::instance().getTileCount() > 0);
+
+	// the tiles below a new static body are sampled again
+	simulation.add(sim::__RigidBody::createBox(m3d::Vec3f(-5.0f, 1.0f, -5.0f), 2.0f, 2.0f, 2.0f, 0.0f, "stone"));
+	CPPUNIT_ASSERT(fabs(newton::getVerticalPosition(-5.0f, -5.0f, newton::HEIGHT_STATIC) - 2.0f) < 1e-3f);
+}
+
+void simulationTest::layoutTest()
+{
+	const char* generators[] = { "spiral", "field", "text", "tree", "lanes" };
+	const float width = sim::__Domino::s_domino_size[sim::__Object::DOMINO_MIDDLE].x;
+
+	for (unsigned i = 0; i < sizeof(generators) / sizeof(generators[0]); ++i) {
+		sim::LayoutParams params;
+		params.generator = generators[i];
+		params.count = 2000;
+		params.text = "Layout";
+
+		std::vector<m3d::Mat4f> first, second;
+		const unsigned count = sim::LayoutGenerator::generate(params, first);
+		sim::LayoutGenerator::generate(params, second);
+		CPPUNIT_ASSERT(count > 0 && count <= params.count);
+		CPPUNIT_ASSERT_EQUAL((size_t)count, first.size());
+		CPPUNIT_ASSERT_EQUAL(first.size(), second.size());
+
+		for (unsigned j = 0; j < first.size(); ++j) {
+			CPPUNIT_ASSERT((first[j].getW() - second[j].getW()).len() < 1e-5f);
+			for (unsigned k = j + 1; k < first.size(); ++k)
+				CPPUNIT_ASSERT((first[j].getW() - first[k].getW()).len() >= width);
+		}
+	}
+}
+
+
+void simulationTest::chainTest()
+{
+	const sim::__Object::Type type = sim::__Object::DOMINO_MIDDLE;
+	const float gap = sim::__Domino::s_domino_gap[type];
+	const m3d::Vec3f size = sim::__Domino::s_domino_size[type];
+	const unsigned count = 20;
+	sim::ChainChecker checker;
+	sim::Simulation::instance().init();
+
+	// a row along the z-axis, the first domino is tilted
+	std::vector<sim::Domino> dominoes;
+	std::vector<const sim::__Object*> objects;
+	for (unsigned i = 0; i < count; ++i) {
+		m3d::Mat4f matrix(m3d::Vec3f::yAxis(), m3d::Vec3f::zAxis(), m3d::Vec3f(0.0f, size.y * 0.5f, i * gap));
+		if (i == 0)
+			matrix = m3d::Mat4f::rotX(0.35f) * matrix;
+		dominoes.push_back(sim::__Domino::createDomino(type, matrix, -1.0f, "domino", false));
+		objects.push_back(dominoes.back().get());
+	}
+	checker.check(objects);
+	sim::ChainSummary summary = checker.getSummary();
+	CPPUNIT_ASSERT_EQUAL(count, summary.dominoes);
+	CPPUNIT_ASSERT_EQUAL(1u, summary.chains);
+	CPPUNIT_ASSERT_EQUAL(count - 1, summary.links);
+	CPPUNIT_ASSERT_EQUAL(0u, summary.weak + summary.failing);
+	CPPUNIT_ASSERT(checker.getDomino(checker.getLinks().front().from) == dominoes.front().get());
+
+	// too far away and offset sideways
+	const float friction = checker.getFriction("domino");
+	const m3d::Mat4f first(m3d::Vec3f::yAxis(), m3d::Vec3f::zAxis(), m3d::Vec3f());
+	sim::LinkPrediction far = checker.predict(size, first, size,
+			m3d::Mat4f(m3d::Vec3f::yAxis(), m3d::Vec3f::zAxis(), m3d::Vec3f(0.0f, 0.0f, size.y * 1.1f)), friction);
+	CPPUNIT_ASSERT_EQUAL(sim::LINK_FAIL, far.status);
+	CPPUNIT_ASSERT_EQUAL(sim::LINK_REACH, far.reason);
+	sim::LinkPrediction offset = checker.predict(size, first, size,
+			m3d::Mat4f(m3d::Vec3f::yAxis(), m3d::Vec3f::zAxis(), m3d::Vec3f(size.x * 0.8f, 0.0f, gap)), friction);
+	CPPUNIT_ASSERT_EQUAL(sim::LINK_FAIL, offset.status);
+	CPPUNIT_ASSERT_EQUAL(sim::LINK_OFFSET, offset.reason);
+
+	// the gap is kept on a straight line and shortened on a tight turn
+	CPPUNIT_ASSERT_EQUAL(gap, checker.getGap(type, gap, 0.0f, 0.0f, friction));
+	CPPUNIT_ASSERT(checker.getGap(type, gap, 2.0f / size.y, 0.0f, friction) < gap);
+}
+
+
+void simulationTest::splineTest()
+{
+	sim::CRSpline incremental, full;
+	for (unsigned i = 0; i < 50; ++i) {
+		const m3d::Vec2f knot(i * 10.0f, (i % 2) * 15.0f);
+		incremental.knots().push_back(knot);
+		full.knots().push_back(knot);
+		incremental.update();
+	}
+
+	// move a knot in the middle and remove the last one
+	incremental.knots()[20].x += 5.0f;
+	incremental.knots().pop_back();
+	full.knots()[20].x += 5.0f;
+	full.knots().pop_back();
+	const float length = incremental.update();
+	CPPUNIT_ASSERT(fabs(length - full.update()) < 1e-2f);
+	CPPUNIT_ASSERT_EQUAL(full.table().size(), incremental.table().size());
+
+	sim::CRSpline::Sweep sweep(incremental);
+	for (float t = 0.0f; t < length; t += 0.7f) {
+		CPPUNIT_ASSERT((incremental.getTangent(t) - full.getTangent(t)).len() < 1e-2f);
+		CPPUNIT_ASSERT((sweep.getTangent(t) - incremental.getTangent(t)).len() < 1e-5f);
+	}
+}
+
+void simulationTest::pathTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+
+	simulation.init();
+	sim::SceneGenerator::ground();
+	std::vector<m3d::Vec2f> knots;
+	for (unsigned i = 0; i < 5; ++i)
+		knots.push_back(m3d::Vec2f(i * 10.0f, (i % 2) * 5.0f));
+	sim::DominoPath path = simulation.addPath(knots, sim::__Object::DOMINO_SMALL, "", 2.5f);
+	const std::vector<sim::Domino> before = path->getDominoes();
+	CPPUNIT_ASSERT(before.size() > 10);
+
+	// the dominoes before the third knot do not depend on the last one
+	path->knots().back() = m3d::Vec2f(45.0f, 3.0f);
+	simulation.updatePath(path);
+	const std::vector<sim::Domino>& after = path->getDominoes();
+	CPPUNIT_ASSERT(after.size() > 10);
+	for (unsigned i = 0; i < 5; ++i)
+		CPPUNIT_ASSERT(after[i] == before[i]);
+
+	simulation.save("/tmp/dominator_path.xml");
+	simulation.load("/tmp/dominator_path.xml");
+	CPPUNIT_ASSERT_EQUAL((size_t)1, simulation.getPaths().size());
+	const std::vector<sim::Domino>& loaded = simulation.getPaths().front()->getDominoes();
+	CPPUNIT_ASSERT_EQUAL(after.size(), loaded.size());
+	for (unsigned i = 0; i < loaded.size(); ++i)
+		CPPUNIT_ASSERT_EQUAL(after[i]->getID(), loaded[i]->getID());
+}
+
+void simulationTest::toppleLodTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	const unsigned count = 90;
+
+	util::Config::instance().set("toppleLod", true);
+	util::Config::instance().set("toppleLodWindow", 15.0f);
+	simulation.init();
+	sim::SceneGenerator::ground();
+	sim::SceneGenerator::dominoGrid(1, count);
+	for (int i = 0; i < 3000; ++i)
+		simulation.step();
+
+	const sim::ToppleSummary summary = simulation.getToppleTracker().getSummary();
+	const sim::ToppleLodSummary lod = simulation.getToppleLod().getSummary();
+	CPPUNIT_ASSERT(simulation.getToppleLod().isEnabled());
+	CPPUNIT_ASSERT_EQUAL(count, summary.hit);
+	CPPUNIT_ASSERT_EQUAL(0u, summary.stalls);
+	CPPUNIT_ASSERT(lod.peakDynamic > 0 && lod.peakDynamic < count / 2);
+	CPPUNIT_ASSERT(lod.resting > 0);
+	CPPUNIT_ASSERT_EQUAL(0u, lod.standing);
+}
+
+void simulationTest::settleTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	sim::SettleManager& settle = simulation.getSettleManager();
+
+	util::Config::instance().set("settleBodies", true);
+	util::Config::instance().set("settleSteps", 20);
+	simulation.init();
+	sim::SceneGenerator::ground();
+	const unsigned count = sim::SceneGenerator::boxStacks(2, 4);
+	for (int i = 0; i < 500; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT(settle.isEnabled());
+	CPPUNIT_ASSERT_EQUAL(count, settle.getSettledCount());
+
+	const m3d::Vec3f extent(1000.0f, 1000.0f, 1000.0f);
+	CPPUNIT_ASSERT_EQUAL(count, settle.restore(-extent, extent));
+	CPPUNIT_ASSERT_EQUAL(0u, settle.getSettledCount());
+
+	for (int i = 0; i < 100; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT_EQUAL(count, settle.getSettledCount());
+}
+
+void simulationTest::physicsLodTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+
+	util::Config::instance().set("physicsLod", true);
+	util::Config::instance().set("physicsLodNear", 20.0f);
+	util::Config::instance().set("physicsLodFar", 40.0f);
+
+	// the tiers follow the camera, the deterministic mode ignores them
+	simulation.init();
+	sim::SceneGenerator::ground();
+	simulation.step();
+	CPPUNIT_ASSERT(!simulation.getPhysicsLod().isEnabled());
+
+	simulation.setDeterministic(false);
+	simulation.init();
+	sim::SceneGenerator::ground();
+	const sim::Object nearBox = sim::__RigidBody::createBox(m3d::Vec3f(0.0f, 10.0f, 0.0f), 1.0f, 1.0f, 1.0f, 1.0f, "crate");
+	const sim::Object farBox = sim::__RigidBody::createBox(m3d::Vec3f(100.0f, 10.0f, 0.0f), 1.0f, 1.0f, 1.0f, 1.0f, "crate");
+	simulation.add(nearBox);
+	simulation.add(farBox);
+
+	simulation.getCamera().positionCamera(m3d::Vec3f(0.0f, 10.0f, 10.0f), m3d::Vec3f(), m3d::Vec3f::yAxis());
+	for (int i = 0; i < 100; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT(simulation.getPhysicsLod().isEnabled());
+	CPPUNIT_ASSERT(nearBox->getMatrix().getW().y < 1.0f);
+	CPPUNIT_ASSERT(farBox->getMatrix().getW().y > 8.0f);
+	CPPUNIT_ASSERT_EQUAL(1u, simulation.getPhysicsLod().getSummary().frozen);
+
+	// the frozen box falls when the camera comes closer
+	simulation.getCamera().positionCamera(m3d::Vec3f(100.0f, 10.0f, 10.0f), m3d::Vec3f(100.0f, 0.0f, 0.0f), m3d::Vec3f::yAxis());
+	for (int i = 0; i < 100; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT(farBox->getMatrix().getW().y < 1.0f);
+	CPPUNIT_ASSERT_EQUAL(1u, simulation.getPhysicsLod().getSummary().full);
+}
+
+void simulationTest::settlePhysicsLodTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+
+	util::Config::instance().set("settleBodies", true);
+	util::Config::instance().set("settleSteps", 20);
+	util::Config::instance().set("physicsLod", true);
+	util::Config::instance().set("physicsLodNear", 20.0f);
+	util::Config::instance().set("physicsLodFar", 40.0f);
+	simulation.setDeterministic(false);
+	simulation.init();
+	sim::SceneGenerator::ground();
+	const sim::Object farBox = sim::__RigidBody::createBox(m3d::Vec3f(100.0f, 10.0f, 0.0f), 1.0f, 1.0f, 1.0f, 1.0f, "crate");
+	simulation.add(farBox);
+
+	// the box is frozen in mid-air, but must not be settled there
+	simulation.getCamera().positionCamera(m3d::Vec3f(0.0f, 10.0f, 10.0f), m3d::Vec3f(), m3d::Vec3f::yAxis());
+	for (int i = 0; i < 100; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT(farBox->getMatrix().getW().y > 8.0f);
+	CPPUNIT_ASSERT_EQUAL(0u, simulation.getSettleManager().getSettledCount());
+
+	simulation.getCamera().positionCamera(m3d::Vec3f(100.0f, 10.0f, 10.0f), m3d::Vec3f(100.0f, 0.0f, 0.0f), m3d::Vec3f::yAxis());
+	for (int i = 0; i < 100; ++i)
+		simulation.step();
+	CPPUNIT_ASSERT(farBox->getMatrix().getW().y < 1.0f);
+}
+
+void simulationTest::templateTest()
+{
+	sim::Simulation& simulation = sim::Simulation::instance();
+	sim::TemplateMgr& templates = sim::TemplateMgr::instance();
+
+	simulation.init();
+	const m3d::Vec3f offset(20.0f, 0.0f, 0.0f);
+	const sim::Object loaded = templates.create("data/templates/cradle.xml", m3d::Mat4f::identity());
+	const sim::Object cloned = templates.create("data/templates/cradle.xml", m3d::Mat4f::translate(offset));
+	CPPUNIT_ASSERT(loaded && cloned);
+	CPPUNIT_ASSERT_EQUAL(loaded->getType(), cloned->getType());
+
+	std::vector<NewtonBody*> loadedBodies, clonedBodies;
+	loaded->getBodies(loadedBodies);
+	cloned->getBodies(clonedBodies);
+	CPPUNIT_ASSERT_EQUAL(loadedBodies.size(), clonedBodies.size());
+
+	m3d::Vec3f loadedMin, loadedMax, clonedMin, clonedMax;
+	loaded->getAABB(loadedMin, loadedMax);
+	cloned->getAABB(clonedMin, clonedMax);
+	CPPUNIT_ASSERT((clonedMin - loadedMin - offset).len() < 1e-3f);
+	CPPUNIT_ASSERT((clonedMax - loadedMax - offset).len() < 1e-3f);
+}
+
+}
@@ -8,7 +8,7 @@
 #ifdef _WIN32
 	#include <windows.h>
 #else
-	#include <sys/time.h>
+	#include <time.h>
 #endif
 
 namespace util {
@@ -22,7 +22,7 @@ Clock::~Clock()
 {
 }
 
-double Clock::sysTime() const
+double Clock::now()
 {
 #ifdef _WIN32
 	static LARGE_INTEGER freq, start;
@@ -38,12 +38,19 @@ double Clock::sysTime() const
 	
 	return time;
 #else
-	timeval time = { 0, 0 };
-	gettimeofday(&time, 0);
-	return time.tv_sec + time.tv_usec / 1000000.0;
+	// unlike gettimeofday, the monotonic clock is not affected by
+	// adjustments of the system time
+	timespec time = { 0, 0 };
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
 #endif
 }
 
+double Clock::sysTime() const
+{
+	return now();
+}
+
 void Clock::reset()
 {
 	m_reference = sysTime();
@@ -0,0 +1,37 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/hash.cpp
+ */
+
+#include <util/hash.hpp>
+
+namespace util {
+
+uint64_t hash(const void* data, size_t length, uint64_t seed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t result = seed;
+	for (size_t i = 0; i < length; ++i) {
+		result ^= bytes[i];
+		result *= 0x100000001b3ULL;
+	}
+	return result;
+}
+
+uint64_t hash(const std::string& data, uint64_t seed)
+{
+	return hash(data.data(), data.size(), seed);
+}
+
+std::string hashToString(uint64_t value)
+{
+	static const char digits[] = "0123456789abcdef";
+	std::string result(16, '0');
+	for (int i = 15; i >= 0; --i) {
+		result[i] = digits[value & 0xf];
+		value >>= 4;
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,147 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/memory.cpp
+ */
+
+#include <util/memory.hpp>
+#include <util/config.hpp>
+#include <iomanip>
+
+namespace util {
+
+MemoryStats* MemoryStats::s_instance = NULL;
+
+const char* MemoryStats::s_names[SUBSYSTEM_COUNT] = {
+	"Newton", "VertexData", "GpuBuffers", "Textures", "Environment", "Sound", "Objects"
+};
+
+MemoryStats::MemoryStats()
+{
+	for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+		m_usage[i].current = m_usage[i].peak = 0;
+		m_usage[i].warned = false;
+		float budget = Config::instance().get(std::string("memoryBudget") + s_names[i], 0.0f);
+		m_usage[i].budget = (size_t)(budget * 1024.0f * 1024.0f);
+	}
+}
+
+MemoryStats::MemoryStats(const MemoryStats& other)
+{
+}
+
+MemoryStats::~MemoryStats()
+{
+}
+
+MemoryStats& MemoryStats::instance()
+{
+	if (!s_instance)
+		s_instance = new MemoryStats();
+	return *s_instance;
+}
+
+void MemoryStats::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+const char* MemoryStats::getName(Subsystem subsystem)
+{
+	return s_names[subsystem];
+}
+
+void MemoryStats::update(Subsystem subsystem)
+{
+	Usage& usage = m_usage[subsystem];
+	if (usage.current > usage.peak)
+		usage.peak = usage.current;
+
+	// warn once each time the budget is exceeded
+	if (usage.budget && usage.current > usage.budget) {
+		if (!usage.warned)
+			std::cout << "Warning: " << s_names[subsystem] << " uses "
+					  << usage.current / (1024.0f * 1024.0f) << " MB, the budget is "
+					  << usage.budget / (1024.0f * 1024.0f) << " MB" << std::endl;
+		usage.warned = true;
+	} else {
+		usage.warned = false;
+	}
+}
+
+void MemoryStats::add(Subsystem subsystem, long bytes)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	Usage& usage = m_usage[subsystem];
+	if (bytes < 0 && (size_t)-bytes > usage.current)
+		usage.current = 0;
+	else
+		usage.current += bytes;
+	update(subsystem);
+}
+
+void MemoryStats::set(Subsystem subsystem, size_t bytes)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_usage[subsystem].current = bytes;
+	update(subsystem);
+}
+
+MemoryStats::Usage MemoryStats::get(Subsystem subsystem)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_usage[subsystem];
+}
+
+size_t MemoryStats::getTotal()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	size_t result = 0;
+	for (int i = 0; i < SUBSYSTEM_COUNT; ++i)
+		result += m_usage[i].current;
+	return result;
+}
+
+size_t MemoryStats::getTotalPeak()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	size_t result = 0;
+	for (int i = 0; i < SUBSYSTEM_COUNT; ++i)
+		result += m_usage[i].peak;
+	return result;
+}
+
+void MemoryStats::setBudget(Subsystem subsystem, size_t bytes)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_usage[subsystem].budget = bytes;
+	m_usage[subsystem].warned = false;
+	update(subsystem);
+}
+
+void MemoryStats::report(std::ostream& out)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	const float mb = 1024.0f * 1024.0f;
+
+	out << "Memory (MB)       current    peak  budget" << std::endl;
+	std::ios::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(2);
+	for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+		const Usage& usage = m_usage[i];
+		out << "  " << std::left << std::setw(14) << s_names[i] << std::right
+			<< std::setw(8) << usage.current / mb
+			<< std::setw(8) << usage.peak / mb;
+		if (usage.budget)
+			out << std::setw(8) << usage.budget / mb;
+		else
+			out << std::setw(8) << "-";
+		if (usage.budget && usage.current > usage.budget)
+			out << "  over budget";
+		out << std::endl;
+	}
+	out.flags(flags);
+}
+
+}
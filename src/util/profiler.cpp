@@ -0,0 +1,232 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/profiler.cpp
+ */
+
+#include <util/profiler.hpp>
+#include <util/clock.hpp>
+#include <util/config.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace util {
+
+Profiler* Profiler::s_instance = NULL;
+bool Profiler::s_enabled = false;
+
+Profiler::Profiler()
+	: m_start(Clock::now()), m_nextId(0)
+{
+	m_capacity = Config::instance().get<unsigned>("profilerEvents", 16384);
+	if (m_capacity < 1)
+		m_capacity = 1;
+	if (Config::instance().get("enableProfiler", false))
+		s_enabled = true;
+}
+
+Profiler::Profiler(const Profiler& other)
+{
+}
+
+Profiler::~Profiler()
+{
+	s_enabled = false;
+}
+
+Profiler& Profiler::instance()
+{
+	if (!s_instance)
+		s_instance = new Profiler();
+	return *s_instance;
+}
+
+void Profiler::destroy()
+{
+	if (s_instance)
+		delete s_instance;
+	s_instance = NULL;
+}
+
+Profiler::ThreadBuffer* Profiler::current()
+{
+	std::tr1::shared_ptr<ThreadBuffer>* buffer = m_current.get();
+	if (buffer)
+		return buffer->get();
+
+	boost::mutex::scoped_lock lock(m_mutex);
+
+	// recycle the buffer of an exited thread, its totals are still collected
+	std::tr1::shared_ptr<ThreadBuffer> result;
+	std::list<std::tr1::shared_ptr<ThreadBuffer> >::iterator itr = m_buffers.begin();
+	for ( ; itr != m_buffers.end() && !result; ++itr)
+		if (itr->unique())
+			result = *itr;
+
+	if (!result) {
+		result.reset(new ThreadBuffer());
+		m_buffers.push_back(result);
+	}
+
+	boost::mutex::scoped_lock bufferLock(result->mutex);
+	result->id = m_nextId++;
+	std::stringstream name;
+	name << "thread " << result->id;
+	result->name = name.str();
+	result->written = 0;
+	result->depth = 0;
+	if (!s_enabled)
+		std::vector<Event>().swap(result->events);
+
+	m_current.reset(new std::tr1::shared_ptr<ThreadBuffer>(result));
+	return result.get();
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+	ThreadBuffer* buffer = current();
+	boost::mutex::scoped_lock lock(buffer->mutex);
+	buffer->name = name;
+}
+
+void Profiler::addSample(const std::string& phase, float ms)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_frame[phase] += ms;
+}
+
+void Profiler::frame()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+
+	// collect the zone times of all threads
+	std::list<std::tr1::shared_ptr<ThreadBuffer> >::iterator itr = m_buffers.begin();
+	for ( ; itr != m_buffers.end(); ++itr) {
+		ThreadBuffer& buffer = **itr;
+		boost::mutex::scoped_lock bufferLock(buffer.mutex);
+		std::map<const char*, double>::const_iterator total = buffer.totals.begin();
+		for ( ; total != buffer.totals.end(); ++total)
+			m_frame[total->first] += total->second * 1000.0;
+		buffer.totals.clear();
+	}
+
+	// add one sample to each phase that occurred in this frame
+	std::map<std::string, float>::const_iterator sample = m_frame.begin();
+	for ( ; sample != m_frame.end(); ++sample) {
+		Phase& phase = m_phases[sample->first];
+		if (phase.samples.size() < PROFILER_WINDOW) {
+			phase.samples.push_back(sample->second);
+			phase.next = phase.samples.size() % PROFILER_WINDOW;
+		} else {
+			phase.samples[phase.next] = sample->second;
+			phase.next = (phase.next + 1) % PROFILER_WINDOW;
+		}
+		phase.last = sample->second;
+	}
+	m_frame.clear();
+}
+
+void Profiler::getStats(std::vector<Stats>& stats)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+
+	stats.clear();
+	std::vector<float> sorted;
+	std::map<std::string, Phase>::const_iterator itr = m_phases.begin();
+	for ( ; itr != m_phases.end(); ++itr) {
+		const Phase& phase = itr->second;
+		if (phase.samples.empty())
+			continue;
+
+		sorted = phase.samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		float sum = 0.0f;
+		for (unsigned i = 0; i < sorted.size(); ++i)
+			sum += sorted[i];
+
+		Stats s;
+		s.name = itr->first;
+		s.min = sorted.front();
+		s.avg = sum / sorted.size();
+		s.p99 = sorted[(sorted.size() - 1) * 99 / 100];
+		s.last = phase.last;
+		s.samples = sorted.size();
+		stats.push_back(s);
+	}
+}
+
+bool Profiler::writeTrace(const std::string& fileName)
+{
+	std::ofstream file(fileName.c_str());
+	if (!file) {
+		std::cout << "could not write trace " << fileName << std::endl;
+		return false;
+	}
+
+	file << "{\"traceEvents\":[" << std::endl;
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	bool first = true;
+	unsigned long count = 0;
+	std::list<std::tr1::shared_ptr<ThreadBuffer> >::iterator itr = m_buffers.begin();
+	for ( ; itr != m_buffers.end(); ++itr) {
+		ThreadBuffer& buffer = **itr;
+		boost::mutex::scoped_lock bufferLock(buffer.mutex);
+
+		if (!first) file << "," << std::endl;
+		first = false;
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer.id
+			 << ",\"args\":{\"name\":\"" << buffer.name << "\"}}";
+
+		// the oldest event is the next one to be overwritten
+		const unsigned long size = buffer.events.size();
+		const unsigned long available = std::min(buffer.written, size);
+		for (unsigned long i = buffer.written - available; i < buffer.written; ++i) {
+			const Event& e = buffer.events[i % size];
+			file << "," << std::endl
+				 << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.id
+				 << ",\"ts\":" << (e.begin - m_start) * 1000000.0
+				 << ",\"dur\":" << (e.end - e.begin) * 1000000.0 << "}";
+			count++;
+		}
+	}
+
+	file << std::endl << "]}" << std::endl;
+	std::cout << "wrote " << count << " events to " << fileName << std::endl;
+	return true;
+}
+
+
+ProfileZone::ProfileZone(const char* name)
+	: m_buffer(NULL), m_name(name), m_begin(0.0), m_depth(0)
+{
+	if (Profiler::isEnabled()) {
+		m_buffer = Profiler::instance().current();
+		m_depth = m_buffer->depth++;
+		m_begin = Clock::now();
+	}
+}
+
+ProfileZone::~ProfileZone()
+{
+	if (!m_buffer)
+		return;
+
+	const double end = Clock::now();
+	m_buffer->depth--;
+
+	boost::mutex::scoped_lock lock(m_buffer->mutex);
+	if (m_buffer->events.empty())
+		m_buffer->events.resize(Profiler::instance().m_capacity);
+	Profiler::Event& e = m_buffer->events[m_buffer->written % m_buffer->events.size()];
+	e.name = m_name;
+	e.begin = m_begin;
+	e.end = end;
+	e.depth = m_depth;
+	m_buffer->written++;
+	m_buffer->totals[m_name] += end - m_begin;
+}
+
+}
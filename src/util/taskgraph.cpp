@@ -0,0 +1,133 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/taskgraph.cpp
+ */
+
+#include <util/taskgraph.hpp>
+#include <boost/bind.hpp>
+#include <iomanip>
+
+namespace util {
+
+TaskGraph::TaskGraph(const std::string& name)
+	: m_name(name), m_pool(NULL), m_finished(0), m_time(0.0f)
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+}
+
+int TaskGraph::add(const std::string& name, const Task& task, bool mainThread)
+{
+	Stage stage;
+	stage.name = name;
+	stage.task = task;
+	stage.mainThread = mainThread;
+	stage.dependencies = 0;
+	stage.waiting = 0;
+	stage.start = stage.end = 0.0f;
+	m_stages.push_back(stage);
+	return m_stages.size() - 1;
+}
+
+void TaskGraph::depends(int stage, int dependency)
+{
+	m_stages[dependency].dependents.push_back(stage);
+	m_stages[stage].dependencies++;
+}
+
+void TaskGraph::run(ThreadPool& pool, ProgressCallback progress)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_pool = &pool;
+	m_finished = 0;
+	m_order.clear();
+	m_clock.reset();
+
+	int count = m_stages.size();
+	for (int i = 0; i < count; ++i)
+		m_stages[i].waiting = m_stages[i].dependencies;
+	for (int i = 0; i < count; ++i) {
+		if (m_stages[i].waiting == 0)
+			ready(i);
+	}
+
+	int reported = 0;
+	while (reported < count) {
+		while (m_mainQueue.empty() && reported == m_finished)
+			m_changed.wait(lock);
+
+		// report finished stages in order of their completion
+		while (reported < m_finished) {
+			std::string name = m_stages[m_order[reported]].name;
+			++reported;
+			if (progress) {
+				lock.unlock();
+				progress(name, reported, count);
+				lock.lock();
+			}
+		}
+
+		if (!m_mainQueue.empty()) {
+			int stage = m_mainQueue.front();
+			m_mainQueue.pop();
+			lock.unlock();
+			execute(stage);
+			lock.lock();
+		}
+	}
+
+	m_time = m_clock.get();
+	m_pool = NULL;
+}
+
+void TaskGraph::ready(int stage)
+{
+	if (m_stages[stage].mainThread) {
+		m_mainQueue.push(stage);
+		m_changed.notify_all();
+	} else {
+		m_pool->schedule(boost::bind(&TaskGraph::execute, this, stage));
+	}
+}
+
+void TaskGraph::execute(int stage)
+{
+	Stage& s = m_stages[stage];
+	s.start = m_clock.get();
+	try {
+		s.task();
+	} catch (std::exception& e) {
+		std::cout << m_name << ": stage " << s.name << " failed: " << e.what() << std::endl;
+	} catch (...) {
+		std::cout << m_name << ": stage " << s.name << " failed" << std::endl;
+	}
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	s.end = m_clock.get();
+	m_order.push_back(stage);
+	++m_finished;
+	for (unsigned i = 0; i < s.dependents.size(); ++i) {
+		if (--m_stages[s.dependents[i]].waiting == 0)
+			ready(s.dependents[i]);
+	}
+	m_changed.notify_all();
+}
+
+void TaskGraph::print(std::ostream& stream) const
+{
+	std::ios::fmtflags flags = stream.flags();
+	stream << std::fixed << std::setprecision(1);
+	for (unsigned i = 0; i < m_stages.size(); ++i) {
+		const Stage& s = m_stages[i];
+		stream << m_name << ": " << std::left << std::setw(20) << s.name << std::right
+				<< " start " << std::setw(8) << s.start * 1000.0f << " ms"
+				<< "  took " << std::setw(8) << (s.end - s.start) * 1000.0f << " ms"
+				<< (s.mainThread ? "  (main thread)" : "") << std::endl;
+	}
+	stream << m_name << ": total " << m_time * 1000.0f << " ms" << std::endl;
+	stream.flags(flags);
+}
+
+}
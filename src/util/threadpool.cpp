@@ -0,0 +1,79 @@
+/**
+ * @date Oct 19, 2026
+ * @file util/threadpool.cpp
+ */
+
+#include <util/threadpool.hpp>
+#include <util/profiler.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+
+namespace util {
+
+ThreadPool::ThreadPool(int threads)
+	: m_pending(0), m_stop(false), m_size(threads > 0 ? threads : 1)
+{
+	// the workers must not race to create the profiler
+	Profiler::instance();
+	for (int i = 0; i < m_size; ++i)
+		m_threads.create_thread(boost::bind(&ThreadPool::run, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait();
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_stop = true;
+	}
+	m_taskAvailable.notify_all();
+	m_threads.join_all();
+}
+
+void ThreadPool::schedule(const Task& task)
+{
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_tasks.push(task);
+		++m_pending;
+	}
+	m_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	while (m_pending > 0)
+		m_tasksDone.wait(lock);
+}
+
+void ThreadPool::run()
+{
+	Profiler::instance().setThreadName("worker");
+	for (;;) {
+		Task task;
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			while (m_tasks.empty() && !m_stop)
+				m_taskAvailable.wait(lock);
+			if (m_tasks.empty())
+				return;
+			task = m_tasks.front();
+			m_tasks.pop();
+		}
+
+		try {
+			task();
+		} catch (std::exception& e) {
+			std::cout << "ThreadPool: task failed: " << e.what() << std::endl;
+		} catch (...) {
+			std::cout << "ThreadPool: task failed" << std::endl;
+		}
+
+		boost::mutex::scoped_lock lock(m_mutex);
+		if (--m_pending == 0)
+			m_tasksDone.notify_all();
+	}
+}
+
+}